@@ -2,9 +2,11 @@
 
 #version 330 core
 layout(location = 0) in vec4 position;
+uniform mat4 u_MVP;
+
 void main()
 {
-	gl_Position = position;
+	gl_Position = u_MVP * position;
 };
 
 #shader fragment
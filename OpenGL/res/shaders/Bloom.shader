@@ -0,0 +1,52 @@
+#shader vertex
+
+#version 330 core
+#include "Fullscreen.glsl"
+
+out vec2 v_TexCoord;
+
+void main()
+{
+	gl_Position = FullscreenPosition();
+	v_TexCoord = FullscreenTexCoord();
+};
+
+#shader fragment
+
+#version 330 core
+
+// PREFILTER keeps what is above the threshold while halving the resolution, BLUR is one axis of a
+// separable 9 tap Gaussian, otherwise the source is downsampled to half its size
+layout(location = 0) out vec4 color;
+uniform sampler2D u_Source;
+uniform vec2 u_SourceTexel;
+uniform float u_Threshold;
+// Texel step along the blur axis
+uniform vec2 u_Direction;
+
+in vec2 v_TexCoord;
+
+void main()
+{
+#ifdef BLUR
+	// Bilinear taps placed between texels read the 9 tap kernel with 5 fetches
+	vec3 sum = texture(u_Source, v_TexCoord).rgb * 0.2270270270;
+	sum += (texture(u_Source, v_TexCoord + u_Direction * 1.3846153846).rgb + texture(u_Source, v_TexCoord - u_Direction * 1.3846153846).rgb) * 0.3162162162;
+	sum += (texture(u_Source, v_TexCoord + u_Direction * 3.2307692308).rgb + texture(u_Source, v_TexCoord - u_Direction * 3.2307692308).rgb) * 0.0702702703;
+	color = vec4(sum, 1.0);
+#else
+	// Four bilinear taps average the 4x4 source texels under a destination texel
+	vec4 offset = u_SourceTexel.xyxy * vec4(-1.0, -1.0, 1.0, 1.0);
+	vec3 sum = 0.25 * (texture(u_Source, v_TexCoord + offset.xy).rgb + texture(u_Source, v_TexCoord + offset.zy).rgb
+		+ texture(u_Source, v_TexCoord + offset.xw).rgb + texture(u_Source, v_TexCoord + offset.zw).rgb);
+#ifdef PREFILTER
+	// Soft knee around the threshold
+	float brightness = max(sum.r, max(sum.g, sum.b));
+	float knee = u_Threshold * 0.5;
+	float soft = clamp(brightness - u_Threshold + knee, 0.0, 2.0 * knee);
+	soft = soft * soft / (4.0 * knee + 1e-5);
+	sum *= max(soft, brightness - u_Threshold) / max(brightness, 1e-5);
+#endif
+	color = vec4(sum, 1.0);
+#endif
+};
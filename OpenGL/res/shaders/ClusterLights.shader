@@ -0,0 +1,130 @@
+#shader compute
+
+#version 430 core
+#include "Lighting.glsl"
+
+// One invocation per cluster. BUILD_BOUNDS computes the view space box of every cluster, otherwise lights
+// are streamed through shared memory and tested against the cluster's box. COUNT_LIGHTS counts them and
+// reserves the cluster's range of the index list, the pass without it fills the range.
+layout(local_size_x = 128) in;
+
+#define CLUSTER_COUNT (CLUSTER_X * CLUSTER_Y * CLUSTER_Z)
+
+struct ClusterBounds
+{
+	vec4 Min;
+	vec4 Max;
+};
+
+layout(std430, binding = 4) readonly buffer Lights { PointLight u_Lights[]; };
+layout(std430, binding = 5) buffer Bounds { ClusterBounds u_Bounds[]; };
+// Offset and count of each cluster's list
+layout(std430, binding = 6) buffer ClusterLightGrid { uvec2 u_ClusterLightGrid[]; };
+layout(std430, binding = 7) writeonly buffer ClusterLightIndices { uint u_ClusterLightIndices[]; };
+layout(std430, binding = 9) buffer ClusterTotals { uint u_RequestedIndices; uint u_MaxClusterLights; };
+
+uniform mat4 u_View;
+uniform mat4 u_InverseProjection;
+uniform vec2 u_ClusterDepth;
+uniform int u_ClusterLogarithmic;
+uniform uint u_LightCount;
+
+#ifdef BUILD_BOUNDS
+float SliceDepth(uint slice)
+{
+	float t = float(slice) / float(CLUSTER_Z);
+	return u_ClusterLogarithmic != 0
+		? u_ClusterDepth.x * pow(u_ClusterDepth.y / u_ClusterDepth.x, t)
+		: mix(u_ClusterDepth.x, u_ClusterDepth.y, t);
+}
+
+vec3 Unproject(vec3 ndc)
+{
+	vec4 position = u_InverseProjection * vec4(ndc, 1.0);
+	return position.xyz / position.w;
+}
+
+void main()
+{
+	uint cluster = gl_GlobalInvocationID.x;
+	if (cluster >= CLUSTER_COUNT)
+		return;
+	uvec3 cell = uvec3(cluster % CLUSTER_X, (cluster / CLUSTER_X) % CLUSTER_Y, cluster / (CLUSTER_X * CLUSTER_Y));
+
+	// The corners of the tile's near and far slice planes, found along the rays through the tile corners
+	vec3 boundsMin = vec3(1e30), boundsMax = vec3(-1e30);
+	for (uint corner = 0u; corner < 4u; corner++)
+	{
+		vec2 ndc = vec2(cell.xy + uvec2(corner & 1u, corner >> 1u)) / vec2(CLUSTER_X, CLUSTER_Y) * 2.0 - 1.0;
+		vec3 nearPoint = Unproject(vec3(ndc, -1.0));
+		vec3 farPoint = Unproject(vec3(ndc, 1.0));
+		for (uint slice = cell.z; slice <= cell.z + 1u; slice++)
+		{
+			float t = (SliceDepth(slice) + nearPoint.z) / (nearPoint.z - farPoint.z);
+			vec3 point = mix(nearPoint, farPoint, t);
+			boundsMin = min(boundsMin, point);
+			boundsMax = max(boundsMax, point);
+		}
+	}
+	u_Bounds[cluster].Min = vec4(boundsMin, 0.0);
+	u_Bounds[cluster].Max = vec4(boundsMax, 0.0);
+};
+#else
+shared vec4 s_Lights[128];
+
+void main()
+{
+	uint cluster = gl_GlobalInvocationID.x;
+	bool active = cluster < CLUSTER_COUNT;
+	vec3 boundsMin = vec3(0.0), boundsMax = vec3(0.0);
+	uvec2 range = uvec2(0u);
+	if (active)
+	{
+		boundsMin = u_Bounds[cluster].Min.xyz;
+		boundsMax = u_Bounds[cluster].Max.xyz;
+#ifndef COUNT_LIGHTS
+		range = u_ClusterLightGrid[cluster];
+#endif
+	}
+
+	uint count = 0u;
+	for (uint batch = 0u; batch < u_LightCount; batch += 128u)
+	{
+		// Every invocation moves one light to view space for the whole group
+		uint light = batch + gl_LocalInvocationIndex;
+		if (light < u_LightCount)
+		{
+			vec4 positionRadius = u_Lights[light].PositionRadius;
+			s_Lights[gl_LocalInvocationIndex] = vec4((u_View * vec4(positionRadius.xyz, 1.0)).xyz, positionRadius.w);
+		}
+		barrier();
+
+		uint batchSize = min(128u, u_LightCount - batch);
+		for (uint i = 0u; active && i < batchSize; i++)
+		{
+			vec4 sphere = s_Lights[i];
+			vec3 offset = clamp(sphere.xyz, boundsMin, boundsMax) - sphere.xyz;
+			if (dot(offset, offset) <= sphere.w * sphere.w)
+			{
+#ifndef COUNT_LIGHTS
+				if (count < range.y)
+					u_ClusterLightIndices[range.x + count] = batch + i;
+#endif
+				count++;
+			}
+		}
+		barrier();
+	}
+
+#ifdef COUNT_LIGHTS
+	if (active)
+	{
+		// The total keeps growing past the capacity so overflow can be reported, the list is cut to what fits
+		uint first = atomicAdd(u_RequestedIndices, count);
+		atomicMax(u_MaxClusterLights, count);
+		uint stored = first < CLUSTER_INDEX_CAPACITY ? min(count, CLUSTER_INDEX_CAPACITY - first) : 0u;
+		u_ClusterLightGrid[cluster] = uvec2(first, stored);
+	}
+#endif
+};
+#endif
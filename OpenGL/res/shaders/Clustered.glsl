@@ -0,0 +1,35 @@
+// Cluster lookup for clustered forward shading, CLUSTER_X/Y/Z come from ClusteredLighting::GetShaderDefines
+
+// Offset and count of each cluster's range of the index list
+layout(std430, binding = 6) readonly buffer ClusterLightGrid { uvec2 u_ClusterLightGrid[]; };
+layout(std430, binding = 7) readonly buffer ClusterLightIndices { uint u_ClusterLightIndices[]; };
+
+// View depth range covered by the slices and the size of a tile in pixels
+uniform vec2 u_ClusterDepth;
+uniform vec2 u_ClusterTileSize;
+// Exponential slices for perspective projections, linear otherwise
+uniform int u_ClusterLogarithmic;
+
+uint ClusterSlice(float viewDepth)
+{
+	float slice = u_ClusterLogarithmic != 0
+		? log(viewDepth / u_ClusterDepth.x) / log(u_ClusterDepth.y / u_ClusterDepth.x)
+		: (viewDepth - u_ClusterDepth.x) / (u_ClusterDepth.y - u_ClusterDepth.x);
+	return uint(clamp(slice * float(CLUSTER_Z), 0.0, float(CLUSTER_Z - 1)));
+}
+
+uint ClusterIndex(vec2 fragCoord, float viewDepth)
+{
+	uvec2 tile = min(uvec2(fragCoord / u_ClusterTileSize), uvec2(CLUSTER_X - 1, CLUSTER_Y - 1));
+	return (ClusterSlice(viewDepth) * CLUSTER_Y + tile.y) * CLUSTER_X + tile.x;
+}
+
+uint ClusterLightCount(uint cluster)
+{
+	return u_ClusterLightGrid[cluster].y;
+}
+
+uint ClusterLight(uint cluster, uint i)
+{
+	return u_ClusterLightIndices[u_ClusterLightGrid[cluster].x + i];
+}
@@ -0,0 +1,51 @@
+#shader vertex
+
+#version 430 core
+#include "Instancing.glsl"
+layout(location = 0) in vec4 position;
+invariant gl_Position;
+uniform mat4 u_View;
+
+out vec3 v_WorldPosition;
+out float v_ViewDepth;
+
+void main()
+{
+	vec4 worldPosition = ModelMatrix() * position;
+	v_WorldPosition = worldPosition.xyz;
+	v_ViewDepth = -(u_View * worldPosition).z;
+	gl_Position = ClipPosition(position);
+};
+
+#shader fragment
+
+#version 430 core
+#include "Lighting.glsl"
+#include "Shadows.glsl"
+#include "Clustered.glsl"
+
+layout(location = 0) out vec4 color;
+layout(std430, binding = 4) readonly buffer Lights { PointLight u_Lights[]; };
+uniform vec4 u_Color;
+uniform vec2 u_Material;
+uniform vec3 u_Ambient;
+uniform mat4 u_InverseViewProjection;
+uniform vec2 u_InverseSize;
+
+in vec3 v_WorldPosition;
+in float v_ViewDepth;
+
+void main()
+{
+	vec3 normal = FaceNormal(dFdx(v_WorldPosition), dFdy(v_WorldPosition));
+	vec3 view = ReconstructView(gl_FragCoord.xy * u_InverseSize, u_InverseViewProjection);
+	vec3 lit = u_Color.rgb * u_Ambient;
+	lit += ShadeSurface(-u_SunDirection, normal, view, u_Color.rgb, u_Material.x, u_Material.y) * u_SunColor * SunShadow(v_WorldPosition, normal);
+
+	// Only the lights binned into this fragment's cluster
+	uint cluster = ClusterIndex(gl_FragCoord.xy, v_ViewDepth);
+	uint count = ClusterLightCount(cluster);
+	for (uint i = 0u; i < count; i++)
+		lit += ShadePointLight(u_Lights[ClusterLight(cluster, i)], v_WorldPosition, normal, view, u_Color.rgb, u_Material.x, u_Material.y);
+	color = vec4(lit, 1.0);
+};
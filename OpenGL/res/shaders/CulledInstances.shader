@@ -0,0 +1,27 @@
+#shader vertex
+
+#version 430 core
+#extension GL_ARB_shader_draw_parameters : require
+layout(location = 0) in vec4 position;
+
+layout(std430, binding = 2) readonly buffer Visible { uint u_Visible[]; };
+layout(std430, binding = 3) readonly buffer Transforms { mat4 u_Transforms[]; };
+
+uniform mat4 u_ViewProjection;
+
+void main()
+{
+	uint instance = u_Visible[gl_BaseInstanceARB + gl_InstanceID];
+	gl_Position = u_ViewProjection * u_Transforms[instance] * position;
+};
+
+#shader fragment
+
+#version 430 core
+layout(location = 0) out vec4 color;
+uniform vec4 u_Color;
+
+void main()
+{
+	color = u_Color;
+};
\ No newline at end of file
@@ -0,0 +1,63 @@
+#shader vertex
+
+#version 430 core
+#include "Lighting.glsl"
+#include "Fullscreen.glsl"
+
+layout(location = 0) in vec4 position;
+layout(std430, binding = 4) readonly buffer Lights { PointLight u_Lights[]; };
+uniform mat4 u_ViewProjection;
+
+flat out int v_Light;
+
+void main()
+{
+#ifdef AMBIENT
+	gl_Position = FullscreenPosition();
+	v_Light = 0;
+#else
+	// Unit sphere scaled to the light radius, one instance per light
+	PointLight light = u_Lights[gl_InstanceID];
+	gl_Position = u_ViewProjection * vec4(light.PositionRadius.xyz + position.xyz * light.PositionRadius.w, 1.0);
+	v_Light = gl_InstanceID;
+#endif
+};
+
+#shader fragment
+
+#version 430 core
+#include "Lighting.glsl"
+#ifdef AMBIENT
+#include "Shadows.glsl"
+#endif
+
+layout(location = 0) out vec4 color;
+layout(std430, binding = 4) readonly buffer Lights { PointLight u_Lights[]; };
+uniform sampler2D u_AlbedoRoughness;
+uniform sampler2D u_NormalMetallic;
+uniform sampler2D u_Depth;
+uniform mat4 u_InverseViewProjection;
+uniform vec2 u_InverseSize;
+uniform vec3 u_Ambient;
+
+flat in int v_Light;
+
+void main()
+{
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	vec4 albedoRoughness = texelFetch(u_AlbedoRoughness, pixel, 0);
+	vec4 normalMetallic = texelFetch(u_NormalMetallic, pixel, 0);
+	vec2 uv = gl_FragCoord.xy * u_InverseSize;
+	vec3 position = ReconstructPosition(uv, texelFetch(u_Depth, pixel, 0).r, u_InverseViewProjection);
+	vec3 view = ReconstructView(uv, u_InverseViewProjection);
+	vec3 normal = DecodeNormal(normalMetallic.xy);
+#ifdef AMBIENT
+	// Ambient plus the shadowed sun
+	vec3 sun = ShadeSurface(-u_SunDirection, normal, view, albedoRoughness.rgb, albedoRoughness.a, normalMetallic.z)
+		* u_SunColor * SunShadow(position, normal);
+	color = vec4(albedoRoughness.rgb * u_Ambient + sun, 1.0);
+#else
+	color = vec4(ShadePointLight(u_Lights[v_Light], position, normal, view,
+		albedoRoughness.rgb, albedoRoughness.a, normalMetallic.z), 1.0);
+#endif
+};
@@ -0,0 +1,43 @@
+#shader vertex
+
+#version 430 core
+#include "Instancing.glsl"
+layout(location = 0) in vec4 position;
+invariant gl_Position;
+
+out vec3 v_WorldPosition;
+
+void main()
+{
+	v_WorldPosition = (ModelMatrix() * position).xyz;
+	gl_Position = ClipPosition(position);
+};
+
+#shader fragment
+
+#version 430 core
+#include "Lighting.glsl"
+#include "Shadows.glsl"
+
+// Reference path for the deferred renderer: every fragment loops over every light
+layout(location = 0) out vec4 color;
+layout(std430, binding = 4) readonly buffer Lights { PointLight u_Lights[]; };
+uniform vec4 u_Color;
+uniform vec2 u_Material;
+uniform uint u_LightCount;
+uniform vec3 u_Ambient;
+uniform mat4 u_InverseViewProjection;
+uniform vec2 u_InverseSize;
+
+in vec3 v_WorldPosition;
+
+void main()
+{
+	vec3 normal = FaceNormal(dFdx(v_WorldPosition), dFdy(v_WorldPosition));
+	vec3 view = ReconstructView(gl_FragCoord.xy * u_InverseSize, u_InverseViewProjection);
+	vec3 lit = u_Color.rgb * u_Ambient;
+	lit += ShadeSurface(-u_SunDirection, normal, view, u_Color.rgb, u_Material.x, u_Material.y) * u_SunColor * SunShadow(v_WorldPosition, normal);
+	for (uint i = 0u; i < u_LightCount; i++)
+		lit += ShadePointLight(u_Lights[i], v_WorldPosition, normal, view, u_Color.rgb, u_Material.x, u_Material.y);
+	color = vec4(lit, 1.0);
+};
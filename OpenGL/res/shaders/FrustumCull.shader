@@ -0,0 +1,45 @@
+#shader compute
+
+#version 430 core
+layout(local_size_x = 256) in;
+
+struct Instance
+{
+	vec4 Sphere;
+	uvec4 Mesh;
+};
+
+struct DrawCommand
+{
+	uint Count;
+	uint InstanceCount;
+	uint FirstIndex;
+	int BaseVertex;
+	uint BaseInstance;
+};
+
+layout(std430, binding = 0) readonly buffer Instances { Instance u_Instances[]; };
+layout(std430, binding = 1) buffer Commands { DrawCommand u_Commands[]; };
+layout(std430, binding = 2) writeonly buffer Visible { uint u_Visible[]; };
+
+uniform vec4 u_Planes[6];
+uniform uint u_InstanceCount;
+
+void main()
+{
+	uint id = gl_GlobalInvocationID.x;
+	if (id >= u_InstanceCount)
+		return;
+
+	vec4 sphere = u_Instances[id].Sphere;
+	for (int i = 0; i < 6; i++)
+	{
+		if (dot(u_Planes[i].xyz, sphere.xyz) + u_Planes[i].w < -sphere.w)
+			return;
+	}
+
+	// Each mesh owns a region of the visible list starting at its BaseInstance
+	uint mesh = u_Instances[id].Mesh.x;
+	uint slot = atomicAdd(u_Commands[mesh].InstanceCount, 1u);
+	u_Visible[u_Commands[mesh].BaseInstance + slot] = id;
+};
\ No newline at end of file
@@ -0,0 +1,11 @@
+// Vertex stage helpers for FullscreenTriangle, which draws three vertices without attributes
+
+vec4 FullscreenPosition()
+{
+	return vec4(gl_VertexID == 1 ? 3.0 : -1.0, gl_VertexID == 2 ? 3.0 : -1.0, 0.0, 1.0);
+}
+
+vec2 FullscreenTexCoord()
+{
+	return FullscreenPosition().xy * 0.5 + 0.5;
+}
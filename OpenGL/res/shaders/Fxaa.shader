@@ -0,0 +1,49 @@
+#shader vertex
+
+#version 330 core
+#include "Fullscreen.glsl"
+
+out vec2 v_TexCoord;
+
+void main()
+{
+	gl_Position = FullscreenPosition();
+	v_TexCoord = FullscreenTexCoord();
+};
+
+#shader fragment
+
+#version 330 core
+
+// FXAA in its low quality form: blurs along the local edge direction where the luma contrast is high
+layout(location = 0) out vec4 color;
+// Gamma space color with luma in alpha
+uniform sampler2D u_Source;
+uniform vec2 u_SourceTexel;
+
+in vec2 v_TexCoord;
+
+void main()
+{
+	vec4 center = texture(u_Source, v_TexCoord);
+	float lumaNW = texture(u_Source, v_TexCoord + vec2(-1.0, -1.0) * u_SourceTexel).a;
+	float lumaNE = texture(u_Source, v_TexCoord + vec2(1.0, -1.0) * u_SourceTexel).a;
+	float lumaSW = texture(u_Source, v_TexCoord + vec2(-1.0, 1.0) * u_SourceTexel).a;
+	float lumaSE = texture(u_Source, v_TexCoord + vec2(1.0, 1.0) * u_SourceTexel).a;
+	float lumaMin = min(center.a, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+	float lumaMax = max(center.a, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+	if (lumaMax - lumaMin < max(0.0312, lumaMax * 0.125))
+	{
+		color = vec4(center.rgb, 1.0);
+		return;
+	}
+
+	vec2 direction = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+	float reduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.03125, 1.0 / 128.0);
+	direction = clamp(direction / (min(abs(direction.x), abs(direction.y)) + reduce), -8.0, 8.0) * u_SourceTexel;
+
+	vec3 inner = 0.5 * (texture(u_Source, v_TexCoord - direction / 6.0).rgb + texture(u_Source, v_TexCoord + direction / 6.0).rgb);
+	vec3 outer = inner * 0.5 + 0.25 * (texture(u_Source, v_TexCoord - direction * 0.5).rgb + texture(u_Source, v_TexCoord + direction * 0.5).rgb);
+	float lumaOuter = dot(outer, vec3(0.299, 0.587, 0.114));
+	color = vec4(lumaOuter < lumaMin || lumaOuter > lumaMax ? inner : outer, 1.0);
+};
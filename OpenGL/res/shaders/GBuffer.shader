@@ -0,0 +1,33 @@
+#shader vertex
+
+#version 430 core
+#include "Instancing.glsl"
+layout(location = 0) in vec4 position;
+
+out vec3 v_WorldPosition;
+
+void main()
+{
+	v_WorldPosition = (ModelMatrix() * position).xyz;
+	gl_Position = ClipPosition(position);
+};
+
+#shader fragment
+
+#version 330 core
+#include "Lighting.glsl"
+
+// 8 bytes per pixel: albedo and roughness, then the octahedral normal with metallic in RGB10_A2
+layout(location = 0) out vec4 albedoRoughness;
+layout(location = 1) out vec4 normalMetallic;
+uniform vec4 u_Color;
+// Roughness, metallic
+uniform vec2 u_Material;
+
+in vec3 v_WorldPosition;
+
+void main()
+{
+	albedoRoughness = vec4(u_Color.rgb, u_Material.x);
+	normalMetallic = vec4(EncodeNormal(FaceNormal(dFdx(v_WorldPosition), dFdy(v_WorldPosition))), u_Material.y, 0.0);
+};
@@ -0,0 +1,35 @@
+// Object transforms of the scene shaders. Without GPU_INSTANCES every draw sets u_MVP and u_Model, with it the
+// draws come from GpuCuller and each instance looks its transform up through the culled visible list.
+// Include right after #version, the extension directive has to precede all code.
+
+#ifdef GPU_INSTANCES
+#extension GL_ARB_shader_draw_parameters : require
+
+// GPU_CULL_VISIBLE_BINDING and GPU_CULL_TRANSFORMS_BINDING in GpuCuller.h
+layout(std430, binding = 2) readonly buffer Visible { uint u_Visible[]; };
+layout(std430, binding = 3) readonly buffer Transforms { mat4 u_Transforms[]; };
+uniform mat4 u_ViewProjection;
+
+mat4 ModelMatrix()
+{
+	return u_Transforms[u_Visible[gl_BaseInstanceARB + gl_InstanceID]];
+}
+
+vec4 ClipPosition(vec4 position)
+{
+	return u_ViewProjection * (ModelMatrix() * position);
+}
+#else
+uniform mat4 u_MVP;
+uniform mat4 u_Model;
+
+mat4 ModelMatrix()
+{
+	return u_Model;
+}
+
+vec4 ClipPosition(vec4 position)
+{
+	return u_MVP * position;
+}
+#endif
@@ -0,0 +1,69 @@
+// Shared by the G-buffer, deferred light and forward shaders
+
+// std430 layout of PointLight in Light.h
+struct PointLight
+{
+	vec4 PositionRadius;
+	vec4 ColorIntensity;
+};
+
+// Octahedral normal encoding, both components in [0, 1]
+vec2 EncodeNormal(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 folded = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return (n.z >= 0.0 ? n.xy : folded) * 0.5 + 0.5;
+}
+
+vec3 DecodeNormal(vec2 encoded)
+{
+	encoded = encoded * 2.0 - 1.0;
+	vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float t = clamp(-n.z, 0.0, 1.0);
+	n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+	return normalize(n);
+}
+
+// Meshes only carry positions, so surfaces are shaded with their face normal.
+// Takes the screen derivatives of the world position, which only fragment shaders can compute.
+vec3 FaceNormal(vec3 dx, vec3 dy)
+{
+	return normalize(cross(dx, dy));
+}
+
+// Metallic/roughness Blinn-Phong for a light arriving from direction l, including the cosine term
+vec3 ShadeSurface(vec3 l, vec3 normal, vec3 view, vec3 albedo, float roughness, float metallic)
+{
+	float nDotL = max(dot(normal, l), 0.0);
+	float shininess = 2.0 / max(roughness * roughness * roughness * roughness, 1e-4) - 2.0;
+	vec3 h = normalize(l + view);
+	vec3 f0 = mix(vec3(0.04), albedo, metallic);
+	vec3 specular = f0 * (shininess + 8.0) / 25.1327 * pow(max(dot(normal, h), 0.0), shininess);
+	vec3 diffuse = albedo * (1.0 - metallic) / 3.14159;
+	return (diffuse + specular) * nDotL;
+}
+
+// The window makes the light reach exactly zero at its radius
+vec3 ShadePointLight(PointLight light, vec3 position, vec3 normal, vec3 view, vec3 albedo, float roughness, float metallic)
+{
+	vec3 toLight = light.PositionRadius.xyz - position;
+	float distance = length(toLight);
+	float window = clamp(1.0 - distance * distance / (light.PositionRadius.w * light.PositionRadius.w), 0.0, 1.0);
+	if (window <= 0.0)
+		return vec3(0.0);
+	float attenuation = window * window / (distance * distance + 1.0);
+	return ShadeSurface(toLight / distance, normal, view, albedo, roughness, metallic) * light.ColorIntensity.rgb * light.ColorIntensity.w * attenuation;
+}
+
+// World position of a pixel from its depth, for any projection
+vec3 ReconstructPosition(vec2 uv, float depth, mat4 inverseViewProjection)
+{
+	vec4 position = inverseViewProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+	return position.xyz / position.w;
+}
+
+// Direction towards the eye through a pixel, for any projection
+vec3 ReconstructView(vec2 uv, mat4 inverseViewProjection)
+{
+	return normalize(ReconstructPosition(uv, 0.0, inverseViewProjection) - ReconstructPosition(uv, 1.0, inverseViewProjection));
+}
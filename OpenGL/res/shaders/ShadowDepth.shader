@@ -0,0 +1,21 @@
+#shader vertex
+
+#version 430 core
+#include "Instancing.glsl"
+layout(location = 0) in vec4 position;
+// The depth prepass and the shading pass at GL_EQUAL must produce bit identical depths
+invariant gl_Position;
+
+void main()
+{
+	gl_Position = ClipPosition(position);
+};
+
+#shader fragment
+
+#version 330 core
+
+// Depth only, there is no color target to write
+void main()
+{
+};
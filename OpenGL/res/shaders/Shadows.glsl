@@ -0,0 +1,34 @@
+// Directional light shadows from CascadedShadowMap::Bind, SHADOW_CASCADES must match CascadedShadowMap.h
+
+#define SHADOW_CASCADES 4
+
+uniform sampler2DShadow u_ShadowMaps[SHADOW_CASCADES];
+uniform mat4 u_ShadowMatrices[SHADOW_CASCADES];
+// Direction the sun light travels in
+uniform vec3 u_SunDirection;
+uniform vec3 u_SunColor;
+
+// Samplers are indexed with constants only, dynamic indexing of sampler arrays is not allowed everywhere
+float SampleCascade(int cascade, vec3 coord)
+{
+	if (cascade == 0)
+		return texture(u_ShadowMaps[0], coord);
+	if (cascade == 1)
+		return texture(u_ShadowMaps[1], coord);
+	if (cascade == 2)
+		return texture(u_ShadowMaps[2], coord);
+	return texture(u_ShadowMaps[3], coord);
+}
+
+// 1 when lit, the first cascade containing the point is used. The normal offset keeps flat surfaces from shadowing themselves.
+float SunShadow(vec3 worldPosition, vec3 normal)
+{
+	vec3 offsetPosition = worldPosition + normal * 0.01;
+	for (int cascade = 0; cascade < SHADOW_CASCADES; cascade++)
+	{
+		vec3 coord = (u_ShadowMatrices[cascade] * vec4(offsetPosition, 1.0)).xyz * 0.5 + 0.5;
+		if (all(greaterThan(coord.xy, vec2(0.002))) && all(lessThan(coord.xy, vec2(0.998))))
+			return SampleCascade(cascade, coord);
+	}
+	return 1.0;
+}
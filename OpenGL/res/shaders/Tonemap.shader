@@ -0,0 +1,51 @@
+#shader vertex
+
+#version 330 core
+#include "Fullscreen.glsl"
+
+out vec2 v_TexCoord;
+
+void main()
+{
+	gl_Position = FullscreenPosition();
+	v_TexCoord = FullscreenTexCoord();
+};
+
+#shader fragment
+
+#version 330 core
+
+// HDR scene plus bloom to display values, color grading is folded in to save a full resolution pass.
+// Alpha carries the luma FXAA works on.
+layout(location = 0) out vec4 color;
+uniform sampler2D u_Scene;
+uniform sampler2D u_Bloom;
+uniform float u_BloomIntensity;
+uniform float u_Exposure;
+uniform int u_ToneMapping;
+uniform int u_ColorGrading;
+uniform float u_Contrast;
+uniform float u_Saturation;
+uniform vec3 u_Tint;
+
+in vec2 v_TexCoord;
+
+// Narkowicz's ACES fit
+vec3 Aces(vec3 x)
+{
+	return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+}
+
+void main()
+{
+	vec3 hdr = (texture(u_Scene, v_TexCoord).rgb + texture(u_Bloom, v_TexCoord).rgb * u_BloomIntensity) * u_Exposure;
+	vec3 ldr = u_ToneMapping != 0 ? Aces(hdr) : clamp(hdr, 0.0, 1.0);
+	if (u_ColorGrading != 0)
+	{
+		ldr *= u_Tint;
+		ldr = mix(vec3(dot(ldr, vec3(0.2126, 0.7152, 0.0722))), ldr, u_Saturation);
+		ldr = clamp((ldr - 0.5) * u_Contrast + 0.5, 0.0, 1.0);
+	}
+	ldr = pow(ldr, vec3(1.0 / 2.2));
+	color = vec4(ldr, dot(ldr, vec3(0.299, 0.587, 0.114)));
+};
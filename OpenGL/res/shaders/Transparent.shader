@@ -0,0 +1,52 @@
+#shader vertex
+
+#version 430 core
+
+// std430 layout of TransparentQuad in TransparencyRenderer.h
+struct TransparentQuad
+{
+	vec4 CenterSize;
+	vec4 Color;
+};
+
+layout(std430, binding = 8) readonly buffer TransparentQuads { TransparentQuad u_Quads[]; };
+uniform mat4 u_ViewProjection;
+
+out vec4 v_Color;
+
+void main()
+{
+	// One instance per quad, two triangles from gl_VertexID
+	const vec2 corners[6] = vec2[6](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+	TransparentQuad quad = u_Quads[gl_InstanceID];
+	vec3 position = quad.CenterSize.xyz + vec3(corners[gl_VertexID] * quad.CenterSize.w, 0.0);
+	v_Color = quad.Color;
+	gl_Position = u_ViewProjection * vec4(position, 1.0);
+};
+
+#shader fragment
+
+#version 430 core
+
+// WEIGHTED_BLENDED writes the accumulation and revealage targets, otherwise premultiplied color for sorted over-blending
+#ifdef WEIGHTED_BLENDED
+layout(location = 0) out vec4 accumulation;
+layout(location = 1) out float revealage;
+#else
+layout(location = 0) out vec4 color;
+#endif
+
+in vec4 v_Color;
+
+void main()
+{
+	vec4 premultiplied = vec4(v_Color.rgb * v_Color.a, v_Color.a);
+#ifdef WEIGHTED_BLENDED
+	// McGuire and Bavoil's depth weight, near and opaque surfaces dominate the average
+	float weight = clamp(pow(min(1.0, premultiplied.a * 10.0) + 0.01, 3.0) * 1e8 * pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+	accumulation = premultiplied * weight;
+	revealage = premultiplied.a;
+#else
+	color = premultiplied;
+#endif
+};
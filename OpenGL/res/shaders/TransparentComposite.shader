@@ -0,0 +1,32 @@
+#shader vertex
+
+#version 330 core
+#include "Fullscreen.glsl"
+
+void main()
+{
+	gl_Position = FullscreenPosition();
+};
+
+#shader fragment
+
+#version 330 core
+
+layout(location = 0) out vec4 color;
+uniform sampler2D u_Scene;
+uniform sampler2D u_Accumulation;
+uniform sampler2D u_Revealage;
+
+void main()
+{
+	// All targets have the scene's size
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	vec3 scene = texelFetch(u_Scene, texel, 0).rgb;
+	vec4 accumulation = texelFetch(u_Accumulation, texel, 0);
+	// Product of (1 - alpha) of every transparent surface over the pixel
+	float revealage = texelFetch(u_Revealage, texel, 0).r;
+
+	// Weighted average color of the surfaces, covering the scene by their combined opacity
+	vec3 average = accumulation.rgb / clamp(accumulation.a, 1e-4, 5e4);
+	color = vec4(average * (1.0 - revealage) + scene * revealage, 1.0);
+};
@@ -0,0 +1,466 @@
+#include "AABBTree.h"
+#include "Renderer.h"
+
+#include<algorithm>
+#include<cfloat>
+
+static inline AABB Union(const AABB& a, const AABB& b)
+{
+	return{ Min(a.Min, b.Min), Max(a.Max, b.Max) };
+}
+
+static inline float SurfaceArea(const AABB& box)
+{
+	Vec3 d = box.Max - box.Min;
+	return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+static inline bool Contains(const AABB& outer, const AABB& inner)
+{
+	return outer.Min.x <= inner.Min.x && outer.Min.y <= inner.Min.y && outer.Min.z <= inner.Min.z
+		&& inner.Max.x <= outer.Max.x && inner.Max.y <= outer.Max.y && inner.Max.z <= outer.Max.z;
+}
+
+static inline bool Overlaps(const AABB& a, const AABB& b)
+{
+	return a.Min.x <= b.Max.x && a.Min.y <= b.Max.y && a.Min.z <= b.Max.z
+		&& b.Min.x <= a.Max.x && b.Min.y <= a.Max.y && b.Min.z <= a.Max.z;
+}
+
+enum class FrustumTest
+{
+	OUTSIDE, INTERSECTING, INSIDE
+};
+
+static FrustumTest Classify(const Frustum& frustum, const AABB& box)
+{
+	FrustumTest result = FrustumTest::INSIDE;
+	for (const Vec4& plane : frustum.Planes)
+	{
+		// Furthest and nearest corners along the plane normal
+		Vec3 positive = { plane.x >= 0.0f ? box.Max.x : box.Min.x, plane.y >= 0.0f ? box.Max.y : box.Min.y, plane.z >= 0.0f ? box.Max.z : box.Min.z };
+		Vec3 negative = { plane.x >= 0.0f ? box.Min.x : box.Max.x, plane.y >= 0.0f ? box.Min.y : box.Max.y, plane.z >= 0.0f ? box.Min.z : box.Max.z };
+		if (Dot(plane.XYZ(), positive) + plane.w < 0.0f)
+			return FrustumTest::OUTSIDE;
+		if (Dot(plane.XYZ(), negative) + plane.w < 0.0f)
+			result = FrustumTest::INTERSECTING;
+	}
+	return result;
+}
+
+// Narrows [tMin, tMax] to one slab. A ray parallel to the slab stays inside it or never enters, dividing
+// by its zero component would give NaN for origins on the slab's planes.
+static inline bool ClipSlab(float origin, float direction, float inverseDirection, float min, float max, float& tMin, float& tMax)
+{
+	if (direction == 0.0f)
+		return origin >= min && origin <= max;
+	float t1 = (min - origin) * inverseDirection, t2 = (max - origin) * inverseDirection;
+	tMin = std::max(tMin, std::min(t1, t2));
+	tMax = std::min(tMax, std::max(t1, t2));
+	return true;
+}
+
+// Slab test, returns the entry distance or a negative value for a miss
+static float RayBoxDistance(const Vec3& origin, const Vec3& direction, const Vec3& inverseDirection, const AABB& box, float maxDistance)
+{
+	float tMin = -FLT_MAX, tMax = FLT_MAX;
+	if (!ClipSlab(origin.x, direction.x, inverseDirection.x, box.Min.x, box.Max.x, tMin, tMax) ||
+		!ClipSlab(origin.y, direction.y, inverseDirection.y, box.Min.y, box.Max.y, tMin, tMax) ||
+		!ClipSlab(origin.z, direction.z, inverseDirection.z, box.Min.z, box.Max.z, tMin, tMax))
+		return -1.0f;
+
+	if (tMax < 0.0f || tMin > tMax || tMin > maxDistance)
+		return -1.0f;
+	return std::max(tMin, 0.0f);
+}
+
+AABBTree::AABBTree(float margin)
+	:m_Root(AABB_TREE_NULL), m_FreeList(AABB_TREE_NULL), m_ProxyCount(0), m_Margin(margin)
+{
+}
+
+int AABBTree::AllocateNode()
+{
+	if (m_FreeList == AABB_TREE_NULL)
+	{
+		m_Nodes.push_back(Node());
+		m_Nodes.back().Parent = m_FreeList;
+		m_FreeList = (int)m_Nodes.size() - 1;
+	}
+
+	int node = m_FreeList;
+	m_FreeList = m_Nodes[node].Parent;
+	m_Nodes[node].Parent = AABB_TREE_NULL;
+	m_Nodes[node].Child1 = AABB_TREE_NULL;
+	m_Nodes[node].Child2 = AABB_TREE_NULL;
+	m_Nodes[node].Height = 0;
+	m_Nodes[node].UserData = 0;
+	return node;
+}
+
+void AABBTree::FreeNode(int node)
+{
+	m_Nodes[node].Parent = m_FreeList;
+	m_Nodes[node].Height = -1;
+	m_FreeList = node;
+}
+
+int AABBTree::Insert(const AABB& box, unsigned int userData)
+{
+	int proxy = AllocateNode();
+	Vec3 margin = { m_Margin, m_Margin, m_Margin };
+	m_Nodes[proxy].Box = { box.Min - margin, box.Max + margin };
+	m_Nodes[proxy].UserData = userData;
+	InsertLeaf(proxy);
+	m_ProxyCount++;
+	return proxy;
+}
+
+void AABBTree::Remove(int proxy)
+{
+	ASSERT(m_Nodes[proxy].IsLeaf());
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	m_ProxyCount--;
+}
+
+bool AABBTree::Move(int proxy, const AABB& box, const Vec3& displacement)
+{
+	ASSERT(m_Nodes[proxy].IsLeaf());
+	if (Contains(m_Nodes[proxy].Box, box))
+		return false;
+
+	// Predict the motion so a moving object does not refit every frame
+	Vec3 margin = { m_Margin, m_Margin, m_Margin };
+	AABB fat = { box.Min - margin, box.Max + margin };
+	Vec3 d = displacement * 2.0f;
+	fat.Min = fat.Min + Min(d, { 0.0f, 0.0f, 0.0f });
+	fat.Max = fat.Max + Max(d, { 0.0f, 0.0f, 0.0f });
+
+	RemoveLeaf(proxy);
+	m_Nodes[proxy].Box = fat;
+	InsertLeaf(proxy);
+	return true;
+}
+
+void AABBTree::InsertLeaf(int leaf)
+{
+	if (m_Root == AABB_TREE_NULL)
+	{
+		m_Root = leaf;
+		m_Nodes[leaf].Parent = AABB_TREE_NULL;
+		return;
+	}
+
+	// Descend towards the cheapest sibling by surface area heuristic
+	AABB leafBox = m_Nodes[leaf].Box;
+	int index = m_Root;
+	while (!m_Nodes[index].IsLeaf())
+	{
+		int child1 = m_Nodes[index].Child1;
+		int child2 = m_Nodes[index].Child2;
+		float area = SurfaceArea(m_Nodes[index].Box);
+		float combinedArea = SurfaceArea(Union(m_Nodes[index].Box, leafBox));
+
+		// Cost of making a new parent here, and the cost pushed down to the children
+		float cost = 2.0f * combinedArea;
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float cost1 = SurfaceArea(Union(leafBox, m_Nodes[child1].Box)) + inheritanceCost;
+		if (!m_Nodes[child1].IsLeaf())
+			cost1 -= SurfaceArea(m_Nodes[child1].Box);
+		float cost2 = SurfaceArea(Union(leafBox, m_Nodes[child2].Box)) + inheritanceCost;
+		if (!m_Nodes[child2].IsLeaf())
+			cost2 -= SurfaceArea(m_Nodes[child2].Box);
+
+		if (cost < cost1 && cost < cost2)
+			break;
+		index = cost1 < cost2 ? child1 : child2;
+	}
+	int sibling = index;
+
+	int oldParent = m_Nodes[sibling].Parent;
+	int newParent = AllocateNode();
+	m_Nodes[newParent].Parent = oldParent;
+	m_Nodes[newParent].Box = Union(leafBox, m_Nodes[sibling].Box);
+	m_Nodes[newParent].Height = m_Nodes[sibling].Height + 1;
+	m_Nodes[newParent].Child1 = sibling;
+	m_Nodes[newParent].Child2 = leaf;
+	m_Nodes[sibling].Parent = newParent;
+	m_Nodes[leaf].Parent = newParent;
+
+	if (oldParent == AABB_TREE_NULL)
+		m_Root = newParent;
+	else if (m_Nodes[oldParent].Child1 == sibling)
+		m_Nodes[oldParent].Child1 = newParent;
+	else
+		m_Nodes[oldParent].Child2 = newParent;
+
+	// Refit and rebalance the ancestors
+	index = m_Nodes[leaf].Parent;
+	while (index != AABB_TREE_NULL)
+	{
+		index = Balance(index);
+		int child1 = m_Nodes[index].Child1;
+		int child2 = m_Nodes[index].Child2;
+		m_Nodes[index].Height = 1 + std::max(m_Nodes[child1].Height, m_Nodes[child2].Height);
+		m_Nodes[index].Box = Union(m_Nodes[child1].Box, m_Nodes[child2].Box);
+		index = m_Nodes[index].Parent;
+	}
+}
+
+void AABBTree::RemoveLeaf(int leaf)
+{
+	if (leaf == m_Root)
+	{
+		m_Root = AABB_TREE_NULL;
+		return;
+	}
+
+	int parent = m_Nodes[leaf].Parent;
+	int grandParent = m_Nodes[parent].Parent;
+	int sibling = m_Nodes[parent].Child1 == leaf ? m_Nodes[parent].Child2 : m_Nodes[parent].Child1;
+
+	// The sibling takes the parent's place
+	FreeNode(parent);
+	if (grandParent == AABB_TREE_NULL)
+	{
+		m_Root = sibling;
+		m_Nodes[sibling].Parent = AABB_TREE_NULL;
+		return;
+	}
+
+	if (m_Nodes[grandParent].Child1 == parent)
+		m_Nodes[grandParent].Child1 = sibling;
+	else
+		m_Nodes[grandParent].Child2 = sibling;
+	m_Nodes[sibling].Parent = grandParent;
+
+	int index = grandParent;
+	while (index != AABB_TREE_NULL)
+	{
+		index = Balance(index);
+		int child1 = m_Nodes[index].Child1;
+		int child2 = m_Nodes[index].Child2;
+		m_Nodes[index].Box = Union(m_Nodes[child1].Box, m_Nodes[child2].Box);
+		m_Nodes[index].Height = 1 + std::max(m_Nodes[child1].Height, m_Nodes[child2].Height);
+		index = m_Nodes[index].Parent;
+	}
+}
+
+int AABBTree::Balance(int iA)
+{
+	// Rotates the taller grandchild up when A's subtrees differ by more than one level
+	Node& A = m_Nodes[iA];
+	if (A.IsLeaf() || A.Height < 2)
+		return iA;
+
+	int iB = A.Child1;
+	int iC = A.Child2;
+	int balance = m_Nodes[iC].Height - m_Nodes[iB].Height;
+	if (balance > 1)
+	{
+		// Rotate C up
+		int iF = m_Nodes[iC].Child1;
+		int iG = m_Nodes[iC].Child2;
+		Node& B = m_Nodes[iB];
+		Node& C = m_Nodes[iC];
+
+		C.Child1 = iA;
+		C.Parent = A.Parent;
+		A.Parent = iC;
+		if (C.Parent == AABB_TREE_NULL)
+			m_Root = iC;
+		else if (m_Nodes[C.Parent].Child1 == iA)
+			m_Nodes[C.Parent].Child1 = iC;
+		else
+			m_Nodes[C.Parent].Child2 = iC;
+
+		Node& F = m_Nodes[iF];
+		Node& G = m_Nodes[iG];
+		if (F.Height > G.Height)
+		{
+			C.Child2 = iF;
+			A.Child2 = iG;
+			G.Parent = iA;
+			A.Box = Union(B.Box, G.Box);
+			C.Box = Union(A.Box, F.Box);
+			A.Height = 1 + std::max(B.Height, G.Height);
+			C.Height = 1 + std::max(A.Height, F.Height);
+		}
+		else
+		{
+			C.Child2 = iG;
+			A.Child2 = iF;
+			F.Parent = iA;
+			A.Box = Union(B.Box, F.Box);
+			C.Box = Union(A.Box, G.Box);
+			A.Height = 1 + std::max(B.Height, F.Height);
+			C.Height = 1 + std::max(A.Height, G.Height);
+		}
+		return iC;
+	}
+
+	if (balance < -1)
+	{
+		// Rotate B up
+		int iD = m_Nodes[iB].Child1;
+		int iE = m_Nodes[iB].Child2;
+		Node& B = m_Nodes[iB];
+		Node& C = m_Nodes[iC];
+
+		B.Child1 = iA;
+		B.Parent = A.Parent;
+		A.Parent = iB;
+		if (B.Parent == AABB_TREE_NULL)
+			m_Root = iB;
+		else if (m_Nodes[B.Parent].Child1 == iA)
+			m_Nodes[B.Parent].Child1 = iB;
+		else
+			m_Nodes[B.Parent].Child2 = iB;
+
+		Node& D = m_Nodes[iD];
+		Node& E = m_Nodes[iE];
+		if (D.Height > E.Height)
+		{
+			B.Child2 = iD;
+			A.Child1 = iE;
+			E.Parent = iA;
+			A.Box = Union(C.Box, E.Box);
+			B.Box = Union(A.Box, D.Box);
+			A.Height = 1 + std::max(C.Height, E.Height);
+			B.Height = 1 + std::max(A.Height, D.Height);
+		}
+		else
+		{
+			B.Child2 = iE;
+			A.Child1 = iD;
+			D.Parent = iA;
+			A.Box = Union(C.Box, D.Box);
+			B.Box = Union(A.Box, E.Box);
+			A.Height = 1 + std::max(C.Height, D.Height);
+			B.Height = 1 + std::max(A.Height, E.Height);
+		}
+		return iB;
+	}
+
+	return iA;
+}
+
+void AABBTree::QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& results) const
+{
+	if (m_Root == AABB_TREE_NULL)
+		return;
+
+	std::vector<int> stack(1, m_Root);
+	while (!stack.empty())
+	{
+		int index = stack.back();
+		stack.pop_back();
+		const Node& node = m_Nodes[index];
+
+		FrustumTest test = Classify(frustum, node.Box);
+		if (test == FrustumTest::OUTSIDE)
+			continue;
+		if (node.IsLeaf())
+			results.push_back(node.UserData);
+		else if (test == FrustumTest::INSIDE)
+			AddSubtree(index, results);
+		else
+		{
+			stack.push_back(node.Child1);
+			stack.push_back(node.Child2);
+		}
+	}
+}
+
+void AABBTree::AddSubtree(int node, std::vector<unsigned int>& results) const
+{
+	// Called while the query stack is in use, the subtree gets its own local stack
+	std::vector<int> stack(1, node);
+	while (!stack.empty())
+	{
+		const Node& current = m_Nodes[stack.back()];
+		stack.pop_back();
+		if (current.IsLeaf())
+		{
+			results.push_back(current.UserData);
+		}
+		else
+		{
+			stack.push_back(current.Child1);
+			stack.push_back(current.Child2);
+		}
+	}
+}
+
+void AABBTree::QueryAABB(const AABB& box, std::vector<unsigned int>& results) const
+{
+	if (m_Root == AABB_TREE_NULL)
+		return;
+
+	std::vector<int> stack(1, m_Root);
+	while (!stack.empty())
+	{
+		const Node& node = m_Nodes[stack.back()];
+		stack.pop_back();
+		if (!Overlaps(node.Box, box))
+			continue;
+		if (node.IsLeaf())
+		{
+			results.push_back(node.UserData);
+		}
+		else
+		{
+			stack.push_back(node.Child1);
+			stack.push_back(node.Child2);
+		}
+	}
+}
+
+bool AABBTree::RayCast(const Vec3& origin, const Vec3& direction, float maxDistance,
+	const std::function<float(unsigned int, float)>& callback, unsigned int& hitUserData, float& distance) const
+{
+	if (m_Root == AABB_TREE_NULL)
+		return false;
+
+	Vec3 inverseDirection = { 1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z };
+	bool hit = false;
+
+	std::vector<int> stack(1, m_Root);
+	while (!stack.empty())
+	{
+		const Node& node = m_Nodes[stack.back()];
+		stack.pop_back();
+		if (RayBoxDistance(origin, direction, inverseDirection, node.Box, maxDistance) < 0.0f)
+			continue;
+
+		if (node.IsLeaf())
+		{
+			// Every confirmed hit shortens the ray, pruning everything behind it
+			float t = callback(node.UserData, maxDistance);
+			if (t >= 0.0f && t <= maxDistance)
+			{
+				maxDistance = t;
+				hitUserData = node.UserData;
+				hit = true;
+			}
+			continue;
+		}
+
+		// Visit the nearer child first
+		float distance1 = RayBoxDistance(origin, direction, inverseDirection, m_Nodes[node.Child1].Box, maxDistance);
+		float distance2 = RayBoxDistance(origin, direction, inverseDirection, m_Nodes[node.Child2].Box, maxDistance);
+		bool firstIsCloser = distance2 < 0.0f || (distance1 >= 0.0f && distance1 <= distance2);
+		int closer = firstIsCloser ? node.Child1 : node.Child2;
+		int further = firstIsCloser ? node.Child2 : node.Child1;
+		if ((firstIsCloser ? distance2 : distance1) >= 0.0f)
+			stack.push_back(further);
+		if ((firstIsCloser ? distance1 : distance2) >= 0.0f)
+			stack.push_back(closer);
+	}
+
+	if (hit)
+		distance = maxDistance;
+	return hit;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "VectorMath.h"
+
+#include<vector>
+#include<functional>
+
+#define AABB_TREE_NULL -1
+
+// Dynamic bounding volume hierarchy over fat AABBs. Leaves are only refit when an object leaves
+// its fat box, and AVL-style rotations keep the tree balanced under incremental updates.
+class AABBTree
+{
+private:
+	struct Node
+	{
+		AABB Box;
+		unsigned int UserData;
+		// Parent for live nodes, next free node for free ones
+		int Parent;
+		int Child1;
+		int Child2;
+		// Leaves are 0, free nodes -1
+		int Height;
+
+		inline bool IsLeaf() const { return Child1 == AABB_TREE_NULL; }
+	};
+
+	std::vector<Node> m_Nodes;
+	int m_Root;
+	int m_FreeList;
+	unsigned int m_ProxyCount;
+	float m_Margin;
+
+public:
+	// Boxes are fattened by margin on every side
+	AABBTree(float margin = 0.1f);
+
+	// Returns a proxy id that stays valid until the proxy is removed
+	int Insert(const AABB& box, unsigned int userData);
+	void Remove(int proxy);
+	// Returns true when the proxy left its fat box and was reinserted, displacement extends
+	// the fat box in the direction of motion
+	bool Move(int proxy, const AABB& box, const Vec3& displacement = { 0.0f, 0.0f, 0.0f });
+
+	inline const AABB& GetFatAABB(int proxy) const { return m_Nodes[proxy].Box; }
+	inline unsigned int GetUserData(int proxy) const { return m_Nodes[proxy].UserData; }
+	inline unsigned int GetProxyCount() const { return m_ProxyCount; }
+	inline int GetHeight() const { return m_Root == AABB_TREE_NULL ? 0 : m_Nodes[m_Root].Height; }
+
+	// Queries keep their traversal state local, any number may run at once while the tree is not modified.
+	// Appends the user data of every proxy whose fat box touches the frustum, subtrees fully
+	// inside are emitted without further plane tests
+	void QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& results) const;
+	void QueryAABB(const AABB& box, std::vector<unsigned int>& results) const;
+
+	// callback(userData, maxDistance) returns the exact hit distance, or a negative value for a miss.
+	// Returns the user data of the closest hit, distance receives its distance.
+	bool RayCast(const Vec3& origin, const Vec3& direction, float maxDistance,
+		const std::function<float(unsigned int, float)>& callback, unsigned int& hitUserData, float& distance) const;
+
+private:
+	int AllocateNode();
+	void FreeNode(int node);
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	int Balance(int node);
+	void AddSubtree(int node, std::vector<unsigned int>& results) const;
+};
@@ -0,0 +1,540 @@
+#include "Benchmarks.h"
+#include "Demo.h"
+#include "RenderGraph.h"
+#include "PipelineState.h"
+#include "GpuTimer.h"
+#include "VectorMath.h"
+#include "SceneGraph.h"
+#include "EntityRegistry.h"
+#include "Components.h"
+#include "AABBTree.h"
+#include "GeometryPool.h"
+#include "RenderResources.h"
+#include "ThreadPool.h"
+#include "GL\glew.h"
+
+#include<iostream>
+#include<iomanip>
+#include<chrono>
+#include<vector>
+#include<cmath>
+#include<functional>
+
+// Every component of a demo disc in one object, the layout the registry replaces
+struct SceneObject
+{
+	TransformComponent Transform;
+	BoundsComponent Bounds;
+	MeshComponent Mesh;
+	MaterialComponent Material;
+	LodComponent Lod;
+};
+
+template<typename F>
+static double MeasureMilliseconds(unsigned int repeats, F func)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	for (unsigned int i = 0; i < repeats; i++)
+		func();
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	return elapsed.count() / repeats;
+}
+
+struct FrameTiming
+{
+	double CpuMilliseconds;
+	double GpuMilliseconds;
+};
+
+// Average frame time after a few warm up frames. The CPU time is wall clock between two glFinish calls, so with
+// V-Sync off it is whichever of CPU and GPU limits the frame rate. measureStart runs between warm up and measuring.
+static FrameTiming MeasureFrames(Demo& demo, unsigned int frames, const std::function<void()>& measureStart = nullptr)
+{
+	for (unsigned int i = 0; i < 10; i++)
+		demo.Frame();
+	GLCall(glFinish());
+	if (measureStart)
+		measureStart();
+
+	GpuTimer timer;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (unsigned int i = 0; i < frames; i++)
+	{
+		timer.Begin();
+		demo.Frame();
+		timer.End();
+	}
+	GLCall(glFinish());
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	timer.Poll();
+	double gpu = timer.GetSampleCount() > 0 ? timer.GetTotalMilliseconds() / timer.GetSampleCount() : 0.0;
+	return{ elapsed.count() / frames, gpu };
+}
+
+void Benchmarks::Run(GLFWwindow* window, unsigned int width, unsigned int height)
+{
+	SimdTransforms();
+	SceneGraphUpdate();
+	EntityIteration();
+	AABBTreeScaling();
+	RenderGraphAliasing();
+	GeometryPoolVsBuffers();
+
+	// The rendering benchmarks share one scene, their own reports replace the periodic ones
+	Demo demo(window, width, height);
+	demo.SetReportInterval(0);
+	LightSweep(demo);
+	LodDistanceSweep(demo);
+	TransparencySweep(demo);
+	PipelineSharing();
+}
+
+void Benchmarks::SimdTransforms()
+{
+	// A million points, large enough to leave the caches so memory bandwidth shows as well
+	const size_t count = 1 << 20;
+	const unsigned int repeats = 20;
+	std::vector<float> x(count), y(count), z(count), outX(count), outY(count), outZ(count), outW(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		x[i] = (float)(i % 1024);
+		y[i] = (float)(i / 1024);
+		z[i] = (float)(i % 7);
+	}
+	Mat4 matrix = Mat4::Perspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f) * Mat4::Translation({ -512.0f, -512.0f, -50.0f });
+
+	SimdLevel original = MathBatch::GetLevel();
+	for (int level = 0; level <= (int)MathBatch::GetSupportedLevel(); level++)
+	{
+		MathBatch::SetLevel((SimdLevel)level);
+		// One untimed pass to fault in the outputs
+		MathBatch::TransformPoints(matrix, x.data(), y.data(), z.data(), outX.data(), outY.data(), outZ.data(), outW.data(), count);
+		auto start = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < repeats; i++)
+			MathBatch::TransformPoints(matrix, x.data(), y.data(), z.data(), outX.data(), outY.data(), outZ.data(), outW.data(), count);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+		std::cout << "[SIMD] TransformPoints " << std::setw(6) << MathBatch::GetLevelName((SimdLevel)level) << ": "
+			<< std::fixed << std::setprecision(3) << elapsed.count() / repeats << " ms per " << count << " points, "
+			<< std::setprecision(1) << count * repeats / (elapsed.count() * 1000.0) << " M points/s" << std::defaultfloat << std::endl;
+	}
+	MathBatch::SetLevel(original);
+}
+
+void Benchmarks::SceneGraphUpdate()
+{
+	// 1000 roots with 9 children of 110 leaves each, a million nodes three levels deep
+	SceneGraph graph;
+	std::vector<SceneNodeID> roots;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (unsigned int r = 0; r < 1000; r++)
+	{
+		SceneNodeID root = graph.CreateNode(SCENE_NODE_NONE, { (float)r, 0.0f, 0.0f });
+		roots.push_back(root);
+		for (unsigned int c = 0; c < 9; c++)
+		{
+			SceneNodeID child = graph.CreateNode(root, { 0.0f, (float)c, 0.0f });
+			for (unsigned int l = 0; l < 110; l++)
+				graph.CreateNode(child, { 0.0f, 0.0f, (float)l }, Quat::FromAxisAngle({ 0.0f, 0.0f, 1.0f }, l * 0.1f));
+		}
+	}
+	// The first update sorts the new nodes by depth as well
+	graph.Update(&ThreadPool::Get());
+	std::chrono::duration<double, std::milli> build = std::chrono::high_resolution_clock::now() - start;
+	std::cout << "[SceneGraph] " << graph.GetNodeCount() << " nodes created and sorted in " << std::fixed << std::setprecision(1)
+		<< build.count() << " ms" << std::defaultfloat << std::endl;
+
+	const unsigned int repeats = 10;
+	for (unsigned int dirtyRoots : { 1000u, 10u })
+	{
+		for (ThreadPool* pool : { (ThreadPool*)nullptr, &ThreadPool::Get() })
+		{
+			double total = 0.0;
+			for (unsigned int i = 0; i < repeats; i++)
+			{
+				Quat rotation = Quat::FromAxisAngle({ 0.0f, 1.0f, 0.0f }, i * 0.01f);
+				for (unsigned int r = 0; r < dirtyRoots; r++)
+					graph.SetRotation(roots[r * (1000 / dirtyRoots)], rotation);
+				auto updateStart = std::chrono::high_resolution_clock::now();
+				graph.Update(pool);
+				std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - updateStart;
+				total += elapsed.count();
+			}
+			std::cout << "[SceneGraph] " << std::setw(7) << graph.GetLastUpdateCount() << " dirty, "
+				<< (pool ? pool->GetThreadCount() : 1) << " threads: " << std::fixed << std::setprecision(3) << total / repeats
+				<< " ms per update" << std::defaultfloat << std::endl;
+		}
+	}
+}
+
+void Benchmarks::EntityIteration()
+{
+	const unsigned int count = 1000000;
+	const unsigned int repeats = 10;
+	EntityRegistry registry;
+	std::vector<SceneObject> objects(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		Sphere bounds = { { (float)(i % 1000), (float)(i / 1000), 0.0f }, 0.5f };
+		objects[i] = { { Mat4::Identity() }, { bounds }, {}, { {}, { 1.0f, 1.0f, 1.0f, 1.0f } }, { nullptr, 0 } };
+		registry.CreateEntity(objects[i].Transform, objects[i].Bounds, objects[i].Mesh, objects[i].Material, objects[i].Lod);
+	}
+
+	// Only the bounds are read: the chunks stream 16 bytes per entity, the objects drag the rest through the cache
+	float sum = 0.0f;
+	double aosBounds = MeasureMilliseconds(repeats, [&]()
+	{
+		for (const SceneObject& object : objects)
+			sum += object.Bounds.WorldBounds.Center.x;
+	});
+	double ecsBounds = MeasureMilliseconds(repeats, [&]()
+	{
+		registry.EachChunk<BoundsComponent>([&](unsigned int chunkCount, BoundsComponent* bounds)
+		{
+			for (unsigned int i = 0; i < chunkCount; i++)
+				sum += bounds[i].WorldBounds.Center.x;
+		});
+	});
+	// Bounds to world matrices, what the demo's transform update does
+	double aosTransforms = MeasureMilliseconds(repeats, [&]()
+	{
+		for (SceneObject& object : objects)
+			object.Transform.World = Mat4::Translation(object.Bounds.WorldBounds.Center);
+	});
+	double ecsTransforms = MeasureMilliseconds(repeats, [&]()
+	{
+		registry.Each<TransformComponent, BoundsComponent>([](TransformComponent& transform, BoundsComponent& bounds)
+		{
+			transform.World = Mat4::Translation(bounds.WorldBounds.Center);
+		});
+	});
+
+	std::cout << "[Entities] " << count << " entities of " << sizeof(SceneObject) << " bytes, ms per pass (objects / chunks):"
+		<< std::fixed << std::setprecision(3) << " bounds " << aosBounds << " / " << ecsBounds
+		<< ", transforms " << aosTransforms << " / " << ecsTransforms << std::defaultfloat << std::endl;
+	// Keeps the bounds loops from being optimized away
+	volatile float sink = sum;
+	(void)sink;
+}
+
+void Benchmarks::AABBTreeScaling()
+{
+	for (unsigned int count : { 100000u, 1000000u })
+	{
+		// Unit-ish boxes scattered through a cube that keeps the density the same at both sizes
+		float extent = 100.0f * cbrtf(count / 100000.0f);
+		std::vector<AABB> boxes(count);
+		unsigned int seed = 12345;
+		auto random = [&seed]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) / 16777216.0f; };
+		for (AABB& box : boxes)
+		{
+			Vec3 center = { (random() - 0.5f) * extent, (random() - 0.5f) * extent, (random() - 0.5f) * extent };
+			Vec3 half = { 0.1f + 0.4f * random(), 0.1f + 0.4f * random(), 0.1f + 0.4f * random() };
+			box = { center - half, center + half };
+		}
+
+		AABBTree tree;
+		std::vector<int> proxies(count);
+		double insert = MeasureMilliseconds(1, [&]()
+		{
+			for (unsigned int i = 0; i < count; i++)
+				proxies[i] = tree.Insert(boxes[i], i);
+		});
+
+		// Cameras at the center looking out in different directions, each sees a cone of the cube
+		std::vector<unsigned int> results;
+		size_t frustumHits = 0;
+		const unsigned int frustumQueries = 16;
+		unsigned int camera = 0;
+		Mat4 projection = Mat4::Perspective(1.0f, 16.0f / 9.0f, 0.1f, extent * 0.25f);
+		double frustum = MeasureMilliseconds(frustumQueries, [&]()
+		{
+			float angle = camera++ * 6.2831853f / frustumQueries;
+			Frustum view = Frustum::FromMatrix(projection * Mat4::LookAt({ 0.0f, 0.0f, 0.0f },
+				{ cosf(angle), 0.3f, sinf(angle) }, { 0.0f, 1.0f, 0.0f }));
+			results.clear();
+			tree.QueryFrustum(view, results);
+			frustumHits += results.size();
+		});
+
+		size_t boxHits = 0;
+		const unsigned int boxQueries = 10000;
+		double query = MeasureMilliseconds(boxQueries, [&]()
+		{
+			const AABB& probe = boxes[(unsigned int)(random() * count) % count];
+			results.clear();
+			tree.QueryAABB(probe, results);
+			boxHits += results.size();
+		});
+
+		std::cout << "[AABBTree] " << std::setw(7) << count << " objects, height " << tree.GetHeight() << ": insert " << std::fixed
+			<< std::setprecision(1) << insert << " ms, frustum query " << std::setprecision(3) << frustum << " ms ("
+			<< frustumHits / frustumQueries << " hits), box query " << query * 1000.0 << " us (" << std::setprecision(1)
+			<< (double)boxHits / boxQueries << " hits)" << std::defaultfloat << std::endl;
+
+		// A tenth of the objects drift, small steps mostly stay inside their fat boxes, large ones reinsert
+		unsigned int moved = count / 10;
+		for (float step : { 0.02f, 1.0f })
+		{
+			unsigned int reinserted = 0;
+			double update = MeasureMilliseconds(1, [&]()
+			{
+				for (unsigned int i = 0; i < moved; i++)
+				{
+					Vec3 displacement = { step, 0.0f, 0.0f };
+					boxes[i] = { boxes[i].Min + displacement, boxes[i].Max + displacement };
+					if (tree.Move(proxies[i], boxes[i], displacement))
+						reinserted++;
+				}
+			});
+			std::cout << "[AABBTree] " << std::setw(7) << count << " objects, " << moved << " moved by " << step << ": "
+				<< std::fixed << std::setprecision(3) << update << " ms, " << std::defaultfloat << reinserted << " reinserted" << std::endl;
+		}
+	}
+}
+
+// Triangle fan of a regular polygon with the given side count, positions only
+static void CreatePolygon(unsigned int sides, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+{
+	vertices.assign({ 0.0f, 0.0f, 0.0f });
+	indices.clear();
+	for (unsigned int i = 0; i < sides; i++)
+	{
+		float angle = i * 6.2831853f / sides;
+		vertices.insert(vertices.end(), { cosf(angle), sinf(angle), 0.0f });
+		indices.insert(indices.end(), { 0, 1 + i, 1 + (i + 1) % sides });
+	}
+}
+
+void Benchmarks::GeometryPoolVsBuffers()
+{
+	// Polygons of 3 to 34 sides, small enough that per-mesh overhead dominates
+	const unsigned int count = 10000;
+	const unsigned int repeats = 20;
+	VertexBufferLayout layout;
+	layout.Push<float>(3);
+	std::vector<std::vector<float>> vertices(count);
+	std::vector<std::vector<unsigned int>> indices(count);
+	for (unsigned int i = 0; i < count; i++)
+		CreatePolygon(3 + i % 32, vertices[i], indices[i]);
+
+	RenderResources resources;
+	std::vector<VertexBufferHandle> vertexBuffers(count);
+	std::vector<IndexBufferHandle> indexBuffers(count);
+	std::vector<VertexArrayHandle> vertexArrays(count);
+	GLCall(glFinish());
+	double buffersCreate = MeasureMilliseconds(1, [&]()
+	{
+		for (unsigned int i = 0; i < count; i++)
+		{
+			vertexBuffers[i] = resources.VertexBuffers.Create(vertices[i].data(), (unsigned int)(vertices[i].size() * sizeof(float)));
+			indexBuffers[i] = resources.IndexBuffers.Create(indices[i].data(), (unsigned int)indices[i].size());
+			vertexArrays[i] = resources.VertexArrays.Create();
+			resources.VertexArrays.Get(vertexArrays[i])->AddBuffer(*resources.VertexBuffers.Get(vertexBuffers[i]), layout);
+		}
+		GLCall(glFinish());
+	});
+
+	GeometryPool pool(layout, 1 << 19, 1 << 21);
+	std::vector<GeometryHandle> meshes(count);
+	double poolCreate = MeasureMilliseconds(1, [&]()
+	{
+		for (unsigned int i = 0; i < count; i++)
+			meshes[i] = pool.Add(vertices[i].data(), (unsigned int)vertices[i].size() / 3, indices[i].data(), (unsigned int)indices[i].size());
+		GLCall(glFinish());
+	});
+	std::cout << "[GeometryPool] " << count << " meshes created: " << std::fixed << std::setprecision(3)
+		<< buffersCreate << " ms with own buffers, " << poolCreate << " ms into the pool" << std::defaultfloat << std::endl;
+
+	// Shrunk to a point so the draws cost submission and not fill
+	Renderer renderer;
+	Shader shader("res/shaders/ShadowDepth.shader");
+	shader.Bind();
+	Mat4 mvp = Mat4::Scale({ 0.0001f, 0.0001f, 0.0001f });
+	shader.SetUniformMat4f("u_MVP", mvp.m);
+	auto measureDraws = [&](auto draw)
+	{
+		GpuTimer timer;
+		GLCall(glFinish());
+		double cpu = MeasureMilliseconds(repeats, [&]()
+		{
+			timer.Begin();
+			draw();
+			timer.End();
+		});
+		GLCall(glFinish());
+		timer.Poll();
+		double gpu = timer.GetSampleCount() > 0 ? timer.GetTotalMilliseconds() / timer.GetSampleCount() : 0.0;
+		return FrameTiming{ cpu, gpu };
+	};
+	FrameTiming buffersDraw = measureDraws([&]()
+	{
+		for (unsigned int i = 0; i < count; i++)
+			renderer.Draw(*resources.VertexArrays.Get(vertexArrays[i]), *resources.IndexBuffers.Get(indexBuffers[i]), shader);
+	});
+	FrameTiming poolDraw = measureDraws([&]()
+	{
+		pool.Bind();
+		for (unsigned int i = 0; i < count; i++)
+			pool.Draw(meshes[i]);
+		pool.UnBind();
+	});
+	std::cout << "[GeometryPool] " << count << " draws (CPU / GPU ms): " << std::fixed << std::setprecision(3)
+		<< buffersDraw.CpuMilliseconds << " / " << buffersDraw.GpuMilliseconds << " with own buffers, "
+		<< poolDraw.CpuMilliseconds << " / " << poolDraw.GpuMilliseconds << " from the pool" << std::defaultfloat << std::endl;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		resources.VertexArrays.Destroy(vertexArrays[i]);
+		resources.IndexBuffers.Destroy(indexBuffers[i]);
+		resources.VertexBuffers.Destroy(vertexBuffers[i]);
+	}
+
+	// Every other mesh replaced by one twice its size, which rarely fits the holes left behind
+	std::vector<float> grownVertices;
+	std::vector<unsigned int> grownIndices;
+	for (unsigned int i = 0; i < count; i += 2)
+	{
+		pool.Remove(meshes[i]);
+		CreatePolygon(2 * (3 + i % 32), grownVertices, grownIndices);
+		meshes[i] = pool.Add(grownVertices.data(), (unsigned int)grownVertices.size() / 3, grownIndices.data(), (unsigned int)grownIndices.size());
+	}
+	float before = pool.GetFragmentation();
+	double defragment = MeasureMilliseconds(1, [&]()
+	{
+		pool.Defragment();
+		GLCall(glFinish());
+	});
+	std::cout << "[GeometryPool] after churn fragmentation " << std::fixed << std::setprecision(3) << before
+		<< ", " << pool.GetFragmentation() << " after a " << defragment << " ms defragment" << std::defaultfloat << std::endl;
+}
+
+void Benchmarks::RenderGraphAliasing()
+{
+	RenderGraph graph;
+	RenderGraphResource backbuffer = graph.ImportBackbuffer(1920, 1080);
+	RenderGraphResource albedo, normal, depth, hdr, bright, blur, ldr;
+	auto nothing = [](RenderGraph&) {};
+	graph.AddPass("GBuffer", [&](RenderGraphBuilder& builder)
+	{
+		albedo = builder.CreateTexture("Albedo", { 1920, 1080, GL_RGBA8 });
+		normal = builder.CreateTexture("Normal", { 1920, 1080, GL_RGBA8 });
+		depth = builder.CreateTexture("Depth", { 1920, 1080, GL_DEPTH_COMPONENT24 });
+	}, nothing);
+	graph.AddPass("Lighting", [&](RenderGraphBuilder& builder)
+	{
+		builder.Read(albedo);
+		builder.Read(normal);
+		builder.Read(depth);
+		hdr = builder.CreateTexture("HDR", { 1920, 1080, GL_RGBA16F });
+	}, nothing);
+	graph.AddPass("BloomBright", [&](RenderGraphBuilder& builder)
+	{
+		builder.Read(hdr);
+		bright = builder.CreateTexture("Bright", { 960, 540, GL_RGBA16F });
+	}, nothing);
+	graph.AddPass("BloomBlur", [&](RenderGraphBuilder& builder)
+	{
+		builder.Read(bright);
+		blur = builder.CreateTexture("Blur", { 960, 540, GL_RGBA16F });
+	}, nothing);
+	graph.AddPass("Tonemap", [&](RenderGraphBuilder& builder)
+	{
+		builder.Read(hdr);
+		builder.Read(blur);
+		ldr = builder.CreateTexture("LDR", { 1920, 1080, GL_RGBA8 });
+	}, nothing);
+	// Nobody reads its output, so it is culled
+	graph.AddPass("NormalDebug", [&](RenderGraphBuilder& builder)
+	{
+		builder.Read(normal);
+		builder.CreateTexture("NormalView", { 1920, 1080, GL_RGBA8 });
+	}, nothing);
+	graph.AddPass("Present", [&](RenderGraphBuilder& builder)
+	{
+		builder.Read(ldr);
+		builder.Write(backbuffer);
+	}, nothing);
+	graph.Compile();
+	graph.PrintSummary();
+}
+
+void Benchmarks::LightSweep(Demo& demo)
+{
+	// The transparent quads would cost the same on every path, a fixed scale keeps the pixel count constant
+	DemoSettings original = demo.GetSettings();
+	DemoSettings settings = original;
+	settings.VSync = false;
+	settings.Resolution = { 1.0f, 1.0f, original.Resolution.BudgetMilliseconds };
+	settings.ResolutionLogging = false;
+	settings.Transparency = DemoTransparency::OFF;
+
+	const char* names[] = { "deferred", "clustered", "forward" };
+	std::cout << "[LightSweep] ms per frame (CPU wall clock / GPU)" << std::endl;
+	for (unsigned int count = 16; count <= MAX_POINT_LIGHTS; count *= 4)
+	{
+		std::cout << "[LightSweep] " << std::setw(5) << count << " lights:";
+		for (unsigned int path = 0; path < 3; path++)
+		{
+			settings.Lighting = (LightingPath)path;
+			settings.LightCount = count;
+			demo.SetSettings(settings);
+			FrameTiming timing = MeasureFrames(demo, 60);
+			std::cout << "  " << names[path] << " " << std::fixed << std::setprecision(3) << timing.CpuMilliseconds
+				<< " / " << timing.GpuMilliseconds << std::defaultfloat;
+		}
+		std::cout << std::endl;
+	}
+	demo.SetSettings(original);
+}
+
+void Benchmarks::LodDistanceSweep(Demo& demo)
+{
+	// Orthographic zoom stands in for distance: the half height of the view, the grid spans about 2.4
+	DemoSettings original = demo.GetSettings();
+	DemoSettings settings = original;
+	settings.VSync = false;
+	settings.Resolution = { 1.0f, 1.0f, original.Resolution.BudgetMilliseconds };
+	settings.ResolutionLogging = false;
+	settings.Transparency = DemoTransparency::OFF;
+
+	for (float zoom : { 0.25f, 0.5f, 1.0f, 2.0f, 4.0f, 8.0f })
+	{
+		settings.Zoom = zoom;
+		demo.SetSettings(settings);
+		FrameTiming timing = MeasureFrames(demo, 60);
+		std::cout << "[LodSweep] zoom " << std::setw(4) << zoom << ": " << std::setw(7) << demo.GetVisibleTriangles()
+			<< " visible triangles, " << std::fixed << std::setprecision(3) << timing.CpuMilliseconds << " ms CPU / "
+			<< timing.GpuMilliseconds << " ms GPU per frame" << std::defaultfloat << std::endl;
+	}
+	demo.SetSettings(original);
+}
+
+void Benchmarks::TransparencySweep(Demo& demo)
+{
+	DemoSettings original = demo.GetSettings();
+	DemoSettings settings = original;
+	settings.VSync = false;
+	settings.Resolution = { 1.0f, 1.0f, original.Resolution.BudgetMilliseconds };
+	settings.ResolutionLogging = false;
+
+	TransparencyRenderer& transparency = demo.GetTransparency();
+	std::cout << "[TransparencySweep] " << transparency.GetQuadCount() << " quads" << std::endl;
+	for (DemoTransparency mode : { DemoTransparency::WEIGHTED_BLENDED, DemoTransparency::SORTED })
+	{
+		settings.Transparency = mode;
+		demo.SetSettings(settings);
+		FrameTiming timing = MeasureFrames(demo, 60, [&]() { transparency.ResetTimings(); });
+		std::cout << "[TransparencySweep] " << (mode == DemoTransparency::SORTED ? "sorted" : "weighted blended") << ": "
+			<< std::fixed << std::setprecision(3) << timing.CpuMilliseconds << " ms CPU / " << timing.GpuMilliseconds
+			<< " ms GPU per frame, pass " << transparency.GetCpuMilliseconds() << " ms sorting / "
+			<< transparency.GetGpuMilliseconds() << " ms GPU" << std::defaultfloat << std::endl;
+	}
+	demo.SetSettings(original);
+}
+
+void Benchmarks::PipelineSharing()
+{
+	// Every system creates its pipelines up front, identical ones are shared
+	std::cout << "[Pipelines] " << PipelineCache::Get().GetCount() << " pipeline states for "
+		<< PipelineCache::Get().GetRequestCount() << " requests" << std::endl;
+}
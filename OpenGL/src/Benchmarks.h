@@ -0,0 +1,36 @@
+#pragma once
+
+struct GLFWwindow;
+class Demo;
+
+// Measurements and one-off reports, run with --bench in place of the interactive demo. CPU benchmarks
+// only use the calling thread and the thread pool, the rendering ones drive the demo scene in the window.
+class Benchmarks
+{
+public:
+	static void Run(GLFWwindow* window, unsigned int width, unsigned int height);
+
+	// Throughput of MathBatch::TransformPoints at every instruction set the CPU supports
+	static void SimdTransforms();
+	// World matrix updates of a million node hierarchy, everything and 1% dirty, on one thread and on the pool
+	static void SceneGraphUpdate();
+	// Iterating components in the registry's chunks against the same data as an array of whole objects
+	static void EntityIteration();
+	// Building, querying and updating the AABB tree at 100k and 1M objects
+	static void AABBTreeScaling();
+	// Creating and drawing many small meshes with their own buffers against packed into one geometry pool,
+	// then the pool's fragmentation after churn and what defragmenting it costs
+	static void GeometryPoolVsBuffers();
+	// Transient target memory of a deferred style frame with and without aliasing, compiled only
+	static void RenderGraphAliasing();
+	// Frame times of each lighting path over a range of light counts, at full resolution without V-Sync
+	static void LightSweep(Demo& demo);
+	// Visible disc triangles and frame times as the camera zooms out and the discs drop to coarser LODs.
+	// The demo prints the LOD chain's triangle counts when it starts.
+	static void LodDistanceSweep(Demo& demo);
+	// Frame times with the 100k transparent quads blended order independently and sorted on the CPU,
+	// with the sort time and GPU time of the transparency pass itself
+	static void TransparencySweep(Demo& demo);
+	// How many pipelines the systems created so far requested and how many distinct ones that took
+	static void PipelineSharing();
+};
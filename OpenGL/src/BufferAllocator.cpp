@@ -0,0 +1,215 @@
+#include "BufferAllocator.h"
+#include "Renderer.h"
+
+#define BIN_NONE 0xffffffff
+#define BIN_COUNT 256
+
+static inline unsigned int HighestBit(unsigned int value)
+{
+	unsigned int bit = 0;
+	while (value >>= 1)
+		bit++;
+	return bit;
+}
+
+static inline unsigned int LowestBit(unsigned int value)
+{
+	unsigned int bit = 0;
+	while (!(value & 1))
+	{
+		value >>= 1;
+		bit++;
+	}
+	return bit;
+}
+
+// Small float: 3 mantissa bits below the leading one, so 8 bins per power of two.
+// Free blocks are filed rounding down, requests round up, so any block in the found bin fits.
+static inline unsigned int BinRoundDown(unsigned int size)
+{
+	if (size < 8)
+		return size;
+	unsigned int shift = HighestBit(size) - 3;
+	return ((shift + 1) << 3) | ((size >> shift) & 7);
+}
+
+static inline unsigned int BinRoundUp(unsigned int size)
+{
+	if (size < 8)
+		return size;
+	unsigned int shift = HighestBit(size) - 3;
+	unsigned int bin = ((shift + 1) << 3) | ((size >> shift) & 7);
+	if (size & ((1u << shift) - 1))
+		bin++;
+	return bin;
+}
+
+BufferAllocator::BufferAllocator(unsigned int capacity)
+	:m_Capacity(capacity)
+{
+	Reset();
+}
+
+void BufferAllocator::Reset()
+{
+	m_Nodes.clear();
+	m_FreeNodes.clear();
+	m_BinHeads.assign(BIN_COUNT, BIN_NONE);
+	m_GroupMask = 0;
+	for (unsigned char& mask : m_BinMasks)
+		mask = 0;
+	m_FreeSpace = m_Capacity;
+	m_AllocationCount = 0;
+
+	if (m_Capacity > 0)
+		InsertFree(NewNode(0, m_Capacity));
+}
+
+unsigned int BufferAllocator::NewNode(unsigned int offset, unsigned int size)
+{
+	unsigned int index;
+	if (!m_FreeNodes.empty())
+	{
+		index = m_FreeNodes.back();
+		m_FreeNodes.pop_back();
+	}
+	else
+	{
+		index = (unsigned int)m_Nodes.size();
+		m_Nodes.push_back(Node());
+	}
+	m_Nodes[index] = { offset, size, BIN_NONE, BIN_NONE, BIN_NONE, BIN_NONE, false };
+	return index;
+}
+
+void BufferAllocator::InsertFree(unsigned int node)
+{
+	unsigned int bin = BinRoundDown(m_Nodes[node].Size);
+	m_Nodes[node].Used = false;
+	m_Nodes[node].BinPrevious = BIN_NONE;
+	m_Nodes[node].BinNext = m_BinHeads[bin];
+	if (m_BinHeads[bin] != BIN_NONE)
+		m_Nodes[m_BinHeads[bin]].BinPrevious = node;
+	m_BinHeads[bin] = node;
+
+	m_BinMasks[bin >> 3] |= 1 << (bin & 7);
+	m_GroupMask |= 1u << (bin >> 3);
+}
+
+void BufferAllocator::RemoveFree(unsigned int node)
+{
+	Node& n = m_Nodes[node];
+	unsigned int bin = BinRoundDown(n.Size);
+	if (n.BinPrevious != BIN_NONE)
+		m_Nodes[n.BinPrevious].BinNext = n.BinNext;
+	else
+		m_BinHeads[bin] = n.BinNext;
+	if (n.BinNext != BIN_NONE)
+		m_Nodes[n.BinNext].BinPrevious = n.BinPrevious;
+
+	if (m_BinHeads[bin] == BIN_NONE)
+	{
+		m_BinMasks[bin >> 3] &= ~(1 << (bin & 7));
+		if (m_BinMasks[bin >> 3] == 0)
+			m_GroupMask &= ~(1u << (bin >> 3));
+	}
+}
+
+BufferAllocation BufferAllocator::Allocate(unsigned int size)
+{
+	BufferAllocation failed = { BUFFER_ALLOCATION_FAILED, BIN_NONE };
+	if (size == 0 || size > m_FreeSpace)
+		return failed;
+
+	// Smallest non-empty bin at or above the rounded up size
+	unsigned int bin = BinRoundUp(size);
+	if (bin >= BIN_COUNT)
+		return failed;
+	unsigned int group = bin >> 3;
+	unsigned int inGroup = m_BinMasks[group] & (0xff << (bin & 7));
+	if (inGroup)
+	{
+		bin = (group << 3) | LowestBit(inGroup);
+	}
+	else
+	{
+		unsigned int groups = group + 1 < 32 ? m_GroupMask & ~((2u << group) - 1) : 0;
+		if (!groups)
+			return failed;
+		group = LowestBit(groups);
+		bin = (group << 3) | LowestBit(m_BinMasks[group]);
+	}
+
+	unsigned int node = m_BinHeads[bin];
+	RemoveFree(node);
+	m_Nodes[node].Used = true;
+
+	// The tail goes back to the free bins as its own block
+	if (m_Nodes[node].Size > size)
+	{
+		unsigned int remainder = NewNode(m_Nodes[node].Offset + size, m_Nodes[node].Size - size);
+		Node& n = m_Nodes[node];
+		n.Size = size;
+		m_Nodes[remainder].NeighbourPrevious = node;
+		m_Nodes[remainder].NeighbourNext = n.NeighbourNext;
+		if (n.NeighbourNext != BIN_NONE)
+			m_Nodes[n.NeighbourNext].NeighbourPrevious = remainder;
+		n.NeighbourNext = remainder;
+		InsertFree(remainder);
+	}
+
+	m_FreeSpace -= size;
+	m_AllocationCount++;
+	return{ m_Nodes[node].Offset, node };
+}
+
+void BufferAllocator::Free(BufferAllocation allocation)
+{
+	if (!allocation.IsValid())
+		return;
+	unsigned int node = allocation.Node;
+	ASSERT(m_Nodes[node].Used);
+	m_FreeSpace += m_Nodes[node].Size;
+	m_AllocationCount--;
+
+	// Merge with free neighbours on both sides
+	unsigned int previous = m_Nodes[node].NeighbourPrevious;
+	if (previous != BIN_NONE && !m_Nodes[previous].Used)
+	{
+		RemoveFree(previous);
+		m_Nodes[previous].Size += m_Nodes[node].Size;
+		m_Nodes[previous].NeighbourNext = m_Nodes[node].NeighbourNext;
+		if (m_Nodes[node].NeighbourNext != BIN_NONE)
+			m_Nodes[m_Nodes[node].NeighbourNext].NeighbourPrevious = previous;
+		m_FreeNodes.push_back(node);
+		node = previous;
+	}
+
+	unsigned int next = m_Nodes[node].NeighbourNext;
+	if (next != BIN_NONE && !m_Nodes[next].Used)
+	{
+		RemoveFree(next);
+		m_Nodes[node].Size += m_Nodes[next].Size;
+		m_Nodes[node].NeighbourNext = m_Nodes[next].NeighbourNext;
+		if (m_Nodes[next].NeighbourNext != BIN_NONE)
+			m_Nodes[m_Nodes[next].NeighbourNext].NeighbourPrevious = node;
+		m_FreeNodes.push_back(next);
+	}
+
+	InsertFree(node);
+}
+
+unsigned int BufferAllocator::GetLargestFreeBlock() const
+{
+	if (!m_GroupMask)
+		return 0;
+	unsigned int group = HighestBit(m_GroupMask);
+	unsigned int bin = (group << 3) | HighestBit(m_BinMasks[group]);
+	unsigned int largest = 0;
+	for (unsigned int node = m_BinHeads[bin]; node != BIN_NONE; node = m_Nodes[node].BinNext)
+	{
+		if (m_Nodes[node].Size > largest)
+			largest = m_Nodes[node].Size;
+	}
+	return largest;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include<vector>
+
+#define BUFFER_ALLOCATION_FAILED 0xffffffff
+
+struct BufferAllocation
+{
+	// In the allocator's units, BUFFER_ALLOCATION_FAILED when nothing fits
+	unsigned int Offset;
+	// Needed to free the range
+	unsigned int Node;
+
+	inline bool IsValid() const { return Offset != BUFFER_ALLOCATION_FAILED; }
+};
+
+// Two-level segregated fit allocator over a range of offsets, it never touches the memory it manages.
+// Sizes map to bins of 8 per power of two and bitmaps find a fitting free block in constant time,
+// neighbouring free blocks are merged when freed.
+class BufferAllocator
+{
+private:
+	struct Node
+	{
+		unsigned int Offset;
+		unsigned int Size;
+		unsigned int BinPrevious;
+		unsigned int BinNext;
+		unsigned int NeighbourPrevious;
+		unsigned int NeighbourNext;
+		bool Used;
+	};
+
+	unsigned int m_Capacity;
+	unsigned int m_FreeSpace;
+	unsigned int m_AllocationCount;
+	std::vector<Node> m_Nodes;
+	std::vector<unsigned int> m_FreeNodes;
+	// First free node of every bin
+	std::vector<unsigned int> m_BinHeads;
+	// Bit per non-empty group of 8 bins, and bit per non-empty bin inside each group
+	unsigned int m_GroupMask;
+	unsigned char m_BinMasks[32];
+
+public:
+	BufferAllocator(unsigned int capacity);
+
+	BufferAllocation Allocate(unsigned int size);
+	void Free(BufferAllocation allocation);
+	// Drops every allocation
+	void Reset();
+
+	inline unsigned int GetCapacity() const { return m_Capacity; }
+	inline unsigned int GetFreeSpace() const { return m_FreeSpace; }
+	inline unsigned int GetAllocationCount() const { return m_AllocationCount; }
+	unsigned int GetLargestFreeBlock() const;
+	inline unsigned int GetSize(BufferAllocation allocation) const { return m_Nodes[allocation.Node].Size; }
+
+private:
+	unsigned int NewNode(unsigned int offset, unsigned int size);
+	void InsertFree(unsigned int node);
+	void RemoveFree(unsigned int node);
+};
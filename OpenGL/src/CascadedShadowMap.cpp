@@ -0,0 +1,260 @@
+#include "CascadedShadowMap.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "GL\glew.h"
+
+#include<iostream>
+#include<iomanip>
+#include<cmath>
+#include<cstring>
+#include<string>
+
+static Texture CreateShadowTexture(unsigned int resolution)
+{
+	// Sampled with hardware depth comparison, sampler2DShadow in GLSL
+	Texture texture(resolution, resolution, GL_DEPTH_COMPONENT32F);
+	texture.Bind();
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	texture.UnBind();
+	return texture;
+}
+
+CascadedShadowMap::CascadedShadowMap(unsigned int resolution, unsigned int firstCachedCascade)
+	:m_DepthShader("res/shaders/ShadowDepth.shader"), m_Resolution(resolution), m_FirstCachedCascade(firstCachedCascade),
+	m_Caching(true), m_HadDynamicCasters(false), m_LightDirection(Normalize(Vec3{ -0.4f, -0.3f, -1.0f })),
+	m_SplitLambda(0.75f), m_CachePadding(1.25f), m_ReportInterval(0), m_Frames(0)
+{
+	m_Cascades.reserve(SHADOW_CASCADES);
+	for (unsigned int i = 0; i < SHADOW_CASCADES; i++)
+	{
+		m_Cascades.push_back({ CreateShadowTexture(resolution), FrameBuffer(), nullptr, nullptr, GpuTimer(),
+			Mat4::Identity(), { 0.0f, 0.0f, 0.0f }, 0.0f, 0.0f, false, 0 });
+		m_Cascades[i].Target.AttachDepth(m_Cascades[i].Map);
+		m_Cascades[i].Target.Validate();
+	}
+	m_Cascades.back().Target.UnBind();
+
+	// Depth only: no color target, slope scaled bias against acne and clamping instead of a near plane
+	VertexBufferLayout positions;
+	positions.Push<float>(3);
+	m_DepthPipeline = &PipelineCache::Get().Create({ &m_DepthShader, positions, { BlendState::Disabled(), BlendState::Disabled() },
+		{ true, true, GL_LESS }, { GL_NONE, true, 2.0f, 4.0f } });
+}
+
+CascadedShadowMap::~CascadedShadowMap()
+{
+	PipelineCache::Get().Release(*m_DepthPipeline);
+}
+
+void CascadedShadowMap::SetLightDirection(const Vec3& direction)
+{
+	Vec3 normalized = Normalize(direction);
+	if (Dot(normalized, m_LightDirection) > 0.999999f)
+		return;
+	m_LightDirection = normalized;
+	InvalidateStatic();
+}
+
+void CascadedShadowMap::SetCaching(bool caching)
+{
+	m_Caching = caching;
+	InvalidateStatic();
+}
+
+void CascadedShadowMap::InvalidateStatic()
+{
+	for (Cascade& cascade : m_Cascades)
+		cascade.CacheValid = false;
+}
+
+void CascadedShadowMap::Update(const Mat4& view, const Mat4& projection, float nearPlane, float farPlane)
+{
+	// Corner rays of the view frustum in view space, as near and far plane points
+	Mat4 inverseProjection = Inverse(projection);
+	Mat4 inverseView = Inverse(view);
+	Vec3 nearCorners[4], farCorners[4];
+	for (int corner = 0; corner < 4; corner++)
+	{
+		float x = (corner & 1) ? 1.0f : -1.0f, y = (corner & 2) ? 1.0f : -1.0f;
+		Vec4 nearPoint = inverseProjection * Vec4{ x, y, -1.0f, 1.0f };
+		Vec4 farPoint = inverseProjection * Vec4{ x, y, 1.0f, 1.0f };
+		nearCorners[corner] = { nearPoint.x / nearPoint.w, nearPoint.y / nearPoint.w, nearPoint.z / nearPoint.w };
+		farCorners[corner] = { farPoint.x / farPoint.w, farPoint.y / farPoint.w, farPoint.z / farPoint.w };
+	}
+
+	// Practical split scheme, logarithmic splits need a positive near plane
+	float lambda = nearPlane > 0.0f ? m_SplitLambda : 0.0f;
+	float sliceNear = nearPlane;
+	for (unsigned int i = 0; i < SHADOW_CASCADES; i++)
+	{
+		float t = (float)(i + 1) / SHADOW_CASCADES;
+		float uniformSplit = nearPlane + (farPlane - nearPlane) * t;
+		float logSplit = lambda > 0.0f ? nearPlane * powf(farPlane / nearPlane, t) : uniformSplit;
+		float sliceFar = lambda * logSplit + (1.0f - lambda) * uniformSplit;
+
+		Vec3 corners[8];
+		for (int corner = 0; corner < 4; corner++)
+		{
+			// View depth grows along -z
+			Vec3 ray = farCorners[corner] - nearCorners[corner];
+			float tNear = (sliceNear + nearCorners[corner].z) / -ray.z;
+			float tFar = (sliceFar + nearCorners[corner].z) / -ray.z;
+			corners[corner] = inverseView.TransformPoint(nearCorners[corner] + ray * tNear);
+			corners[corner + 4] = inverseView.TransformPoint(nearCorners[corner] + ray * tFar);
+		}
+
+		Cascade& cascade = m_Cascades[i];
+		cascade.SplitDepth = sliceFar;
+		bool cached = m_Caching && i >= m_FirstCachedCascade;
+		if (!cached)
+		{
+			Fit(cascade, corners, 1.0f);
+		}
+		else
+		{
+			// Keep the cached fit while the slice stays inside the area it covers
+			Vec3 center = { 0.0f, 0.0f, 0.0f };
+			for (const Vec3& corner : corners)
+				center = center + corner * 0.125f;
+			float radius = 0.0f;
+			for (const Vec3& corner : corners)
+				radius = fmaxf(radius, Length(corner - center));
+			if (!cascade.CacheValid || Length(center - cascade.Center) + radius > cascade.Radius)
+			{
+				Fit(cascade, corners, m_CachePadding);
+				cascade.CacheValid = false;
+			}
+		}
+		sliceNear = sliceFar;
+	}
+}
+
+void CascadedShadowMap::Fit(Cascade& cascade, const Vec3 corners[8], float padding) const
+{
+	Vec3 center = { 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 8; i++)
+		center = center + corners[i] * 0.125f;
+	float radius = 0.0f;
+	for (int i = 0; i < 8; i++)
+		radius = fmaxf(radius, Length(corners[i] - center));
+	// A sphere does not change size as the camera turns, rounding keeps float noise from resizing it
+	radius = ceilf(radius * padding * 16.0f) / 16.0f;
+
+	Vec3 up = fabsf(m_LightDirection.y) > 0.99f ? Vec3{ 1.0f, 0.0f, 0.0f } : Vec3{ 0.0f, 1.0f, 0.0f };
+	Mat4 lightView = Mat4::LookAt(center - m_LightDirection * radius, center, up);
+	// Casters in front of the near plane are clamped onto it while rendering
+	Mat4 lightProjection = Mat4::Orthographic(-radius, radius, -radius, radius, 0.0f, 2.0f * radius);
+
+	// Snap the projected world origin to a whole texel, moving the camera then moves the map by whole texels
+	Mat4 viewProjection = lightProjection * lightView;
+	float halfResolution = m_Resolution * 0.5f;
+	Vec3 origin = viewProjection.TransformPoint({ 0.0f, 0.0f, 0.0f });
+	lightProjection(0, 3) += (roundf(origin.x * halfResolution) - origin.x * halfResolution) / halfResolution;
+	lightProjection(1, 3) += (roundf(origin.y * halfResolution) - origin.y * halfResolution) / halfResolution;
+
+	cascade.ViewProjection = lightProjection * lightView;
+	cascade.Center = center;
+	cascade.Radius = radius;
+}
+
+void CascadedShadowMap::RenderCascade(Cascade& cascade, FrameBuffer& target, const ShadowCasterDraw& draw)
+{
+	target.Bind();
+	GLCall(glClear(GL_DEPTH_BUFFER_BIT));
+	draw(m_DepthShader, cascade.ViewProjection);
+}
+
+void CascadedShadowMap::Render(const ShadowCasterDraw& drawStatic, const ShadowCasterDraw& drawDynamic)
+{
+	bool hasDynamic = (bool)drawDynamic;
+	if (hasDynamic != m_HadDynamicCasters)
+	{
+		m_HadDynamicCasters = hasDynamic;
+		InvalidateStatic();
+	}
+
+	GLStateCache::Bind(*m_DepthPipeline);
+
+	for (unsigned int i = 0; i < SHADOW_CASCADES; i++)
+	{
+		Cascade& cascade = m_Cascades[i];
+		bool cached = m_Caching && i >= m_FirstCachedCascade;
+		if (cached && cascade.CacheValid && !hasDynamic)
+			continue;
+
+		cascade.Timer.Begin();
+		if (!cached)
+		{
+			RenderCascade(cascade, cascade.Target, drawStatic);
+			if (hasDynamic)
+				drawDynamic(m_DepthShader, cascade.ViewProjection);
+		}
+		else if (!hasDynamic)
+		{
+			RenderCascade(cascade, cascade.Target, drawStatic);
+		}
+		else
+		{
+			if (!cascade.StaticMap)
+			{
+				cascade.StaticMap.reset(new Texture(CreateShadowTexture(m_Resolution)));
+				cascade.StaticTarget.reset(new FrameBuffer());
+				cascade.StaticTarget->AttachDepth(*cascade.StaticMap);
+				cascade.StaticTarget->Validate();
+			}
+			if (!cascade.CacheValid)
+				RenderCascade(cascade, *cascade.StaticTarget, drawStatic);
+			GLCall(glCopyImageSubData(cascade.StaticMap->GetRendererID(), GL_TEXTURE_2D, 0, 0, 0, 0,
+				cascade.Map.GetRendererID(), GL_TEXTURE_2D, 0, 0, 0, 0, m_Resolution, m_Resolution, 1));
+			cascade.Target.Bind();
+			drawDynamic(m_DepthShader, cascade.ViewProjection);
+		}
+		cascade.Timer.End();
+		cascade.CacheValid = true;
+		cascade.Renders++;
+	}
+
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+	for (Cascade& cascade : m_Cascades)
+		cascade.Timer.Poll();
+	if (m_ReportInterval > 0 && ++m_Frames >= m_ReportInterval)
+		Report();
+}
+
+void CascadedShadowMap::Bind(Shader& shader, unsigned int firstSlot) const
+{
+	float matrices[SHADOW_CASCADES * 16];
+	for (unsigned int i = 0; i < SHADOW_CASCADES; i++)
+	{
+		m_Cascades[i].Map.Bind(firstSlot + i);
+		memcpy(matrices + 16 * i, m_Cascades[i].ViewProjection.m, sizeof(m_Cascades[i].ViewProjection.m));
+	}
+	shader.Bind();
+	for (unsigned int i = 0; i < SHADOW_CASCADES; i++)
+		shader.SetUniform1i("u_ShadowMaps[" + std::to_string(i) + "]", firstSlot + i);
+	shader.SetUniformMat4fv("u_ShadowMatrices", matrices, SHADOW_CASCADES);
+	shader.SetUniform3f("u_SunDirection", m_LightDirection.x, m_LightDirection.y, m_LightDirection.z);
+}
+
+void CascadedShadowMap::Report()
+{
+	// Time per frame, averaged over every frame of the interval including the ones a cascade was skipped in
+	std::cout << "[Shadows] caching " << (m_Caching ? "on " : "off") << std::fixed << std::setprecision(3);
+	double total = 0.0;
+	for (unsigned int i = 0; i < SHADOW_CASCADES; i++)
+	{
+		Cascade& cascade = m_Cascades[i];
+		double average = cascade.Timer.GetSampleCount() > 0
+			? cascade.Timer.GetTotalMilliseconds() / cascade.Timer.GetSampleCount() * cascade.Renders / m_Frames : 0.0;
+		total += average;
+		std::cout << " | cascade " << i << ": " << average << " ms (" << cascade.Renders << "/" << m_Frames << " frames)";
+		cascade.Timer.ResetTotals();
+		cascade.Renders = 0;
+	}
+	std::cout << " | total " << total << " ms" << std::defaultfloat << std::endl;
+	m_Frames = 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Shader.h"
+#include "Texture.h"
+#include "FrameBuffer.h"
+#include "GpuTimer.h"
+#include "PipelineState.h"
+#include "VectorMath.h"
+
+#include<vector>
+#include<memory>
+#include<functional>
+
+// Must match Shadows.glsl
+#define SHADOW_CASCADES 4
+
+// Draws shadow casters with the given depth shader, u_MVP has to be set to lightViewProjection * model
+typedef std::function<void(Shader& depthShader, const Mat4& lightViewProjection)> ShadowCasterDraw;
+
+// Cascaded shadow maps for one directional light.
+// Cascades are fitted to bounding spheres of the view frustum slices and snapped to whole texels, so the
+// shadow edges stay still under camera motion. The far cascades are cached: static casters are only
+// re-rendered when the light or static geometry changes or the view leaves the padded area they cover.
+class CascadedShadowMap
+{
+private:
+	struct Cascade
+	{
+		Texture Map;
+		FrameBuffer Target;
+		// Static casters only, kept so dynamic casters can be drawn over a copy each frame
+		std::unique_ptr<Texture> StaticMap;
+		std::unique_ptr<FrameBuffer> StaticTarget;
+		GpuTimer Timer;
+		Mat4 ViewProjection;
+		Vec3 Center;
+		float Radius;
+		float SplitDepth;
+		bool CacheValid;
+		unsigned int Renders;
+	};
+
+	Shader m_DepthShader;
+	const PipelineState* m_DepthPipeline;
+	std::vector<Cascade> m_Cascades;
+	unsigned int m_Resolution;
+	unsigned int m_FirstCachedCascade;
+	bool m_Caching;
+	bool m_HadDynamicCasters;
+	Vec3 m_LightDirection;
+	float m_SplitLambda;
+	float m_CachePadding;
+	unsigned int m_ReportInterval;
+	unsigned int m_Frames;
+
+public:
+	// Cascades from firstCachedCascade on are cached
+	CascadedShadowMap(unsigned int resolution = 1024, unsigned int firstCachedCascade = 2);
+	~CascadedShadowMap();
+	CascadedShadowMap(const CascadedShadowMap&) = delete;
+	CascadedShadowMap& operator=(const CascadedShadowMap&) = delete;
+
+	// Direction the light travels in
+	void SetLightDirection(const Vec3& direction);
+	void SetCaching(bool caching);
+	inline bool IsCaching() const { return m_Caching; }
+	// Blend between uniform (0) and logarithmic (1) split distances
+	inline void SetSplitLambda(float lambda) { m_SplitLambda = lambda; }
+	// Static casters moved, the cached cascades are redrawn
+	void InvalidateStatic();
+	// Prints the average shadow pass time per cascade every 'frames' frames, 0 disables reporting
+	inline void SetReportInterval(unsigned int frames) { m_ReportInterval = frames; }
+
+	// Fits the cascades to the view depths [nearPlane, farPlane] of the camera
+	void Update(const Mat4& view, const Mat4& projection, float nearPlane, float farPlane);
+	// Renders the cascades that need it, drawDynamic may be empty. The depth pipeline stays bound afterwards.
+	void Render(const ShadowCasterDraw& drawStatic, const ShadowCasterDraw& drawDynamic);
+
+	// Binds the maps from firstSlot on and sets the Shadows.glsl uniforms
+	void Bind(Shader& shader, unsigned int firstSlot) const;
+
+	inline const Vec3& GetLightDirection() const { return m_LightDirection; }
+	inline const Mat4& GetViewProjection(unsigned int cascade) const { return m_Cascades[cascade].ViewProjection; }
+
+private:
+	void Fit(Cascade& cascade, const Vec3 corners[8], float padding) const;
+	void RenderCascade(Cascade& cascade, FrameBuffer& target, const ShadowCasterDraw& draw);
+	void Report();
+};
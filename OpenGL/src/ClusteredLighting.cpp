@@ -0,0 +1,112 @@
+#include "ClusteredLighting.h"
+#include "Renderer.h"
+#include "GL\glew.h"
+
+#include<iostream>
+#include<cstring>
+
+#define CLUSTER_GROUP_SIZE 128
+
+// Feature bits of ClusterLights.shader
+#define CLUSTER_BUILD_BOUNDS 1
+#define CLUSTER_COUNT_LIGHTS 2
+
+std::vector<std::string> ClusteredLighting::GetShaderDefines()
+{
+	return {
+		"CLUSTER_X " + std::to_string(CLUSTER_X),
+		"CLUSTER_Y " + std::to_string(CLUSTER_Y),
+		"CLUSTER_Z " + std::to_string(CLUSTER_Z),
+		"CLUSTER_INDEX_CAPACITY " + std::to_string(CLUSTER_INDEX_CAPACITY) + "u"
+	};
+}
+
+ClusteredLighting::ClusteredLighting()
+	:m_BinningVariants("res/shaders/ClusterLights.shader", { "BUILD_BOUNDS", "COUNT_LIGHTS" }, GetShaderDefines()),
+	m_BoundsShader(m_BinningVariants.Get(CLUSTER_BUILD_BOUNDS)), m_CountShader(m_BinningVariants.Get(CLUSTER_COUNT_LIGHTS)),
+	m_CullShader(m_BinningVariants.Get(0)),
+	m_LightBuffer(nullptr, MAX_POINT_LIGHTS * sizeof(PointLight)),
+	m_BoundsBuffer(nullptr, CLUSTER_COUNT * 8 * sizeof(float)),
+	m_GridBuffer(nullptr, CLUSTER_COUNT * 2 * sizeof(unsigned int)),
+	m_IndexBuffer(nullptr, CLUSTER_INDEX_CAPACITY * sizeof(unsigned int)),
+	m_TotalsBuffer(nullptr, 2 * sizeof(unsigned int)),
+	m_LightCount(0), m_Projection(Mat4::Identity()), m_Near(0.1f), m_Far(100.0f), m_Perspective(true), m_BoundsDirty(true),
+	m_ReportInterval(0), m_Frames(0)
+{
+}
+
+void ClusteredLighting::SetLights(const PointLight* lights, unsigned int count)
+{
+	m_LightCount = count < MAX_POINT_LIGHTS ? count : MAX_POINT_LIGHTS;
+	if (m_LightCount > 0)
+		m_LightBuffer.SetData(0, lights, m_LightCount * sizeof(PointLight));
+}
+
+void ClusteredLighting::SetProjection(const Mat4& projection, float nearPlane, float farPlane, bool perspective)
+{
+	if (memcmp(projection.m, m_Projection.m, sizeof(m_Projection.m)) == 0 && nearPlane == m_Near && farPlane == m_Far && perspective == m_Perspective)
+		return;
+	m_Projection = projection;
+	m_Near = nearPlane;
+	m_Far = farPlane;
+	m_Perspective = perspective;
+	m_BoundsDirty = true;
+}
+
+void ClusteredLighting::Update(const Mat4& view)
+{
+	unsigned int groups = (CLUSTER_COUNT + CLUSTER_GROUP_SIZE - 1) / CLUSTER_GROUP_SIZE;
+	m_LightBuffer.BindBase(POINT_LIGHTS_BINDING);
+	m_BoundsBuffer.BindBase(CLUSTER_BOUNDS_BINDING);
+	m_GridBuffer.BindBase(CLUSTER_GRID_BINDING);
+	m_IndexBuffer.BindBase(CLUSTER_INDICES_BINDING);
+	m_TotalsBuffer.BindBase(CLUSTER_TOTALS_BINDING);
+
+	if (m_BoundsDirty)
+	{
+		m_BoundsShader.Bind();
+		m_BoundsShader.SetUniformMat4f("u_InverseProjection", Inverse(m_Projection).m);
+		m_BoundsShader.SetUniform2f("u_ClusterDepth", m_Near, m_Far);
+		m_BoundsShader.SetUniform1i("u_ClusterLogarithmic", m_Perspective ? 1 : 0);
+		m_BoundsShader.Dispatch(groups);
+		GLCall(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+		m_BoundsDirty = false;
+	}
+
+	// Both passes test every light against every cluster, the first only to size the lists
+	const unsigned int zeros[2] = { 0, 0 };
+	m_TotalsBuffer.SetData(0, zeros, sizeof(zeros));
+	for (Shader* shader : { &m_CountShader, &m_CullShader })
+	{
+		shader->Bind();
+		shader->SetUniformMat4f("u_View", view.m);
+		shader->SetUniform1ui("u_LightCount", m_LightCount);
+		shader->Dispatch(groups);
+		GLCall(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+	}
+
+	if (m_ReportInterval > 0 && ++m_Frames >= m_ReportInterval)
+		Report();
+}
+
+void ClusteredLighting::Report()
+{
+	unsigned int totals[2] = { 0, 0 };
+	m_TotalsBuffer.GetData(0, totals, sizeof(totals));
+	std::cout << "[Clustered] " << m_LightCount << " lights: " << totals[0] << " of " << CLUSTER_INDEX_CAPACITY
+		<< " light indices, up to " << totals[1] << " lights in a cluster" << std::endl;
+	if (totals[0] > CLUSTER_INDEX_CAPACITY)
+		std::cout << "[Clustered] Index list overflow, lights of " << totals[0] - CLUSTER_INDEX_CAPACITY << " cluster entries were dropped" << std::endl;
+	m_Frames = 0;
+}
+
+void ClusteredLighting::Bind(Shader& shader, unsigned int width, unsigned int height) const
+{
+	m_LightBuffer.BindBase(POINT_LIGHTS_BINDING);
+	m_GridBuffer.BindBase(CLUSTER_GRID_BINDING);
+	m_IndexBuffer.BindBase(CLUSTER_INDICES_BINDING);
+	shader.Bind();
+	shader.SetUniform2f("u_ClusterDepth", m_Near, m_Far);
+	shader.SetUniform2f("u_ClusterTileSize", (float)width / CLUSTER_X, (float)height / CLUSTER_Y);
+	shader.SetUniform1i("u_ClusterLogarithmic", m_Perspective ? 1 : 0);
+}
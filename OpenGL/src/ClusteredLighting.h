@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Shader.h"
+#include "ShaderVariantCache.h"
+#include "ShaderStorageBuffer.h"
+#include "VectorMath.h"
+#include "Light.h"
+
+#include<string>
+#include<vector>
+
+// Froxel grid: screen tiles times depth slices
+#define CLUSTER_X 16
+#define CLUSTER_Y 9
+#define CLUSTER_Z 24
+#define CLUSTER_COUNT (CLUSTER_X * CLUSTER_Y * CLUSTER_Z)
+// Light indices of all clusters together. Each cluster's list is as long as it needs to be, sized for
+// MAX_POINT_LIGHTS lights spread over the demo scene. Clusters past the end keep what fits.
+#define CLUSTER_INDEX_CAPACITY (1 << 22)
+
+#define CLUSTER_BOUNDS_BINDING 5
+// Offset and count of every cluster's list
+#define CLUSTER_GRID_BINDING 6
+#define CLUSTER_INDICES_BINDING 7
+// Indices requested this frame and the longest list, binning only
+#define CLUSTER_TOTALS_BINDING 9
+
+// Clustered forward shading. Compute passes bin the lights into view space froxels, first counting
+// each cluster's lights and reserving room for them in one shared index list, then writing the indices.
+// Fragment shaders including Clustered.glsl loop over their own cluster's lights only.
+class ClusteredLighting
+{
+private:
+	// ClusterLights.shader with BUILD_BOUNDS computes the cluster bounds, with COUNT_LIGHTS counts and
+	// reserves, with neither writes the light indices
+	ShaderVariantCache m_BinningVariants;
+	Shader& m_BoundsShader;
+	Shader& m_CountShader;
+	Shader& m_CullShader;
+	ShaderStorageBuffer m_LightBuffer;
+	ShaderStorageBuffer m_BoundsBuffer;
+	ShaderStorageBuffer m_GridBuffer;
+	ShaderStorageBuffer m_IndexBuffer;
+	ShaderStorageBuffer m_TotalsBuffer;
+	unsigned int m_LightCount;
+	Mat4 m_Projection;
+	float m_Near;
+	float m_Far;
+	bool m_Perspective;
+	bool m_BoundsDirty;
+	unsigned int m_ReportInterval;
+	unsigned int m_Frames;
+
+public:
+	ClusteredLighting();
+
+	// Clamped to MAX_POINT_LIGHTS
+	void SetLights(const PointLight* lights, unsigned int count);
+	// The slices cover view depths [nearPlane, farPlane], exponentially for perspective projections.
+	// Cluster bounds are only rebuilt when this changes.
+	void SetProjection(const Mat4& projection, float nearPlane, float farPlane, bool perspective);
+
+	// Bins the lights for this view, must run before the shading draws
+	void Update(const Mat4& view);
+	// Binds the light and cluster buffers and sets the cluster uniforms on a shader including Clustered.glsl
+	void Bind(Shader& shader, unsigned int width, unsigned int height) const;
+	// Prints the index list use of the latest binning every 'frames' updates, which waits for it to finish.
+	// 0 disables reporting.
+	inline void SetReportInterval(unsigned int frames) { m_ReportInterval = frames; }
+
+	inline unsigned int GetLightCount() const { return m_LightCount; }
+
+	// Grid constants for every shader including Clustered.glsl
+	static std::vector<std::string> GetShaderDefines();
+
+private:
+	void Report();
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "VectorMath.h"
+#include "ResourcePool.h"
+#include "SceneGraph.h"
+
+class VertexArray;
+class IndexBuffer;
+class Shader;
+class Mesh;
+
+// Components of renderable entities, plain data so chunks can copy them freely
+
+struct TransformComponent
+{
+	Mat4 World;
+};
+
+// Entities placed by the scene graph, the node's world matrix is copied into TransformComponent after its Update
+struct SceneNodeComponent
+{
+	SceneNodeID Node;
+};
+
+struct BoundsComponent
+{
+	Sphere WorldBounds;
+};
+
+struct MeshComponent
+{
+	ResourceHandle<VertexArray> VArray;
+	ResourceHandle<IndexBuffer> IBuffer;
+	// Position attribute only, for depth-only passes
+	ResourceHandle<VertexArray> DepthVArray;
+};
+
+struct MaterialComponent
+{
+	ResourceHandle<Shader> MaterialShader;
+	float Color[4];
+};
+
+// Entities with a LOD chain, the chosen level's index buffer is written into MeshComponent
+struct LodComponent
+{
+	const Mesh* LodMesh;
+	unsigned int Lod;
+};
\ No newline at end of file
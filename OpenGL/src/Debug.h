@@ -0,0 +1,4 @@
+#pragma once
+
+// Compiler dependent assertion macro
+#define ASSERT(x) if(!(x)) __debugbreak();
@@ -0,0 +1,193 @@
+#include "DeferredRenderer.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "GL\glew.h"
+
+#include<vector>
+#include<cmath>
+
+#define SPHERE_RINGS 8
+#define SPHERE_SEGMENTS 12
+
+// Feature bits of DeferredLight.shader
+#define DEFERRED_AMBIENT 1
+
+// Unit sphere with outward facing counter-clockwise triangles, widened so its flat faces enclose the true sphere
+static const std::vector<float>& GetSphereVertices()
+{
+	static std::vector<float> vertices;
+	if (vertices.empty())
+	{
+		const float pi = 3.14159265f;
+		float scale = 1.0f / (cosf(pi / SPHERE_RINGS) * cosf(pi / SPHERE_SEGMENTS));
+		for (int ring = 0; ring <= SPHERE_RINGS; ring++)
+		{
+			float polar = ring * pi / SPHERE_RINGS;
+			for (int segment = 0; segment < SPHERE_SEGMENTS; segment++)
+			{
+				float azimuth = segment * 2.0f * pi / SPHERE_SEGMENTS;
+				vertices.insert(vertices.end(), { scale * sinf(polar) * cosf(azimuth), scale * sinf(polar) * sinf(azimuth), scale * cosf(polar) });
+			}
+		}
+	}
+	return vertices;
+}
+
+static const std::vector<unsigned int>& GetSphereIndices()
+{
+	static std::vector<unsigned int> indices;
+	if (indices.empty())
+	{
+		for (unsigned int ring = 0; ring < SPHERE_RINGS; ring++)
+		{
+			for (unsigned int segment = 0; segment < SPHERE_SEGMENTS; segment++)
+			{
+				unsigned int next = (segment + 1) % SPHERE_SEGMENTS;
+				unsigned int a = ring * SPHERE_SEGMENTS + segment, b = ring * SPHERE_SEGMENTS + next;
+				unsigned int c = a + SPHERE_SEGMENTS, d = b + SPHERE_SEGMENTS;
+				// The pole rings collapse to a point, skip their degenerate halves
+				if (ring > 0)
+					indices.insert(indices.end(), { a, c, b });
+				if (ring < SPHERE_RINGS - 1)
+					indices.insert(indices.end(), { b, c, d });
+			}
+		}
+	}
+	return indices;
+}
+
+DeferredRenderer::DeferredRenderer()
+	:m_LightVariants("res/shaders/DeferredLight.shader", { "AMBIENT" }),
+	m_LightShader(m_LightVariants.Get(0)), m_AmbientShader(m_LightVariants.Get(DEFERRED_AMBIENT)),
+	m_SphereBuffer(GetSphereVertices().data(), (unsigned int)(GetSphereVertices().size() * sizeof(float))),
+	m_SphereIndices(GetSphereIndices().data(), (unsigned int)GetSphereIndices().size()),
+	m_LightBuffer(nullptr, MAX_POINT_LIGHTS * sizeof(PointLight)),
+	m_LightCount(0), m_Ambient{ 0.05f, 0.05f, 0.05f }, m_SunColor{ 1.0f, 1.0f, 1.0f }, m_Shadows(nullptr),
+	m_DepthCopy(RENDER_GRAPH_NONE)
+{
+	VertexBufferLayout layout;
+	layout.Push<float>(3);
+	m_SphereArray.AddBuffer(m_SphereBuffer, layout);
+	m_SphereArray.UnBind();
+
+	// Back faces only, with depth clamping, so volumes still shade when the camera is inside them or they cross the far plane.
+	// A back face at or behind the stored depth has the surface inside or in front of the volume, anything else is culled
+	// by the depth test before shading.
+	m_LightPipeline = &PipelineCache::Get().Create({ &m_LightShader, layout, { BlendState::Additive(), BlendState::Additive() },
+		{ true, false, GL_GEQUAL }, { GL_FRONT, true, 0.0f, 0.0f } });
+}
+
+DeferredRenderer::~DeferredRenderer()
+{
+	PipelineCache::Get().Release(*m_LightPipeline);
+}
+
+void DeferredRenderer::SetLights(const PointLight* lights, unsigned int count)
+{
+	m_LightCount = count < MAX_POINT_LIGHTS ? count : MAX_POINT_LIGHTS;
+	if (m_LightCount > 0)
+		m_LightBuffer.SetData(0, lights, m_LightCount * sizeof(PointLight));
+}
+
+void DeferredRenderer::SetAmbient(float r, float g, float b)
+{
+	m_Ambient[0] = r;
+	m_Ambient[1] = g;
+	m_Ambient[2] = b;
+}
+
+void DeferredRenderer::SetSunColor(float r, float g, float b)
+{
+	m_SunColor[0] = r;
+	m_SunColor[1] = g;
+	m_SunColor[2] = b;
+}
+
+GBufferTargets DeferredRenderer::AddGeometryPass(RenderGraph& graph, unsigned int width, unsigned int height, const std::function<void()>& draw) const
+{
+	GBufferTargets targets;
+	graph.AddPass("GBuffer", [&](RenderGraphBuilder& builder)
+	{
+		targets.AlbedoRoughness = builder.CreateTexture("AlbedoRoughness", { width, height, GL_RGBA8 });
+		targets.NormalMetallic = builder.CreateTexture("NormalMetallic", { width, height, GL_RGB10_A2 });
+		targets.Depth = builder.CreateTexture("GBufferDepth", { width, height, GL_DEPTH_COMPONENT24 });
+	}, [draw](RenderGraph&)
+	{
+		// Depth is needed to rebuild positions and decides visibility, the nearest surface of each pixel is lit
+		GLStateCache::SetDepthState({ true, true, GL_LESS });
+		GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+		draw();
+	});
+	return targets;
+}
+
+RenderGraphResource DeferredRenderer::AddLightingPass(RenderGraph& graph, const GBufferTargets& gBuffer, const Mat4& viewProjection)
+{
+	// Sampling a texture attached to the framebuffer being drawn is a feedback loop even without depth writes
+	RenderGraphTextureDesc depthDesc = graph.GetDesc(gBuffer.Depth);
+	graph.AddPass("GBufferDepthCopy", [&](RenderGraphBuilder& builder)
+	{
+		builder.Read(gBuffer.Depth);
+		m_DepthCopy = builder.CreateTexture("GBufferDepthCopy", depthDesc);
+	}, [this, gBuffer](RenderGraph& graph)
+	{
+		const Texture& source = graph.GetTexture(gBuffer.Depth);
+		const Texture& copy = graph.GetTexture(m_DepthCopy);
+		GLCall(glCopyImageSubData(source.GetRendererID(), GL_TEXTURE_2D, 0, 0, 0, 0,
+			copy.GetRendererID(), GL_TEXTURE_2D, 0, 0, 0, 0, source.GetWidth(), source.GetHeight(), 1));
+	});
+
+	RenderGraphResource lit = RENDER_GRAPH_NONE;
+	RenderGraphResource depthCopy = m_DepthCopy;
+	graph.AddPass("DeferredLighting", [&](RenderGraphBuilder& builder)
+	{
+		builder.Read(gBuffer.AlbedoRoughness);
+		builder.Read(gBuffer.NormalMetallic);
+		builder.Read(depthCopy);
+		builder.ReadDepth(gBuffer.Depth);
+		lit = builder.CreateTexture("LightAccumulation", { depthDesc.Width, depthDesc.Height, GL_RGBA16F });
+	}, [this, gBuffer, depthCopy, viewProjection](RenderGraph& graph)
+	{
+		const Texture& depth = graph.GetTexture(depthCopy);
+		graph.GetTexture(gBuffer.AlbedoRoughness).Bind(0);
+		graph.GetTexture(gBuffer.NormalMetallic).Bind(1);
+		depth.Bind(2);
+
+		// Ambient and sun cover every pixel, so the target needs no clear
+		Mat4 inverseViewProjection = Inverse(viewProjection);
+		m_AmbientShader.Bind();
+		m_AmbientShader.SetUniform1i("u_AlbedoRoughness", 0);
+		m_AmbientShader.SetUniform1i("u_NormalMetallic", 1);
+		m_AmbientShader.SetUniform1i("u_Depth", 2);
+		m_AmbientShader.SetUniformMat4f("u_InverseViewProjection", inverseViewProjection.m);
+		m_AmbientShader.SetUniform2f("u_InverseSize", 1.0f / depth.GetWidth(), 1.0f / depth.GetHeight());
+		m_AmbientShader.SetUniform3f("u_Ambient", m_Ambient[0], m_Ambient[1], m_Ambient[2]);
+		if (m_Shadows)
+		{
+			m_Shadows->Bind(m_AmbientShader, 3);
+			m_AmbientShader.SetUniform3f("u_SunColor", m_SunColor[0], m_SunColor[1], m_SunColor[2]);
+		}
+		else
+		{
+			m_AmbientShader.SetUniform3f("u_SunColor", 0.0f, 0.0f, 0.0f);
+		}
+		m_Fullscreen.Draw(m_AmbientShader);
+
+		if (m_LightCount == 0)
+			return;
+
+		GLStateCache::Bind(*m_LightPipeline);
+		m_LightShader.SetUniform1i("u_AlbedoRoughness", 0);
+		m_LightShader.SetUniform1i("u_NormalMetallic", 1);
+		m_LightShader.SetUniform1i("u_Depth", 2);
+		m_LightShader.SetUniformMat4f("u_ViewProjection", viewProjection.m);
+		m_LightShader.SetUniformMat4f("u_InverseViewProjection", inverseViewProjection.m);
+		m_LightShader.SetUniform2f("u_InverseSize", 1.0f / depth.GetWidth(), 1.0f / depth.GetHeight());
+		m_LightBuffer.BindBase(POINT_LIGHTS_BINDING);
+		m_SphereArray.Bind();
+		m_SphereIndices.Bind();
+		GLCall(glDrawElementsInstanced(GL_TRIANGLES, m_SphereIndices.GetCount(), GL_UNSIGNED_INT, nullptr, m_LightCount));
+		GLStats::RecordDraw(GL_TRIANGLES, m_SphereIndices.GetCount(), m_LightCount);
+	});
+	return lit;
+}
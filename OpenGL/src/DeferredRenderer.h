@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Shader.h"
+#include "ShaderVariantCache.h"
+#include "ShaderStorageBuffer.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "RenderGraph.h"
+#include "VectorMath.h"
+#include "Light.h"
+#include "CascadedShadowMap.h"
+#include "FullscreenTriangle.h"
+#include "PipelineState.h"
+
+#include<functional>
+
+struct GBufferTargets
+{
+	// RGBA8: albedo, roughness
+	RenderGraphResource AlbedoRoughness;
+	// RGB10_A2: octahedral normal, metallic
+	RenderGraphResource NormalMetallic;
+	RenderGraphResource Depth;
+};
+
+// Deferred shading on top of the render graph. Lights are drawn as instanced sphere volumes with additive
+// blending. Their back faces are depth tested against the G-buffer, so each light only shades the pixels
+// whose surface lies in front of its far side instead of its whole screen footprint.
+class DeferredRenderer
+{
+private:
+	// Light volumes and, with AMBIENT, the fullscreen ambient and sun pass
+	ShaderVariantCache m_LightVariants;
+	Shader& m_LightShader;
+	Shader& m_AmbientShader;
+	VertexBuffer m_SphereBuffer;
+	IndexBuffer m_SphereIndices;
+	VertexArray m_SphereArray;
+	const PipelineState* m_LightPipeline;
+	FullscreenTriangle m_Fullscreen;
+	ShaderStorageBuffer m_LightBuffer;
+	unsigned int m_LightCount;
+	float m_Ambient[3];
+	float m_SunColor[3];
+	const CascadedShadowMap* m_Shadows;
+	// Copy of the G-buffer depth sampled by the light volumes while the original is their depth attachment.
+	// Set by the copy pass's setup, after its execute callback was bound.
+	RenderGraphResource m_DepthCopy;
+
+public:
+	DeferredRenderer();
+	~DeferredRenderer();
+	DeferredRenderer(const DeferredRenderer&) = delete;
+	DeferredRenderer& operator=(const DeferredRenderer&) = delete;
+
+	// Clamped to MAX_POINT_LIGHTS
+	void SetLights(const PointLight* lights, unsigned int count);
+	void SetAmbient(float r, float g, float b);
+	// The sun comes from the shadow map's light direction and is off without one
+	void SetSunColor(float r, float g, float b);
+	inline void SetShadows(const CascadedShadowMap* shadows) { m_Shadows = shadows; }
+
+	// The draw function renders the scene with shaders writing the G-buffer outputs of GBuffer.shader
+	GBufferTargets AddGeometryPass(RenderGraph& graph, unsigned int width, unsigned int height, const std::function<void()>& draw) const;
+	// Returns the RGBA16F lit scene
+	RenderGraphResource AddLightingPass(RenderGraph& graph, const GBufferTargets& gBuffer, const Mat4& viewProjection);
+
+	inline unsigned int GetLightCount() const { return m_LightCount; }
+	inline const float* GetAmbient() const { return m_Ambient; }
+	inline const float* GetSunColor() const { return m_SunColor; }
+	// Bound at POINT_LIGHTS_BINDING, the forward shader reads the same lights
+	inline const ShaderStorageBuffer& GetLightBuffer() const { return m_LightBuffer; }
+};
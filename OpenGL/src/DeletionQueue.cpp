@@ -0,0 +1,102 @@
+#include "DeletionQueue.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "GL\glew.h"
+
+std::mutex DeletionQueue::s_Mutex;
+std::vector<unsigned int> DeletionQueue::s_Pending[GL_RESOURCE_TYPE_COUNT];
+std::deque<DeletionBatch> DeletionQueue::s_Batches;
+unsigned long long DeletionQueue::s_Deleted = 0;
+
+void DeletionQueue::Enqueue(GLResourceType type, unsigned int object)
+{
+	if (object == 0)
+		return;
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	s_Pending[(int)type].push_back(object);
+}
+
+void DeletionQueue::EndFrame()
+{
+	DeletionBatch batch;
+	bool empty = true;
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		for (int type = 0; type < GL_RESOURCE_TYPE_COUNT; type++)
+		{
+			empty = empty && s_Pending[type].empty();
+			batch.Objects[type].swap(s_Pending[type]);
+		}
+	}
+	if (!empty)
+	{
+		GLCall(batch.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+		s_Batches.push_back(std::move(batch));
+	}
+
+	// Batches complete in order, stop at the first fence the GPU has not reached
+	while (!s_Batches.empty())
+	{
+		GLCall(GLenum status = glClientWaitSync((GLsync)s_Batches.front().Fence, 0, 0));
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			break;
+		Delete(s_Batches.front());
+		s_Batches.pop_front();
+	}
+}
+
+void DeletionQueue::Flush()
+{
+	EndFrame();
+	GLCall(glFinish());
+	while (!s_Batches.empty())
+	{
+		Delete(s_Batches.front());
+		s_Batches.pop_front();
+	}
+}
+
+unsigned int DeletionQueue::GetPendingBatchCount()
+{
+	return (unsigned int)s_Batches.size();
+}
+
+void DeletionQueue::Delete(DeletionBatch& batch)
+{
+	GLCall(glDeleteSync((GLsync)batch.Fence));
+
+	std::vector<unsigned int>* objects = batch.Objects;
+	if (!objects[(int)GLResourceType::BUFFER].empty())
+	{
+		GLCall(glDeleteBuffers((GLsizei)objects[(int)GLResourceType::BUFFER].size(), objects[(int)GLResourceType::BUFFER].data()));
+	}
+	if (!objects[(int)GLResourceType::VERTEX_ARRAY].empty())
+	{
+		GLCall(glDeleteVertexArrays((GLsizei)objects[(int)GLResourceType::VERTEX_ARRAY].size(), objects[(int)GLResourceType::VERTEX_ARRAY].data()));
+	}
+	// Programs and shaders have no bulk delete
+	for (unsigned int program : objects[(int)GLResourceType::PROGRAM])
+	{
+		GLStateCache::ForgetProgram(program);
+		GLCall(glDeleteProgram(program));
+	}
+	for (unsigned int shader : objects[(int)GLResourceType::SHADER])
+	{
+		GLCall(glDeleteShader(shader));
+	}
+	if (!objects[(int)GLResourceType::TEXTURE].empty())
+	{
+		GLCall(glDeleteTextures((GLsizei)objects[(int)GLResourceType::TEXTURE].size(), objects[(int)GLResourceType::TEXTURE].data()));
+	}
+	if (!objects[(int)GLResourceType::FRAMEBUFFER].empty())
+	{
+		GLCall(glDeleteFramebuffers((GLsizei)objects[(int)GLResourceType::FRAMEBUFFER].size(), objects[(int)GLResourceType::FRAMEBUFFER].data()));
+	}
+	if (!objects[(int)GLResourceType::QUERY].empty())
+	{
+		GLCall(glDeleteQueries((GLsizei)objects[(int)GLResourceType::QUERY].size(), objects[(int)GLResourceType::QUERY].data()));
+	}
+
+	for (int type = 0; type < GL_RESOURCE_TYPE_COUNT; type++)
+		s_Deleted += objects[type].size();
+}
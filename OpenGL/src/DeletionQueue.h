@@ -0,0 +1,46 @@
+#pragma once
+
+#include<vector>
+#include<deque>
+#include<mutex>
+
+enum class GLResourceType
+{
+	BUFFER = 0, VERTEX_ARRAY = 1, PROGRAM = 2, SHADER = 3, TEXTURE = 4, FRAMEBUFFER = 5, QUERY = 6
+};
+
+#define GL_RESOURCE_TYPE_COUNT 7
+
+// GL objects released during a frame, deleted in bulk once the GPU has passed the frame's fence
+struct DeletionBatch
+{
+	// GLsync, kept opaque so the header does not need GL
+	void* Fence;
+	std::vector<unsigned int> Objects[GL_RESOURCE_TYPE_COUNT];
+};
+
+// Deferred destruction of GL objects. Any thread may enqueue, only the GL thread deletes:
+// EndFrame fences everything released since the previous frame and deletes the batches the GPU has finished.
+class DeletionQueue
+{
+private:
+	static std::mutex s_Mutex;
+	static std::vector<unsigned int> s_Pending[GL_RESOURCE_TYPE_COUNT];
+	static std::deque<DeletionBatch> s_Batches;
+	static unsigned long long s_Deleted;
+
+public:
+	// Thread-safe, 0 is ignored
+	static void Enqueue(GLResourceType type, unsigned int object);
+
+	// GL thread, after the frame's last command. Never waits on the GPU.
+	static void EndFrame();
+	// GL thread, waits for the GPU and deletes everything, for shutdown before the context goes away
+	static void Flush();
+
+	static unsigned int GetPendingBatchCount();
+	static inline unsigned long long GetDeletedCount() { return s_Deleted; }
+
+private:
+	static void Delete(DeletionBatch& batch);
+};
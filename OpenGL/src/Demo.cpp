@@ -0,0 +1,609 @@
+#include "Demo.h"
+#include "GLStateCache.h"
+#include "DeletionQueue.h"
+#include "ThreadPool.h"
+#include "GL\glew.h"
+#include "GLFW\glfw3.h"
+
+#include<iostream>
+#include<cmath>
+
+#define DISC_SEGMENTS 96
+#define GRID_SIZE 32
+#define ITEM_SCALE 0.1f
+#define SPACING 0.15f
+// Triangles up to octagons
+#define CLUTTER_MIN_SIDES 3
+#define CLUTTER_MAX_SIDES 8
+#define CLUTTER_COUNT 512
+// Feature bit of the scene shader variants
+#define SCENE_GPU_INSTANCES 1
+
+static const float s_PanelPositions[] = {
+	-0.5f, -0.5f, 0.0f,
+	 0.5f, -0.5f, 0.0f,
+	 0.5f, 0.5f, 0.0f,
+	-0.5f, 0.5f, 0.0f
+};
+
+static const unsigned int s_PanelIndices[] = {
+	0,1,2,
+	2,3,0
+};
+
+static const char* s_LightingPathNames[] = { "deferred", "clustered forward", "forward" };
+static const char* s_TransparencyNames[] = { "off", "weighted blended", "sorted" };
+
+// Finely tessellated disc, its LOD chain is generated at load time
+static Mesh CreateDisc(RenderResources& resources)
+{
+	std::vector<float> vertices = { 0.0f, 0.0f, 0.0f };
+	std::vector<unsigned int> indices;
+	for (int i = 0; i < DISC_SEGMENTS; i++)
+	{
+		float angle = i * 6.2831853f / DISC_SEGMENTS;
+		vertices.insert(vertices.end(), { 0.5f * cosf(angle), 0.5f * sinf(angle), 0.0f });
+		indices.insert(indices.end(), { 0, (unsigned int)(1 + i), (unsigned int)(1 + (i + 1) % DISC_SEGMENTS) });
+	}
+	VertexBufferLayout layout;
+	layout.Push<float>(3);
+	return Mesh(resources, vertices.data(), DISC_SEGMENTS + 1, layout, indices.data(), (unsigned int)indices.size());
+}
+
+static VertexBufferLayout GetPanelLayout()
+{
+	VertexBufferLayout layout;
+	layout.Push<float>(3);
+	return layout;
+}
+
+DemoSettings DemoSettings::Default()
+{
+	DemoSettings settings;
+	settings.Lighting = LightingPath::DEFERRED;
+	settings.LightCount = 256;
+	settings.VSync = true;
+	settings.ShadowCaching = true;
+	// 50% to 100% of the window size, whatever keeps the GPU under 12 ms
+	settings.Resolution = { 0.5f, 1.0f, 12.0 };
+	settings.ResolutionLogging = false;
+	settings.Transparency = DemoTransparency::WEIGHTED_BLENDED;
+	settings.DepthPrepass = true;
+	settings.Zoom = 0.0f;
+	return settings;
+}
+
+Demo::Demo(GLFWwindow* window, unsigned int width, unsigned int height)
+	:m_Window(window), m_Width(width), m_Height(height), m_Settings(DemoSettings::Default()), m_ReportInterval(300),
+	m_PanelBuffer(s_PanelPositions, sizeof(s_PanelPositions)), m_PanelIndices(s_PanelIndices, 6),
+	m_PanelWorld(Mat4::Translation({ 0.0f, 0.0f, 0.5f }) * Mat4::Scale({ 1.2f, 0.9f, 1.0f })),
+	m_ClutterPool(GetPanelLayout(), 1024, 4096),
+	m_DiscMesh(CreateDisc(m_Resources)), m_VisibleTriangles(0),
+	m_ForwardVariants("res/shaders/ForwardLit.shader", { "GPU_INSTANCES" }),
+	m_ClusteredVariants("res/shaders/ClusteredForward.shader", { "GPU_INSTANCES" }, ClusteredLighting::GetShaderDefines()),
+	m_PrepassVariants("res/shaders/ShadowDepth.shader", { "GPU_INSTANCES" }),
+	m_GBufferVariants("res/shaders/GBuffer.shader", { "GPU_INSTANCES" }),
+	m_ForwardShader(m_ForwardVariants.Get(0)), m_ClusteredShader(m_ClusteredVariants.Get(0)), m_PrepassShader(m_PrepassVariants.Get(0)),
+	m_Shadows(1024, 2),
+	m_DynamicResolution(m_Settings.Resolution),
+	m_Pacer(FramePacingMode::VSYNC, 2),
+	m_PrepassFragments(GL_FRAGMENT_SHADER_INVOCATIONS_ARB), m_ShadingFragments(GL_FRAGMENT_SHADER_INVOCATIONS_ARB),
+	m_ReportFrames(0), m_CullTotals({ 0, 0, 0.0 }), m_StateIssued(GLStateCache::GetIssuedCount()), m_StateSkipped(GLStateCache::GetSkippedCount()),
+	m_Angle(0.0f), m_Red(0.0f), m_RedIncrement(0.05f),
+	m_View(Mat4::Identity()), m_Projection(Mat4::Identity()), m_ViewProjection(Mat4::Identity()),
+	m_KeysWereDown{ false, false, false, false, false, false, false, false }, m_MouseWasDown(false)
+{
+	m_PanelArray.AddBuffer(m_PanelBuffer, GetPanelLayout());
+	m_PanelArray.UnBind();
+
+	/* The scene shader is pooled, pool objects move when others are created or destroyed so only the handle is kept */
+	m_SceneShader = m_Resources.Shaders.Create("res/shaders/GBuffer.shader");
+	m_Resources.Shaders.Get(m_SceneShader)->EnableHotReload();
+
+	SceneNodeID grid = m_SceneGraph.CreateNode(SCENE_NODE_NONE);
+	for (int y = 0; y < GRID_SIZE; y++)
+	{
+		for (int x = 0; x < GRID_SIZE; x++)
+		{
+			Vec3 position = { (x - GRID_SIZE / 2) * SPACING, (y - GRID_SIZE / 2) * SPACING, 0.0f };
+			float shade = (float)y / GRID_SIZE;
+			SceneNodeID node = m_SceneGraph.CreateNode(grid, position, Quat::Identity(), { ITEM_SCALE, ITEM_SCALE, 1.0f });
+			Entity entity = m_Registry.CreateEntity(
+				TransformComponent{ Mat4::Translation(position) * Mat4::Scale({ ITEM_SCALE, ITEM_SCALE, 1.0f }) },
+				SceneNodeComponent{ node },
+				BoundsComponent{ { position, ITEM_SCALE * 0.7072f } },
+				MeshComponent{ m_DiscMesh.GetVertexArray(), m_DiscMesh.GetLod(0), m_DiscMesh.GetDepthVertexArray() },
+				MaterialComponent{ m_SceneShader, { 0.2f, shade, 0.8f, 1.0f } },
+				LodComponent{ &m_DiscMesh, 0 });
+			Vec3 extent = { ITEM_SCALE * 0.7072f, ITEM_SCALE * 0.7072f, 0.0f };
+			m_PickTree.Insert({ position - extent, position + extent }, (unsigned int)m_Pickables.size());
+			m_Pickables.push_back(entity);
+		}
+	}
+	std::cout << "[Mesh] disc LODs, triangles (error):";
+	for (unsigned int lod = 0; lod < m_DiscMesh.GetLodCount(); lod++)
+		std::cout << " " << m_DiscMesh.GetTriangleCount(lod) << " (" << m_DiscMesh.GetLodError(lod) << ")";
+	std::cout << std::endl;
+
+	CreateClutter();
+
+	m_Deferred.SetShadows(&m_Shadows);
+	m_Deferred.SetSunColor(0.8f, 0.75f, 0.7f);
+
+	/* 100k transparent quads floating over the discs, submitted unsorted */
+	std::vector<TransparentQuad> quads(100000);
+	for (unsigned int i = 0; i < quads.size(); i++)
+	{
+		float u = i * 0.618034f, v = i * 0.754878f, w = i * 0.569840f;
+		quads[i] = { { (u - floorf(u) - 0.5f) * 7.0f, (v - floorf(v) - 0.5f) * 3.5f, 0.05f + 0.85f * (w - floorf(w)) },
+			0.01f + 0.03f * (i % 5) / 4.0f,
+			{ 0.5f + 0.5f * cosf(i * 0.7f), 0.5f + 0.5f * cosf(i * 0.7f + 2.1f), 0.5f + 0.5f * cosf(i * 0.7f + 4.2f), 0.2f + 0.1f * (i % 5) } };
+	}
+	m_Transparency.SetQuads(quads.data(), (unsigned int)quads.size());
+
+	SetSettings(m_Settings);
+	SetReportInterval(m_ReportInterval);
+	if (!PipelineStatisticsQuery::IsSupported())
+		std::cout << "[DepthPrepass] GL_ARB_pipeline_statistics_query is not supported, fragment counts are unavailable" << std::endl;
+}
+
+void Demo::CreateClutter()
+{
+	/* One regular polygon per side count, each instance picks one */
+	for (unsigned int sides = CLUTTER_MIN_SIDES; sides <= CLUTTER_MAX_SIDES; sides++)
+	{
+		std::vector<float> vertices = { 0.0f, 0.0f, 0.0f };
+		std::vector<unsigned int> indices;
+		for (unsigned int i = 0; i < sides; i++)
+		{
+			float angle = i * 6.2831853f / sides;
+			vertices.insert(vertices.end(), { 0.5f * cosf(angle), 0.5f * sinf(angle), 0.0f });
+			indices.insert(indices.end(), { 0, 1 + i, 1 + (i + 1) % sides });
+		}
+		m_ClutterShapes.push_back(m_ClutterPool.Add(vertices.data(), sides + 1, indices.data(), (unsigned int)indices.size()));
+	}
+
+	/* Scattered just behind the discs over a wider area than the grid, so the sides are culled even zoomed out */
+	std::vector<Mat4> transforms(CLUTTER_COUNT);
+	std::vector<GpuCullInstance> instances(CLUTTER_COUNT);
+	for (unsigned int i = 0; i < CLUTTER_COUNT; i++)
+	{
+		float u = i * 0.618034f, v = i * 0.754878f;
+		Vec3 position = { (u - floorf(u) - 0.5f) * GRID_SIZE * SPACING * 1.5f, (v - floorf(v) - 0.5f) * GRID_SIZE * SPACING, -0.1f };
+		float scale = 0.03f + 0.03f * (i % 4) / 3.0f;
+		Quat rotation = Quat::FromAxisAngle({ 0.0f, 0.0f, 1.0f }, i * 0.9f);
+		transforms[i] = Mat4::FromTRS(position, rotation, { scale, scale, 1.0f });
+		instances[i] = { { position.x, position.y, position.z }, 0.5f * scale, i % (unsigned int)m_ClutterShapes.size(), { 0, 0, 0 } };
+	}
+
+	m_ClutterTransforms.reset(new ShaderStorageBuffer(transforms.data(), (unsigned int)(transforms.size() * sizeof(Mat4))));
+	m_ClutterCuller.reset(new GpuCuller(m_ClutterPool, m_ClutterShapes, instances));
+}
+
+void Demo::Run()
+{
+	while (!glfwWindowShouldClose(m_Window))
+		Frame();
+}
+
+void Demo::Frame()
+{
+	/* Wait for a free frame slot, then sample input as late as possible */
+	m_Pacer.BeginFrame();
+	glfwPollEvents();
+	m_Pacer.MarkInput();
+	m_DynamicResolution.BeginFrame();
+
+	HandleInput();
+	Update();
+	Render(m_DynamicResolution.GetRenderSize(m_Width), m_DynamicResolution.GetRenderSize(m_Height));
+	Report();
+
+	m_DynamicResolution.EndFrame();
+	m_Pacer.Present(m_Window);
+	GLStats::EndFrame();
+	DeletionQueue::EndFrame();
+}
+
+void Demo::SetSettings(const DemoSettings& settings)
+{
+	if (settings.DepthPrepass != m_Settings.DepthPrepass)
+	{
+		/* Counts of the other mode would skew the averages */
+		m_PrepassFragments.ResetTotals();
+		m_ShadingFragments.ResetTotals();
+		m_ReportFrames = 0;
+		m_StateIssued = GLStateCache::GetIssuedCount();
+		m_StateSkipped = GLStateCache::GetSkippedCount();
+	}
+
+	m_Settings = settings;
+	m_Settings.LightCount = m_Settings.LightCount < MAX_POINT_LIGHTS ? m_Settings.LightCount : MAX_POINT_LIGHTS;
+	m_Pacer.SetMode(m_Settings.VSync ? FramePacingMode::VSYNC : FramePacingMode::UNCAPPED);
+	m_Shadows.SetCaching(m_Settings.ShadowCaching);
+	m_DynamicResolution.SetSettings(m_Settings.Resolution);
+	m_DynamicResolution.SetLogging(m_Settings.ResolutionLogging);
+	if (m_Settings.Transparency != DemoTransparency::OFF)
+		m_Transparency.SetMode(m_Settings.Transparency == DemoTransparency::SORTED ? TransparencyMode::SORTED : TransparencyMode::WEIGHTED_BLENDED);
+}
+
+void Demo::SetReportInterval(unsigned int frames)
+{
+	m_ReportInterval = frames;
+	m_Shadows.SetReportInterval(frames);
+	m_Post.SetReportInterval(frames);
+	m_Transparency.SetReportInterval(frames);
+	m_Pacer.SetReportInterval(frames);
+	m_Clustered.SetReportInterval(frames);
+}
+
+void Demo::HandleInput()
+{
+	const int keys[8] = { GLFW_KEY_F, GLFW_KEY_UP, GLFW_KEY_DOWN, GLFW_KEY_U, GLFW_KEY_C, GLFW_KEY_R, GLFW_KEY_T, GLFW_KEY_P };
+	DemoSettings settings = m_Settings;
+	bool changed = false;
+	for (int key = 0; key < 8; key++)
+	{
+		bool keyDown = glfwGetKey(m_Window, keys[key]) == GLFW_PRESS;
+		if (keyDown && !m_KeysWereDown[key])
+		{
+			if (key == 0)
+				settings.Lighting = (LightingPath)(((int)settings.Lighting + 1) % 3);
+			else if (key == 1 && settings.LightCount < MAX_POINT_LIGHTS)
+				settings.LightCount *= 2;
+			else if (key == 2 && settings.LightCount > 1)
+				settings.LightCount /= 2;
+			else if (key == 3)
+				settings.VSync = !settings.VSync;
+			else if (key == 4)
+				settings.ShadowCaching = !settings.ShadowCaching;
+			else if (key == 5)
+				settings.ResolutionLogging = !settings.ResolutionLogging;
+			else if (key == 6)
+				settings.Transparency = (DemoTransparency)(((int)settings.Transparency + 1) % 3);
+			else if (key == 7)
+				settings.DepthPrepass = !settings.DepthPrepass;
+			changed = true;
+		}
+		m_KeysWereDown[key] = keyDown;
+	}
+	if (changed)
+	{
+		SetSettings(settings);
+		PrintSettings();
+	}
+
+	/* Clicking a disc toggles its highlight */
+	bool mouseDown = glfwGetMouseButton(m_Window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+	if (mouseDown && !m_MouseWasDown)
+		Pick();
+	m_MouseWasDown = mouseDown;
+}
+
+void Demo::Pick()
+{
+	/* The cursor ray is tested against the tree, it uses last frame's camera which is what was on screen */
+	double cursorX, cursorY;
+	glfwGetCursorPos(m_Window, &cursorX, &cursorY);
+	float ndcX = (float)(cursorX / m_Width) * 2.0f - 1.0f;
+	float ndcY = 1.0f - (float)(cursorY / m_Height) * 2.0f;
+	Mat4 inverseViewProjection = Inverse(m_ViewProjection);
+	Vec3 rayStart = inverseViewProjection.TransformPoint({ ndcX, ndcY, -1.0f });
+	Vec3 rayEnd = inverseViewProjection.TransformPoint({ ndcX, ndcY, 1.0f });
+	Vec3 direction = Normalize(rayEnd - rayStart);
+
+	unsigned int picked;
+	float distance;
+	bool hit = m_PickTree.RayCast(rayStart, direction, 10.0f, [&](unsigned int index, float maxDistance)
+	{
+		/* Exact test against the bounding sphere */
+		const Sphere& sphere = m_Registry.GetComponent<BoundsComponent>(m_Pickables[index])->WorldBounds;
+		Vec3 offset = rayStart - sphere.Center;
+		float b = Dot(offset, direction);
+		float c = Dot(offset, offset) - sphere.Radius * sphere.Radius;
+		float discriminant = b * b - c;
+		if (discriminant < 0.0f)
+			return -1.0f;
+		float t = -b - sqrtf(discriminant);
+		return t <= maxDistance ? fmaxf(t, 0.0f) : -1.0f;
+	}, picked, distance);
+	if (hit)
+	{
+		MaterialComponent* material = m_Registry.GetComponent<MaterialComponent>(m_Pickables[picked]);
+		material->Color[2] = material->Color[2] > 0.0f ? 0.0f : 0.8f;
+	}
+}
+
+void Demo::Update()
+{
+	/* Pick up edits to the shader file */
+	m_Resources.Shaders.Get(m_SceneShader)->PollHotReload();
+
+	/* Spin the discs in the scene graph, then copy the world matrices out */
+	Quat spin = Quat::FromAxisAngle({ 0.0f, 0.0f, 1.0f }, m_Angle);
+	m_Registry.Each<SceneNodeComponent>([&](SceneNodeComponent& node)
+	{
+		m_SceneGraph.SetRotation(node.Node, spin);
+	});
+	m_SceneGraph.Update(&ThreadPool::Get());
+	float red = m_Red;
+	m_Registry.Each<TransformComponent, SceneNodeComponent, MaterialComponent>(
+		[&](TransformComponent& transform, SceneNodeComponent& node, MaterialComponent& material)
+	{
+		transform.World = m_SceneGraph.GetWorldMatrix(node.Node);
+		material.Color[0] = red;
+	});
+
+	/* Aspect-correct projection, the camera pans and zooms over the grid and level of detail follows the zoom */
+	float aspect = (float)m_Width / m_Height;
+	float zoom = m_Settings.Zoom > 0.0f ? m_Settings.Zoom : 1.0f + 0.75f * sinf(m_Angle * 0.3f);
+	m_Projection = Mat4::Orthographic(-aspect * zoom, aspect * zoom, -zoom, zoom, -1.0f, 1.0f);
+	m_LodSelector.SetOrthographic(2.0f * zoom, (float)m_Height);
+	m_Registry.Each<LodComponent, MeshComponent>([&](LodComponent& lod, MeshComponent& mesh)
+	{
+		lod.Lod = m_LodSelector.Select(*lod.LodMesh, ITEM_SCALE, 0.0f, lod.Lod);
+		mesh.IBuffer = lod.LodMesh->GetLod(lod.Lod);
+	});
+
+	/* Gather bounds and cull against the panning camera */
+	m_View = Mat4::Translation({ sinf(m_Angle * 0.5f) * 1.5f, 0.0f, 0.0f });
+	m_ViewProjection = m_Projection * m_View;
+	m_Culler.Clear();
+	m_DrawItems.clear();
+	m_DrawBounds.clear();
+	m_Registry.Each<TransformComponent, BoundsComponent, MeshComponent, MaterialComponent, LodComponent>(
+		[&](TransformComponent& transform, BoundsComponent& bounds, MeshComponent& mesh, MaterialComponent& material, LodComponent& lod)
+	{
+		m_Culler.Add(bounds.WorldBounds);
+		m_DrawItems.push_back({ &transform, &mesh, &material, &lod });
+		Vec3 extent = { bounds.WorldBounds.Radius, bounds.WorldBounds.Radius, bounds.WorldBounds.Radius };
+		m_DrawBounds.push_back({ bounds.WorldBounds.Center - extent, bounds.WorldBounds.Center + extent });
+	});
+	m_Culler.Cull(Frustum::FromMatrix(m_ViewProjection), m_Visible, &ThreadPool::Get());
+	const FrustumCullStats& cullStats = m_Culler.GetLastStats();
+	m_CullTotals.Tested += cullStats.Tested;
+	m_CullTotals.Visible += cullStats.Visible;
+	m_CullTotals.Milliseconds += cullStats.Milliseconds;
+
+	/* The clutter against the same frustum in a compute pass, its counts never come back to the CPU */
+	float planes[6][4];
+	GpuCuller::ExtractPlanes(m_ViewProjection.m, planes);
+	m_ClutterCuller->Cull(planes);
+
+	/* Drop whatever the panel hides before submission */
+	m_Occlusion.BeginFrame(m_ViewProjection);
+	m_Occlusion.AddOccluder(m_PanelWorld, s_PanelPositions, 3, s_PanelIndices, 6);
+	m_Occlusion.Rasterize(&ThreadPool::Get());
+	m_Occlusion.Cull(m_DrawBounds.data(), m_Visible, &ThreadPool::Get());
+	m_VisibleTriangles = 0;
+	for (unsigned int index : m_Visible)
+		m_VisibleTriangles += m_DrawItems[index].Lod->LodMesh->GetTriangleCount(m_DrawItems[index].Lod->Lod);
+
+	/* Lights orbit scattered points above the discs */
+	m_Lights.resize(m_Settings.LightCount);
+	for (unsigned int i = 0; i < m_Settings.LightCount; i++)
+	{
+		float seed = i * 0.618034f;
+		float baseX = (seed - floorf(seed) - 0.5f) * GRID_SIZE * SPACING;
+		float baseY = (i * 0.754878f - floorf(i * 0.754878f) - 0.5f) * GRID_SIZE * SPACING;
+		float orbit = m_Angle * (0.5f + (i % 7) * 0.1f) + i;
+		m_Lights[i] = { { baseX + 0.2f * cosf(orbit), baseY + 0.2f * sinf(orbit), 0.15f }, 0.4f,
+			{ 0.5f + 0.5f * cosf(i * 1.3f), 0.5f + 0.5f * cosf(i * 1.3f + 2.1f), 0.5f + 0.5f * cosf(i * 1.3f + 4.2f) }, 1.5f };
+	}
+	if (m_Settings.Lighting == LightingPath::CLUSTERED)
+		m_Clustered.SetLights(m_Lights.data(), m_Settings.LightCount);
+	else
+		m_Deferred.SetLights(m_Lights.data(), m_Settings.LightCount);
+
+	/* Animate the color */
+	if (m_Red > 1.0 || m_Red < 0.0)
+		m_RedIncrement = -m_RedIncrement;
+	m_Red += m_RedIncrement;
+	m_Angle += 0.01f;
+}
+
+void Demo::DrawScene(Shader* overrideShader, Shader& instancedShader)
+{
+	/* Draw submission over the visible entities only */
+	for (unsigned int index : m_Visible)
+	{
+		const DrawItem& item = m_DrawItems[index];
+		Mat4 mvp = m_ViewProjection * item.Transform->World;
+		Shader& itemShader = overrideShader ? *overrideShader : *m_Resources.Shaders.Get(item.Material->MaterialShader);
+		itemShader.Bind();
+		itemShader.SetUniform4f("u_Color", item.Material->Color[0], item.Material->Color[1], item.Material->Color[2], item.Material->Color[3]);
+		itemShader.SetUniform2f("u_Material", 0.4f, 0.0f);
+		itemShader.SetUniformMat4f("u_MVP", mvp.m);
+		itemShader.SetUniformMat4f("u_Model", item.Transform->World.m);
+		m_Renderer.Draw(*m_Resources.VertexArrays.Get(item.Mesh->VArray), *m_Resources.IndexBuffers.Get(item.Mesh->IBuffer), itemShader);
+	}
+
+	/* Whatever survived the compute pass, one indirect draw per shape */
+	instancedShader.Bind();
+	instancedShader.SetUniform4f("u_Color", 0.7f, 0.5f, 0.3f, 1.0f);
+	instancedShader.SetUniform2f("u_Material", 0.6f, 0.0f);
+	instancedShader.SetUniformMat4f("u_ViewProjection", m_ViewProjection.m);
+	m_ClutterTransforms->BindBase(GPU_CULL_TRANSFORMS_BINDING);
+	m_ClutterCuller->Draw(instancedShader);
+
+	Shader& panelShader = overrideShader ? *overrideShader : *m_Resources.Shaders.Get(m_SceneShader);
+	panelShader.Bind();
+	panelShader.SetUniform4f("u_Color", 0.1f, 0.1f, 0.1f, 1.0f);
+	panelShader.SetUniform2f("u_Material", 0.2f, 1.0f);
+	panelShader.SetUniformMat4f("u_MVP", (m_ViewProjection * m_PanelWorld).m);
+	panelShader.SetUniformMat4f("u_Model", m_PanelWorld.m);
+	m_Renderer.Draw(m_PanelArray, m_PanelIndices, panelShader);
+}
+
+void Demo::DrawDepth(Shader& depthShader, const Mat4& viewProjection, bool visibleOnly)
+{
+	/* Position-only streams, the shadow casters are every disc, the prepass only draws the visible ones */
+	depthShader.Bind();
+	for (unsigned int i = 0; i < (visibleOnly ? m_Visible.size() : m_DrawItems.size()); i++)
+	{
+		const DrawItem& item = m_DrawItems[visibleOnly ? m_Visible[i] : i];
+		depthShader.SetUniformMat4f("u_MVP", (viewProjection * item.Transform->World).m);
+		m_Renderer.Draw(*m_Resources.VertexArrays.Get(item.Mesh->DepthVArray), *m_Resources.IndexBuffers.Get(item.Mesh->IBuffer), depthShader);
+	}
+	depthShader.SetUniformMat4f("u_MVP", (viewProjection * m_PanelWorld).m);
+	m_Renderer.Draw(m_PanelArray, m_PanelIndices, depthShader);
+
+	/* The clutter only sits under the discs, leaving it out of the shadow maps changes nothing */
+	if (visibleOnly)
+	{
+		Shader& instancedShader = m_PrepassVariants.Get(SCENE_GPU_INSTANCES);
+		instancedShader.Bind();
+		instancedShader.SetUniformMat4f("u_ViewProjection", viewProjection.m);
+		m_ClutterTransforms->BindBase(GPU_CULL_TRANSFORMS_BINDING);
+		m_ClutterCuller->Draw(instancedShader);
+	}
+}
+
+void Demo::Render(unsigned int width, unsigned int height)
+{
+	/* Record the frame, the scene passes only run because the post pass reads their output */
+	m_FrameGraph.Reset();
+	RenderGraphResource backbuffer = m_FrameGraph.ImportBackbuffer(m_Width, m_Height);
+
+	/* Every disc and the panel are static casters: they spin in place at most, which leaves their shadows unchanged */
+	m_Shadows.Update(m_View, m_Projection, -1.0f, 1.0f);
+	m_FrameGraph.AddPass("ShadowCascades", [&](RenderGraphBuilder& builder)
+	{
+		builder.SetSideEffect();
+	}, [this](RenderGraph&)
+	{
+		m_Shadows.Render([this](Shader& depthShader, const Mat4& lightViewProjection)
+		{
+			DrawDepth(depthShader, lightViewProjection, false);
+		}, ShadowCasterDraw());
+	});
+
+	RenderGraphResource sceneColor;
+	RenderGraphResource sceneDepth = RENDER_GRAPH_NONE;
+	if (m_Settings.Lighting != LightingPath::DEFERRED)
+	{
+		/* The forward paths lay down depth from the position-only streams first and shade at GL_EQUAL */
+		bool clustered = m_Settings.Lighting == LightingPath::CLUSTERED;
+		bool depthPrepass = m_Settings.DepthPrepass;
+		Shader& sceneShader = clustered ? m_ClusteredShader : m_ForwardShader;
+		Shader& instancedShader = (clustered ? m_ClusteredVariants : m_ForwardVariants).Get(SCENE_GPU_INSTANCES);
+		if (depthPrepass)
+		{
+			m_FrameGraph.AddPass("DepthPrepass", [&](RenderGraphBuilder& builder)
+			{
+				sceneDepth = builder.CreateTexture("SceneDepth", { width, height, GL_DEPTH_COMPONENT24 });
+			}, [this](RenderGraph&)
+			{
+				m_Renderer.SetDepthState({ true, true, GL_LESS });
+				m_Renderer.ClearDepth();
+				m_PrepassFragments.Begin();
+				DrawDepth(m_PrepassShader, m_ViewProjection, true);
+				m_PrepassFragments.End();
+			});
+		}
+		m_FrameGraph.AddPass(clustered ? "ClusteredScene" : "ForwardScene", [&](RenderGraphBuilder& builder)
+		{
+			sceneColor = builder.CreateTexture("SceneColor", { width, height, GL_RGBA16F });
+			if (depthPrepass)
+				builder.ReadDepth(sceneDepth);
+			else
+				sceneDepth = builder.CreateTexture("SceneDepth", { width, height, GL_DEPTH_COMPONENT24 });
+		}, [this, clustered, depthPrepass, &sceneShader, &instancedShader, width, height](RenderGraph&)
+		{
+			if (clustered)
+			{
+				/* Bin the lights, the orthographic depth range is sliced linearly */
+				m_Clustered.SetProjection(m_Projection, -1.0f, 1.0f, false);
+				m_Clustered.Update(m_View);
+			}
+			else
+			{
+				m_Deferred.GetLightBuffer().BindBase(POINT_LIGHTS_BINDING);
+			}
+			/* After a prepass only the nearest fragment of each pixel passes, and depth is already final */
+			m_Renderer.Clear();
+			if (depthPrepass)
+			{
+				m_Renderer.SetDepthState({ true, false, GL_EQUAL });
+			}
+			else
+			{
+				m_Renderer.SetDepthState({ true, true, GL_LESS });
+				m_Renderer.ClearDepth();
+			}
+			/* Both variants shade the same way, only where their transforms come from differs */
+			const float* ambient = m_Deferred.GetAmbient();
+			const float* sunColor = m_Deferred.GetSunColor();
+			Mat4 inverseViewProjection = Inverse(m_ViewProjection);
+			for (Shader* shader : { &sceneShader, &instancedShader })
+			{
+				if (clustered)
+				{
+					m_Clustered.Bind(*shader, width, height);
+					shader->SetUniformMat4f("u_View", m_View.m);
+				}
+				else
+				{
+					shader->Bind();
+					shader->SetUniform1ui("u_LightCount", m_Deferred.GetLightCount());
+				}
+				m_Shadows.Bind(*shader, 0);
+				shader->SetUniform3f("u_Ambient", ambient[0], ambient[1], ambient[2]);
+				shader->SetUniform3f("u_SunColor", sunColor[0], sunColor[1], sunColor[2]);
+				shader->SetUniformMat4f("u_InverseViewProjection", inverseViewProjection.m);
+				shader->SetUniform2f("u_InverseSize", 1.0f / width, 1.0f / height);
+			}
+			m_ShadingFragments.Begin();
+			DrawScene(&sceneShader, instancedShader);
+			m_ShadingFragments.End();
+		});
+	}
+	else
+	{
+		GBufferTargets gBuffer = m_Deferred.AddGeometryPass(m_FrameGraph, width, height, [this]() { DrawScene(nullptr, m_GBufferVariants.Get(SCENE_GPU_INSTANCES)); });
+		sceneColor = m_Deferred.AddLightingPass(m_FrameGraph, gBuffer, m_ViewProjection);
+		sceneDepth = gBuffer.Depth;
+	}
+	if (m_Settings.Transparency != DemoTransparency::OFF)
+		sceneColor = m_Transparency.AddPass(m_FrameGraph, sceneColor, sceneDepth, m_View, m_ViewProjection);
+	m_Post.AddPass(m_FrameGraph, sceneColor, backbuffer);
+	m_FrameGraph.Execute();
+}
+
+void Demo::Report()
+{
+	m_PrepassFragments.Poll();
+	m_ShadingFragments.Poll();
+	if (m_ReportInterval == 0 || ++m_ReportFrames < m_ReportInterval)
+		return;
+
+	if (m_ShadingFragments.GetSampleCount() > 0)
+	{
+		std::cout << "[DepthPrepass] " << (m_Settings.DepthPrepass ? "on" : "off") << ", fragment shader invocations per frame: shading "
+			<< m_ShadingFragments.GetTotal() / m_ShadingFragments.GetSampleCount();
+		if (m_PrepassFragments.GetSampleCount() > 0)
+			std::cout << ", prepass " << m_PrepassFragments.GetTotal() / m_PrepassFragments.GetSampleCount();
+		std::cout << std::endl;
+	}
+	m_PrepassFragments.ResetTotals();
+	m_ShadingFragments.ResetTotals();
+
+	std::cout << "[FrustumCull] per frame: " << m_CullTotals.Tested / m_ReportFrames << " tested, " << m_CullTotals.Visible / m_ReportFrames
+		<< " visible in " << m_CullTotals.Milliseconds / m_ReportFrames << " ms, " << m_CullTotals.GetCulledPerMillisecond() << " culled per ms" << std::endl;
+	m_CullTotals = { 0, 0, 0.0 };
+
+	/* State changes the cache sent to GL against the ones it dropped as redundant */
+	std::cout << "[StateCache] per frame: " << (GLStateCache::GetIssuedCount() - m_StateIssued) / m_ReportFrames << " state changes issued, "
+		<< (GLStateCache::GetSkippedCount() - m_StateSkipped) / m_ReportFrames << " skipped" << std::endl;
+	m_StateIssued = GLStateCache::GetIssuedCount();
+	m_StateSkipped = GLStateCache::GetSkippedCount();
+	m_ReportFrames = 0;
+}
+
+void Demo::PrintSettings() const
+{
+	std::cout << "[Lighting] " << s_LightingPathNames[(int)m_Settings.Lighting] << ", " << m_Settings.LightCount << " lights, "
+		<< (m_Settings.VSync ? "V-Sync" : "uncapped") << ", shadow caching " << (m_Settings.ShadowCaching ? "on" : "off")
+		<< ", resolution logging " << (m_Settings.ResolutionLogging ? "on" : "off") << ", transparency "
+		<< s_TransparencyNames[(int)m_Settings.Transparency] << ", depth prepass " << (m_Settings.DepthPrepass ? "on" : "off") << std::endl;
+}
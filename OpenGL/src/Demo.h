@@ -0,0 +1,191 @@
+#pragma once
+
+#include "Renderer.h"
+#include "RenderResources.h"
+#include "VectorMath.h"
+#include "EntityRegistry.h"
+#include "GeometryPool.h"
+#include "GpuCuller.h"
+#include "ShaderVariantCache.h"
+#include "SceneGraph.h"
+#include "Components.h"
+#include "FrustumCuller.h"
+#include "AABBTree.h"
+#include "OcclusionCuller.h"
+#include "Mesh.h"
+#include "LodSelector.h"
+#include "FramePacer.h"
+#include "RenderGraph.h"
+#include "DeferredRenderer.h"
+#include "ClusteredLighting.h"
+#include "CascadedShadowMap.h"
+#include "PostProcessChain.h"
+#include "DynamicResolution.h"
+#include "TransparencyRenderer.h"
+#include "PipelineStatisticsQuery.h"
+
+#include<vector>
+#include<memory>
+
+struct GLFWwindow;
+
+enum class LightingPath
+{
+	DEFERRED = 0, CLUSTERED = 1, FORWARD = 2
+};
+
+enum class DemoTransparency
+{
+	OFF = 0, WEIGHTED_BLENDED = 1, SORTED = 2
+};
+
+// Everything the hot keys switch, benchmarks set it directly
+struct DemoSettings
+{
+	LightingPath Lighting;
+	unsigned int LightCount;
+	bool VSync;
+	bool ShadowCaching;
+	DynamicResolutionSettings Resolution;
+	bool ResolutionLogging;
+	DemoTransparency Transparency;
+	// Forward paths only
+	bool DepthPrepass;
+	// Fixed camera zoom, 0 keeps it animated
+	float Zoom;
+
+	static DemoSettings Default();
+};
+
+// The sample scene: a grid of spinning discs with a LOD chain behind an occluding panel, GPU culled clutter
+// under them, point lights drifting over them, a shadow casting sun and 100k transparent quads on top. The scene renders offscreen through the
+// frame graph at a dynamic resolution, the post chain writes the window.
+class Demo
+{
+private:
+	struct DrawItem
+	{
+		const TransformComponent* Transform;
+		const MeshComponent* Mesh;
+		const MaterialComponent* Material;
+		const LodComponent* Lod;
+	};
+
+	GLFWwindow* m_Window;
+	unsigned int m_Width;
+	unsigned int m_Height;
+	DemoSettings m_Settings;
+	unsigned int m_ReportInterval;
+
+	// Pooled GL objects, entities refer to them by handle
+	RenderResources m_Resources;
+	ShaderHandle m_SceneShader;
+	Renderer m_Renderer;
+
+	// A panel in front of the grid hides the discs behind it and occludes on the CPU
+	VertexArray m_PanelArray;
+	VertexBuffer m_PanelBuffer;
+	IndexBuffer m_PanelIndices;
+	Mat4 m_PanelWorld;
+
+	// Small polygons scattered behind the discs, their shapes share one geometry pool. They are frustum culled
+	// on the GPU and drawn with one indirect draw per shape, their transforms stay in a storage buffer.
+	GeometryPool m_ClutterPool;
+	std::vector<GeometryHandle> m_ClutterShapes;
+	std::unique_ptr<ShaderStorageBuffer> m_ClutterTransforms;
+	std::unique_ptr<GpuCuller> m_ClutterCuller;
+
+	// Renderable discs live in the entity registry, their bounds go into the tree once for picking.
+	// The scene graph places them, each disc is a child of the grid node.
+	Mesh m_DiscMesh;
+	LodSelector m_LodSelector;
+	SceneGraph m_SceneGraph;
+	EntityRegistry m_Registry;
+	AABBTree m_PickTree;
+	std::vector<Entity> m_Pickables;
+
+	// Culling state, reused every frame
+	FrustumCuller m_Culler;
+	OcclusionCuller m_Occlusion;
+	std::vector<unsigned int> m_Visible;
+	std::vector<DrawItem> m_DrawItems;
+	std::vector<AABB> m_DrawBounds;
+	unsigned int m_VisibleTriangles;
+
+	DeferredRenderer m_Deferred;
+	ClusteredLighting m_Clustered;
+	// Scene shaders of the forward paths and the G-buffer, the GPU_INSTANCES variants draw the clutter
+	ShaderVariantCache m_ForwardVariants;
+	ShaderVariantCache m_ClusteredVariants;
+	ShaderVariantCache m_PrepassVariants;
+	ShaderVariantCache m_GBufferVariants;
+	Shader& m_ForwardShader;
+	Shader& m_ClusteredShader;
+	Shader& m_PrepassShader;
+	std::vector<PointLight> m_Lights;
+	CascadedShadowMap m_Shadows;
+	TransparencyRenderer m_Transparency;
+	RenderGraph m_FrameGraph;
+	PostProcessChain m_Post;
+	DynamicResolution m_DynamicResolution;
+	FramePacer m_Pacer;
+
+	// Fragment shader invocations of the forward passes, with and without the depth prepass
+	PipelineStatisticsQuery m_PrepassFragments;
+	PipelineStatisticsQuery m_ShadingFragments;
+	unsigned int m_ReportFrames;
+	// Frustum culling summed over the report interval
+	FrustumCullStats m_CullTotals;
+	unsigned long long m_StateIssued;
+	unsigned long long m_StateSkipped;
+
+	// Animation and camera of the current frame
+	float m_Angle;
+	float m_Red;
+	float m_RedIncrement;
+	Mat4 m_View;
+	Mat4 m_Projection;
+	Mat4 m_ViewProjection;
+
+	bool m_KeysWereDown[8];
+	bool m_MouseWasDown;
+
+public:
+	Demo(GLFWwindow* window, unsigned int width, unsigned int height);
+	Demo(const Demo&) = delete;
+	Demo& operator=(const Demo&) = delete;
+
+	// Frames until the window closes. F cycles the lighting path, the arrow keys double or halve the light count,
+	// U toggles V-Sync, C shadow caching, R resolution logging, T the transparency mode and P the depth prepass.
+	// Clicking a disc toggles its highlight.
+	void Run();
+	// Input, update, rendering and present of one frame
+	void Frame();
+
+	void SetSettings(const DemoSettings& settings);
+	inline const DemoSettings& GetSettings() const { return m_Settings; }
+	// Reports of the demo and its systems every 'frames' frames, 0 disables them
+	void SetReportInterval(unsigned int frames);
+
+	// The transparent quads, benchmarks read the timings of the current mode
+	inline TransparencyRenderer& GetTransparency() { return m_Transparency; }
+	// Disc triangles that survived culling in the last frame, at their selected LOD
+	inline unsigned int GetVisibleTriangles() const { return m_VisibleTriangles; }
+
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+
+private:
+	void HandleInput();
+	void Pick();
+	void Update();
+	void CreateClutter();
+	void Render(unsigned int width, unsigned int height);
+	// Draws the discs and the panel, with their own shaders or all with the given one, and the clutter
+	// with the instanced variant of that shader
+	void DrawScene(Shader* overrideShader, Shader& instancedShader);
+	// Only the prepass, which draws what is visible, includes the clutter: it was culled for the camera
+	void DrawDepth(Shader& depthShader, const Mat4& viewProjection, bool visibleOnly);
+	void Report();
+	void PrintSettings() const;
+};
@@ -0,0 +1,59 @@
+#include "DynamicResolution.h"
+
+#include<iostream>
+#include<iomanip>
+#include<cmath>
+
+#define DYNAMIC_RESOLUTION_STEP 0.0625f
+#define DYNAMIC_RESOLUTION_LATENCY 4
+
+DynamicResolution::DynamicResolution(const DynamicResolutionSettings& settings)
+	:m_Settings(settings), m_Timer(DYNAMIC_RESOLUTION_LATENCY), m_Scale(settings.MaxScale), m_FramesAtScale(0), m_Frame(0), m_Logging(false)
+{
+}
+
+void DynamicResolution::SetSettings(const DynamicResolutionSettings& settings)
+{
+	m_Settings = settings;
+	m_Scale = fminf(fmaxf(m_Scale, m_Settings.MinScale), m_Settings.MaxScale);
+	m_FramesAtScale = 0;
+}
+
+void DynamicResolution::BeginFrame()
+{
+	m_Timer.Begin();
+}
+
+void DynamicResolution::EndFrame()
+{
+	m_Timer.End();
+	m_Timer.Poll();
+	m_Frame++;
+	m_FramesAtScale++;
+
+	// Until then the latest measurement may still be of a frame rendered at the previous scale
+	double milliseconds = m_Timer.GetLastMilliseconds();
+	if (m_FramesAtScale > DYNAMIC_RESOLUTION_LATENCY && milliseconds > 0.0)
+	{
+		// The cost follows the pixel count, which grows with the square of the scale. Rounding down gives
+		// hysteresis: the scale drops as soon as the budget is exceeded but only rises once a whole step fits.
+		float ideal = m_Scale * sqrtf((float)(m_Settings.BudgetMilliseconds / milliseconds));
+		float next = floorf(ideal / DYNAMIC_RESOLUTION_STEP) * DYNAMIC_RESOLUTION_STEP;
+		next = fminf(fmaxf(next, m_Settings.MinScale), m_Settings.MaxScale);
+		if (next != m_Scale)
+		{
+			m_Scale = next;
+			m_FramesAtScale = 0;
+		}
+	}
+
+	if (m_Logging)
+		std::cout << "[DynamicResolution] frame " << m_Frame << ": " << std::fixed << std::setprecision(3) << milliseconds
+			<< " ms of " << m_Settings.BudgetMilliseconds << ", next scale " << m_Scale << std::defaultfloat << std::endl;
+}
+
+unsigned int DynamicResolution::GetRenderSize(unsigned int outputSize) const
+{
+	unsigned int size = (unsigned int)(outputSize * m_Scale + 0.5f);
+	return size > 0 ? size : 1;
+}
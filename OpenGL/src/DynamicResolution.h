@@ -0,0 +1,46 @@
+#pragma once
+
+#include "GpuTimer.h"
+
+struct DynamicResolutionSettings
+{
+	// Fractions of the output size along each axis
+	float MinScale;
+	float MaxScale;
+	// GPU time per frame the scale is steered towards
+	double BudgetMilliseconds;
+};
+
+// Picks the render resolution that keeps the GPU frame time within a budget. The time comes from a GpuTimer
+// around the whole frame and arrives a few frames late, so the scale only changes again once a frame rendered
+// at the current scale was measured. Scales are multiples of 1/16 so targets are not reallocated every frame.
+class DynamicResolution
+{
+private:
+	DynamicResolutionSettings m_Settings;
+	GpuTimer m_Timer;
+	float m_Scale;
+	unsigned int m_FramesAtScale;
+	unsigned long long m_Frame;
+	bool m_Logging;
+
+public:
+	DynamicResolution(const DynamicResolutionSettings& settings);
+
+	// Clamps the current scale into the new range
+	void SetSettings(const DynamicResolutionSettings& settings);
+	inline const DynamicResolutionSettings& GetSettings() const { return m_Settings; }
+	// Prints the measured time and the chosen scale every frame
+	inline void SetLogging(bool logging) { m_Logging = logging; }
+	inline bool IsLogging() const { return m_Logging; }
+
+	// Brackets all GPU work of a frame
+	void BeginFrame();
+	// Chooses the scale of the next frame
+	void EndFrame();
+
+	inline float GetScale() const { return m_Scale; }
+	// Render size for an output of the given size
+	unsigned int GetRenderSize(unsigned int outputSize) const;
+	inline double GetLastMilliseconds() const { return m_Timer.GetLastMilliseconds(); }
+};
@@ -0,0 +1,195 @@
+#include "EntityRegistry.h"
+#include "Renderer.h"
+
+#include<cstdlib>
+
+static std::vector<ComponentInfo>& GetComponentInfos()
+{
+	static std::vector<ComponentInfo> infos;
+	return infos;
+}
+
+unsigned int ComponentRegistry::Register(size_t size, size_t alignment)
+{
+	std::vector<ComponentInfo>& infos = GetComponentInfos();
+	ASSERT(infos.size() < MAX_COMPONENT_TYPES);
+	infos.push_back({ size, alignment });
+	return (unsigned int)infos.size() - 1;
+}
+
+const ComponentInfo& ComponentRegistry::GetInfo(unsigned int type)
+{
+	return GetComponentInfos()[type];
+}
+
+EntityRegistry::EntityRegistry()
+{
+	// Archetype 0 holds entities without components
+	GetOrCreateArchetype(0);
+}
+
+EntityRegistry::~EntityRegistry()
+{
+	for (Archetype& archetype : m_Archetypes)
+	{
+		for (EntityChunk& chunk : archetype.Chunks)
+			free(chunk.Data);
+	}
+}
+
+Entity EntityRegistry::CreateEntity()
+{
+	return CreateEntityWithMask(0);
+}
+
+Entity EntityRegistry::CreateEntityWithMask(ComponentMask mask)
+{
+	Entity entity;
+	if (!m_FreeIndices.empty())
+	{
+		entity.Index = m_FreeIndices.back();
+		m_FreeIndices.pop_back();
+	}
+	else
+	{
+		entity.Index = (unsigned int)m_Records.size();
+		m_Records.push_back({ 0, 0, 0, 0 });
+	}
+	entity.Generation = m_Records[entity.Index].Generation;
+
+	AllocateRow(GetOrCreateArchetype(mask), entity);
+	return entity;
+}
+
+void EntityRegistry::DestroyEntity(Entity entity)
+{
+	if (!IsAlive(entity))
+		return;
+
+	EntityRecord& record = m_Records[entity.Index];
+	FreeRow(record.Archetype, record.Chunk, record.Row);
+	record.Generation++;
+	m_FreeIndices.push_back(entity.Index);
+}
+
+bool EntityRegistry::IsAlive(Entity entity) const
+{
+	return entity.Index < m_Records.size() && m_Records[entity.Index].Generation == entity.Generation;
+}
+
+unsigned int EntityRegistry::GetOrCreateArchetype(ComponentMask mask)
+{
+	auto existing = m_ArchetypeOfMask.find(mask);
+	if (existing != m_ArchetypeOfMask.end())
+		return existing->second;
+
+	Archetype archetype;
+	archetype.Mask = mask;
+	size_t rowSize = sizeof(Entity);
+	for (unsigned int type = 0; type < MAX_COMPONENT_TYPES; type++)
+	{
+		archetype.Offsets[type] = 0;
+		if (mask & (1ull << type))
+		{
+			archetype.Types.push_back(type);
+			rowSize += ComponentRegistry::GetInfo(type).Size;
+		}
+	}
+
+	// Leave room for aligning every array inside the chunk
+	size_t padding = 16 * (archetype.Types.size() + 1);
+	archetype.Capacity = (unsigned int)((ENTITY_CHUNK_SIZE - padding) / rowSize);
+	ASSERT(archetype.Capacity > 0);
+
+	size_t offset = sizeof(Entity) * archetype.Capacity;
+	for (unsigned int type : archetype.Types)
+	{
+		const ComponentInfo& info = ComponentRegistry::GetInfo(type);
+		offset = (offset + info.Alignment - 1) / info.Alignment * info.Alignment;
+		archetype.Offsets[type] = offset;
+		offset += info.Size * archetype.Capacity;
+	}
+
+	m_Archetypes.push_back(std::move(archetype));
+	m_ArchetypeOfMask[mask] = (unsigned int)m_Archetypes.size() - 1;
+	return (unsigned int)m_Archetypes.size() - 1;
+}
+
+void EntityRegistry::AllocateRow(unsigned int archetypeIndex, Entity entity)
+{
+	Archetype& archetype = m_Archetypes[archetypeIndex];
+
+	// Rows are kept dense, only the last chunk can have free space
+	if (archetype.Chunks.empty() || archetype.Chunks.back().Count == archetype.Capacity)
+		archetype.Chunks.push_back({ (unsigned char*)malloc(ENTITY_CHUNK_SIZE), 0 });
+
+	EntityChunk& chunk = archetype.Chunks.back();
+	unsigned int row = chunk.Count++;
+	archetype.GetEntities(chunk)[row] = entity;
+
+	EntityRecord& record = m_Records[entity.Index];
+	record.Archetype = archetypeIndex;
+	record.Chunk = (unsigned int)archetype.Chunks.size() - 1;
+	record.Row = row;
+}
+
+void EntityRegistry::FreeRow(unsigned int archetypeIndex, unsigned int chunkIndex, unsigned int row)
+{
+	Archetype& archetype = m_Archetypes[archetypeIndex];
+	EntityChunk& chunk = archetype.Chunks[chunkIndex];
+	EntityChunk& last = archetype.Chunks.back();
+	unsigned int lastRow = last.Count - 1;
+
+	// Fill the hole with the very last row of the archetype
+	if (&chunk != &last || row != lastRow)
+	{
+		Entity moved = archetype.GetEntities(last)[lastRow];
+		archetype.GetEntities(chunk)[row] = moved;
+		for (unsigned int type : archetype.Types)
+		{
+			size_t size = ComponentRegistry::GetInfo(type).Size;
+			memcpy(archetype.GetComponents(chunk, type) + row * size, archetype.GetComponents(last, type) + lastRow * size, size);
+		}
+		m_Records[moved.Index].Chunk = chunkIndex;
+		m_Records[moved.Index].Row = row;
+	}
+
+	if (--last.Count == 0)
+	{
+		free(last.Data);
+		archetype.Chunks.pop_back();
+	}
+}
+
+void EntityRegistry::ChangeArchetype(Entity entity, ComponentMask mask)
+{
+	ASSERT(IsAlive(entity));
+	EntityRecord record = m_Records[entity.Index];
+	if (m_Archetypes[record.Archetype].Mask == mask)
+		return;
+
+	unsigned int target = GetOrCreateArchetype(mask);
+	AllocateRow(target, entity);
+
+	// Copy the components both archetypes share, then drop the old row
+	const Archetype& from = m_Archetypes[record.Archetype];
+	const Archetype& to = m_Archetypes[target];
+	const EntityRecord& moved = m_Records[entity.Index];
+	for (unsigned int type : from.Types)
+	{
+		if (!(to.Mask & (1ull << type)))
+			continue;
+		size_t size = ComponentRegistry::GetInfo(type).Size;
+		memcpy(to.GetComponents(to.Chunks[moved.Chunk], type) + moved.Row * size,
+			from.GetComponents(from.Chunks[record.Chunk], type) + record.Row * size, size);
+	}
+	FreeRow(record.Archetype, record.Chunk, record.Row);
+}
+
+void EntityRegistry::SetComponentData(Entity entity, unsigned int type, const void* data)
+{
+	const EntityRecord& record = m_Records[entity.Index];
+	const Archetype& archetype = m_Archetypes[record.Archetype];
+	size_t size = ComponentRegistry::GetInfo(type).Size;
+	memcpy(archetype.GetComponents(archetype.Chunks[record.Chunk], type) + record.Row * size, data, size);
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "ThreadPool.h"
+#include "Debug.h"
+
+#include<vector>
+#include<unordered_map>
+#include<type_traits>
+#include<cstring>
+
+#define MAX_COMPONENT_TYPES 64
+#define ENTITY_CHUNK_SIZE (16 * 1024)
+
+typedef unsigned long long ComponentMask;
+
+struct Entity
+{
+	unsigned int Index;
+	unsigned int Generation;
+
+	inline bool operator==(const Entity& other) const { return Index == other.Index && Generation == other.Generation; }
+};
+
+struct ComponentInfo
+{
+	size_t Size;
+	size_t Alignment;
+};
+
+// Assigns every component type a small id the first time it is used
+class ComponentRegistry
+{
+public:
+	static unsigned int Register(size_t size, size_t alignment);
+	static const ComponentInfo& GetInfo(unsigned int type);
+
+	template<typename T>
+	static unsigned int GetID()
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Components are moved between chunks with memcpy");
+		static_assert(alignof(T) <= 16, "Chunk storage is only 16 byte aligned");
+		static const unsigned int id = Register(sizeof(T), alignof(T));
+		return id;
+	}
+
+	template<typename... T>
+	static ComponentMask GetMask()
+	{
+		ComponentMask mask = 0;
+		int expand[] = { 0, ((mask |= 1ull << GetID<T>()), 0)... };
+		(void)expand;
+		return mask;
+	}
+};
+
+// Fixed size block holding the entity array followed by one contiguous array per component
+struct EntityChunk
+{
+	unsigned char* Data;
+	unsigned int Count;
+};
+
+struct Archetype
+{
+	ComponentMask Mask;
+	std::vector<unsigned int> Types;
+	size_t Offsets[MAX_COMPONENT_TYPES];
+	unsigned int Capacity;
+	std::vector<EntityChunk> Chunks;
+
+	inline Entity* GetEntities(const EntityChunk& chunk) const { return (Entity*)chunk.Data; }
+	inline unsigned char* GetComponents(const EntityChunk& chunk, unsigned int type) const { return chunk.Data + Offsets[type]; }
+	template<typename T>
+	inline T* GetArray(const EntityChunk& chunk) const { return (T*)(chunk.Data + Offsets[ComponentRegistry::GetID<T>()]); }
+};
+
+// Entity-component store grouping entities by component set (archetype) into chunks, so systems
+// iterate tightly packed component arrays. Components must be trivially copyable.
+class EntityRegistry
+{
+private:
+	struct EntityRecord
+	{
+		unsigned int Generation;
+		unsigned int Archetype;
+		unsigned int Chunk;
+		unsigned int Row;
+	};
+
+	std::vector<Archetype> m_Archetypes;
+	std::unordered_map<ComponentMask, unsigned int> m_ArchetypeOfMask;
+	std::vector<EntityRecord> m_Records;
+	std::vector<unsigned int> m_FreeIndices;
+
+public:
+	EntityRegistry();
+	~EntityRegistry();
+	EntityRegistry(const EntityRegistry&) = delete;
+	EntityRegistry& operator=(const EntityRegistry&) = delete;
+
+	Entity CreateEntity();
+	template<typename... T>
+	Entity CreateEntity(const T&... components)
+	{
+		Entity entity = CreateEntityWithMask(ComponentRegistry::GetMask<T...>());
+		int expand[] = { 0, (SetComponentData(entity, ComponentRegistry::GetID<T>(), &components), 0)... };
+		(void)expand;
+		return entity;
+	}
+	void DestroyEntity(Entity entity);
+	bool IsAlive(Entity entity) const;
+
+	// Both assert on stale handles and ignore them
+	template<typename T>
+	void AddComponent(Entity entity, const T& component)
+	{
+		ASSERT(IsAlive(entity));
+		if (!IsAlive(entity))
+			return;
+		const EntityRecord& record = m_Records[entity.Index];
+		ChangeArchetype(entity, m_Archetypes[record.Archetype].Mask | (1ull << ComponentRegistry::GetID<T>()));
+		SetComponentData(entity, ComponentRegistry::GetID<T>(), &component);
+	}
+
+	template<typename T>
+	void RemoveComponent(Entity entity)
+	{
+		ASSERT(IsAlive(entity));
+		if (!IsAlive(entity))
+			return;
+		const EntityRecord& record = m_Records[entity.Index];
+		ChangeArchetype(entity, m_Archetypes[record.Archetype].Mask & ~(1ull << ComponentRegistry::GetID<T>()));
+	}
+
+	// Null when the entity is dead or does not have the component, the pointer is invalidated by structural changes
+	template<typename T>
+	T* GetComponent(Entity entity)
+	{
+		if (!IsAlive(entity))
+			return nullptr;
+		const EntityRecord& record = m_Records[entity.Index];
+		const Archetype& archetype = m_Archetypes[record.Archetype];
+		if (!(archetype.Mask & (1ull << ComponentRegistry::GetID<T>())))
+			return nullptr;
+		return archetype.GetArray<T>(archetype.Chunks[record.Chunk]) + record.Row;
+	}
+
+	// func(count, T* arrays...) once per chunk holding all of T
+	template<typename... T, typename F>
+	void EachChunk(F func)
+	{
+		ComponentMask mask = ComponentRegistry::GetMask<T...>();
+		for (Archetype& archetype : m_Archetypes)
+		{
+			if ((archetype.Mask & mask) != mask)
+				continue;
+			for (EntityChunk& chunk : archetype.Chunks)
+			{
+				if (chunk.Count > 0)
+					func(chunk.Count, archetype.GetArray<T>(chunk)...);
+			}
+		}
+	}
+
+	// func(T& components...) for every entity holding all of T
+	template<typename... T, typename F>
+	void Each(F func)
+	{
+		EachChunk<T...>([&func](unsigned int count, T*... arrays)
+		{
+			for (unsigned int i = 0; i < count; i++)
+				func(arrays[i]...);
+		});
+	}
+
+	// Same as EachChunk with chunks spread over the pool, func must be safe to run concurrently
+	template<typename... T, typename F>
+	void ParallelEachChunk(ThreadPool& pool, F func)
+	{
+		ComponentMask mask = ComponentRegistry::GetMask<T...>();
+		std::vector<std::pair<Archetype*, EntityChunk*>> chunks;
+		for (Archetype& archetype : m_Archetypes)
+		{
+			if ((archetype.Mask & mask) != mask)
+				continue;
+			for (EntityChunk& chunk : archetype.Chunks)
+			{
+				if (chunk.Count > 0)
+					chunks.push_back({ &archetype, &chunk });
+			}
+		}
+		pool.ParallelFor(chunks.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+				func(chunks[i].second->Count, chunks[i].first->template GetArray<T>(*chunks[i].second)...);
+		});
+	}
+
+	inline unsigned int GetArchetypeCount() const { return (unsigned int)m_Archetypes.size(); }
+
+private:
+	// Separate name so the variadic CreateEntity never captures a plain mask argument
+	Entity CreateEntityWithMask(ComponentMask mask);
+	unsigned int GetOrCreateArchetype(ComponentMask mask);
+	void AllocateRow(unsigned int archetypeIndex, Entity entity);
+	void FreeRow(unsigned int archetypeIndex, unsigned int chunkIndex, unsigned int row);
+	void ChangeArchetype(Entity entity, ComponentMask mask);
+	void SetComponentData(Entity entity, unsigned int type, const void* data);
+};
@@ -0,0 +1,147 @@
+#include "FileWatcher.h"
+
+#include<chrono>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::FileWatcher()
+	:m_Running(true), m_NextID(0), m_NotifyFD(-1)
+{
+#ifdef __linux__
+	m_NotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+	m_Thread = std::thread(&FileWatcher::Run, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+	m_Running = false;
+	m_Thread.join();
+#ifdef __linux__
+	if (m_NotifyFD != -1)
+		close(m_NotifyFD);
+#endif
+}
+
+int FileWatcher::Watch(const std::string& filePath, std::function<void(const std::string&)> callback)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	WatchEntry entry;
+	entry.ID = m_NextID++;
+	entry.FilePath = filePath;
+	size_t slash = filePath.find_last_of("/\\");
+	entry.Directory = slash == std::string::npos ? "." : filePath.substr(0, slash);
+	entry.FileName = slash == std::string::npos ? filePath : filePath.substr(slash + 1);
+	entry.ModifiedTime = GetModifiedTime(filePath);
+	entry.Callback = std::move(callback);
+
+#ifdef __linux__
+	// Editors often save through a rename, so the directory is watched rather than the file itself
+	if (m_NotifyFD != -1)
+	{
+		bool watched = false;
+		for (const auto& directory : m_DirectoryWatches)
+			watched = watched || directory.second == entry.Directory;
+		if (!watched)
+		{
+			int wd = inotify_add_watch(m_NotifyFD, entry.Directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+			if (wd != -1)
+				m_DirectoryWatches.push_back({ wd, entry.Directory });
+		}
+	}
+#endif
+
+	m_Entries.push_back(std::move(entry));
+	return m_Entries.back().ID;
+}
+
+void FileWatcher::Unwatch(int watchID)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	for (unsigned int i = 0; i < m_Entries.size(); i++)
+	{
+		if (m_Entries[i].ID == watchID)
+		{
+			m_Entries.erase(m_Entries.begin() + i);
+			return;
+		}
+	}
+}
+
+void FileWatcher::Run()
+{
+	while (m_Running)
+	{
+#ifdef __linux__
+		if (m_NotifyFD != -1)
+		{
+			pollfd descriptor = { m_NotifyFD, POLLIN, 0 };
+			if (poll(&descriptor, 1, 100) > 0)
+				ReadNotifications();
+			continue;
+		}
+#endif
+		std::this_thread::sleep_for(std::chrono::milliseconds(250));
+		PollModifiedTimes();
+	}
+}
+
+void FileWatcher::PollModifiedTimes()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	for (auto& entry : m_Entries)
+	{
+		long long modifiedTime = GetModifiedTime(entry.FilePath);
+		if (modifiedTime != entry.ModifiedTime)
+		{
+			entry.ModifiedTime = modifiedTime;
+			entry.Callback(entry.FilePath);
+		}
+	}
+}
+
+void FileWatcher::ReadNotifications()
+{
+#ifdef __linux__
+	alignas(inotify_event) char buffer[4096];
+	ssize_t length;
+	while ((length = read(m_NotifyFD, buffer, sizeof(buffer))) > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (char* ptr = buffer; ptr < buffer + length; ptr += sizeof(inotify_event) + ((inotify_event*)ptr)->len)
+		{
+			const inotify_event* event = (const inotify_event*)ptr;
+			if (event->len == 0)
+				continue;
+
+			std::string directory;
+			for (const auto& watch : m_DirectoryWatches)
+				if (watch.first == event->wd)
+					directory = watch.second;
+
+			for (auto& entry : m_Entries)
+			{
+				if (entry.Directory == directory && entry.FileName == event->name)
+				{
+					entry.ModifiedTime = GetModifiedTime(entry.FilePath);
+					entry.Callback(entry.FilePath);
+				}
+			}
+		}
+	}
+#endif
+}
+
+long long FileWatcher::GetModifiedTime(const std::string& filePath)
+{
+	struct stat info;
+	if (stat(filePath.c_str(), &info) != 0)
+		return 0;
+	return (long long)info.st_mtime;
+}
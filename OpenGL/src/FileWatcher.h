@@ -0,0 +1,45 @@
+#pragma once
+
+#include<string>
+#include<vector>
+#include<functional>
+#include<thread>
+#include<mutex>
+#include<atomic>
+
+// Watches files for modification on a background thread (inotify on Linux, modification time polling elsewhere)
+class FileWatcher
+{
+private:
+	struct WatchEntry
+	{
+		int ID;
+		std::string FilePath;
+		std::string Directory;
+		std::string FileName;
+		long long ModifiedTime;
+		std::function<void(const std::string&)> Callback;
+	};
+
+	std::vector<WatchEntry> m_Entries;
+	std::mutex m_Mutex;
+	std::thread m_Thread;
+	std::atomic<bool> m_Running;
+	int m_NextID;
+	int m_NotifyFD;
+	std::vector<std::pair<int, std::string>> m_DirectoryWatches;
+
+public:
+	FileWatcher();
+	~FileWatcher();
+
+	// The callback runs on the watcher thread, Unwatch guarantees it is no longer running
+	int Watch(const std::string& filePath, std::function<void(const std::string&)> callback);
+	void Unwatch(int watchID);
+
+private:
+	void Run();
+	void PollModifiedTimes();
+	void ReadNotifications();
+	static long long GetModifiedTime(const std::string& filePath);
+};
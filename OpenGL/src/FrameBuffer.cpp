@@ -0,0 +1,108 @@
+#include "FrameBuffer.h"
+#include "Texture.h"
+#include "Renderer.h"
+#include "DeletionQueue.h"
+#include "GL\glew.h"
+
+#include<utility>
+#include<iostream>
+
+FrameBuffer::FrameBuffer()
+	:m_Width(0), m_Height(0), m_ColorCount(0), m_DepthAttachment(0)
+{
+	GLCall(glGenFramebuffers(1, &m_RendererID));
+}
+
+FrameBuffer::~FrameBuffer()
+{
+	DeletionQueue::Enqueue(GLResourceType::FRAMEBUFFER, m_RendererID);
+}
+
+FrameBuffer::FrameBuffer(FrameBuffer&& other)
+	:m_RendererID(other.m_RendererID), m_Width(other.m_Width), m_Height(other.m_Height), m_ColorCount(other.m_ColorCount),
+	m_DepthAttachment(other.m_DepthAttachment)
+{
+	other.m_RendererID = 0;
+}
+
+FrameBuffer& FrameBuffer::operator=(FrameBuffer&& other)
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_Width, other.m_Width);
+	std::swap(m_Height, other.m_Height);
+	std::swap(m_ColorCount, other.m_ColorCount);
+	std::swap(m_DepthAttachment, other.m_DepthAttachment);
+	return *this;
+}
+
+void FrameBuffer::AttachColor(unsigned int index, const Texture& texture, unsigned int level)
+{
+	ASSERT(index < FRAMEBUFFER_MAX_COLOR_ATTACHMENTS);
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + index, GL_TEXTURE_2D, texture.GetRendererID(), level));
+	m_Width = texture.GetWidth() >> level;
+	m_Height = texture.GetHeight() >> level;
+	if (index + 1 > m_ColorCount)
+		m_ColorCount = index + 1;
+}
+
+void FrameBuffer::AttachDepth(const Texture& texture, unsigned int level)
+{
+	GLenum attachment = texture.GetFormat() == GL_DEPTH24_STENCIL8 || texture.GetFormat() == GL_DEPTH32F_STENCIL8
+		? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture.GetRendererID(), level));
+	m_DepthAttachment = attachment;
+	m_Width = texture.GetWidth() >> level;
+	m_Height = texture.GetHeight() >> level;
+}
+
+bool FrameBuffer::Validate()
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	if (m_ColorCount == 0)
+	{
+		GLCall(glDrawBuffer(GL_NONE));
+		GLCall(glReadBuffer(GL_NONE));
+	}
+	else
+	{
+		GLenum drawBuffers[FRAMEBUFFER_MAX_COLOR_ATTACHMENTS];
+		for (unsigned int i = 0; i < m_ColorCount; i++)
+			drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+		GLCall(glDrawBuffers(m_ColorCount, drawBuffers));
+	}
+
+	GLCall(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "Framebuffer incomplete (" << status << ")" << std::endl;
+	return status == GL_FRAMEBUFFER_COMPLETE;
+}
+
+void FrameBuffer::Bind() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(glViewport(0, 0, m_Width, m_Height));
+}
+
+void FrameBuffer::BindRead() const
+{
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID));
+}
+
+void FrameBuffer::UnBind() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void FrameBuffer::Invalidate() const
+{
+	GLenum attachments[FRAMEBUFFER_MAX_COLOR_ATTACHMENTS + 1];
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < m_ColorCount; i++)
+		attachments[count++] = GL_COLOR_ATTACHMENT0 + i;
+	if (m_DepthAttachment)
+		attachments[count++] = m_DepthAttachment;
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(glInvalidateFramebuffer(GL_FRAMEBUFFER, count, attachments));
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#define FRAMEBUFFER_MAX_COLOR_ATTACHMENTS 8
+
+class Texture;
+
+// Render target made of texture attachments, several color attachments render as MRT
+class FrameBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Width;
+	unsigned int m_Height;
+	unsigned int m_ColorCount;
+	// GL_DEPTH_ATTACHMENT, GL_DEPTH_STENCIL_ATTACHMENT or 0
+	unsigned int m_DepthAttachment;
+
+public:
+	FrameBuffer();
+	~FrameBuffer();
+	FrameBuffer(const FrameBuffer&) = delete;
+	FrameBuffer& operator=(const FrameBuffer&) = delete;
+	FrameBuffer(FrameBuffer&& other);
+	FrameBuffer& operator=(FrameBuffer&& other);
+
+	// Attachments must all have the same size
+	void AttachColor(unsigned int index, const Texture& texture, unsigned int level = 0);
+	void AttachDepth(const Texture& texture, unsigned int level = 0);
+	// Enables the draw buffers of every color attachment and checks completeness, prints the status on failure
+	bool Validate();
+
+	// Binds for drawing and sets the viewport to the attachment size
+	void Bind() const;
+	void BindRead() const;
+	void UnBind() const;
+	// Tells the driver the contents of every attachment are no longer needed, so they are neither kept nor reloaded
+	void Invalidate() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline unsigned int GetColorCount() const { return m_ColorCount; }
+};
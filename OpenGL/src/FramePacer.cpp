@@ -0,0 +1,142 @@
+#include "FramePacer.h"
+#include "Renderer.h"
+#include "DeletionQueue.h"
+#include "GL\glew.h"
+#include "GLFW\glfw3.h"
+
+#include<thread>
+#include<iostream>
+#include<algorithm>
+
+static double Milliseconds(std::chrono::high_resolution_clock::duration duration)
+{
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+FramePacer::FramePacer(FramePacingMode mode, unsigned int maxFramesInFlight)
+	:m_Mode(mode), m_TargetFps(60.0), m_MaxFramesInFlight(maxFramesInFlight > 0 ? maxFramesInFlight : 1), m_ReportInterval(0),
+	m_Accumulated({ 0.0, 0.0, 0.0, 0.0, 0 }), m_LastStats({ 0.0, 0.0, 0.0, 0.0, 0 }), m_LatencySamples(0)
+{
+	m_FrameStart = m_NextDeadline = Clock::now();
+	MarkInput();
+	SetMode(mode);
+}
+
+FramePacer::~FramePacer()
+{
+	for (const FrameInFlight& frame : m_Frames)
+	{
+		GLCall(glDeleteSync((GLsync)frame.Fence));
+		DeletionQueue::Enqueue(GLResourceType::QUERY, frame.CompletionQuery);
+	}
+	for (unsigned int query : m_FreeQueries)
+		DeletionQueue::Enqueue(GLResourceType::QUERY, query);
+}
+
+void FramePacer::SetMode(FramePacingMode mode, double targetFps)
+{
+	m_Mode = mode;
+	m_TargetFps = targetFps > 1.0 ? targetFps : 1.0;
+	m_NextDeadline = Clock::now();
+	// The frame rate cap is done on the CPU, vsync would fight it
+	glfwSwapInterval(mode == FramePacingMode::VSYNC ? 1 : 0);
+}
+
+void FramePacer::RetireFrames(bool wait)
+{
+	while (!m_Frames.empty())
+	{
+		// Fences signal in order, only the oldest one is ever waited on
+		bool block = wait && m_Frames.size() >= m_MaxFramesInFlight;
+		GLCall(GLenum status = glClientWaitSync((GLsync)m_Frames.front().Fence, block ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+			block ? 1000000000ull : 0));
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			break;
+
+		// The timestamp was issued before the fence, so its result is ready as well
+		GLuint64 completion = 0;
+		GLCall(glGetQueryObjectui64v(m_Frames.front().CompletionQuery, GL_QUERY_RESULT, &completion));
+		double latency = ((long long)completion - m_Frames.front().InputTime) / 1000000.0;
+		m_Accumulated.InputToPresent += latency;
+		m_Accumulated.MaxInputToPresent = std::max(m_Accumulated.MaxInputToPresent, latency);
+		m_LatencySamples++;
+		GLCall(glDeleteSync((GLsync)m_Frames.front().Fence));
+		m_FreeQueries.push_back(m_Frames.front().CompletionQuery);
+		m_Frames.pop_front();
+	}
+}
+
+void FramePacer::BeginFrame()
+{
+	Clock::time_point waitStart = Clock::now();
+	RetireFrames(true);
+
+	if (m_Mode == FramePacingMode::TARGET_FPS)
+	{
+		// Sleep most of the way and spin the rest, sleep granularity is too coarse on its own
+		Clock::time_point now = Clock::now();
+		if (m_NextDeadline > now + std::chrono::milliseconds(2))
+			std::this_thread::sleep_until(m_NextDeadline - std::chrono::milliseconds(2));
+		while (Clock::now() < m_NextDeadline)
+			std::this_thread::yield();
+
+		// Stay on the schedule unless a frame ran long, then start over from now
+		Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_TargetFps));
+		m_NextDeadline += period;
+		if (m_NextDeadline < Clock::now())
+			m_NextDeadline = Clock::now() + period;
+	}
+
+	Clock::time_point now = Clock::now();
+	m_Accumulated.CpuWait += Milliseconds(now - waitStart);
+	m_Accumulated.FrameTime += Milliseconds(now - m_FrameStart);
+	m_FrameStart = now;
+}
+
+void FramePacer::MarkInput()
+{
+	// The GPU's current time, without waiting for the work queued so far
+	GLint64 time = 0;
+	GLCall(glGetInteger64v(GL_TIMESTAMP, &time));
+	m_InputTime = time;
+}
+
+void FramePacer::Present(GLFWwindow* window)
+{
+	glfwSwapBuffers(window);
+	unsigned int query = 0;
+	if (m_FreeQueries.empty())
+	{
+		GLCall(glGenQueries(1, &query));
+	}
+	else
+	{
+		query = m_FreeQueries.back();
+		m_FreeQueries.pop_back();
+	}
+	GLCall(glQueryCounter(query, GL_TIMESTAMP));
+	GLCall(void* fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	m_Frames.push_back({ fence, query, m_InputTime });
+	RetireFrames(false);
+
+	m_Accumulated.Frames++;
+	if (m_ReportInterval > 0 && m_Accumulated.Frames >= m_ReportInterval)
+		Report();
+}
+
+void FramePacer::Report()
+{
+	unsigned int frames = m_Accumulated.Frames;
+	m_LastStats.Frames = frames;
+	m_LastStats.FrameTime = m_Accumulated.FrameTime / frames;
+	m_LastStats.CpuWait = m_Accumulated.CpuWait / frames;
+	m_LastStats.InputToPresent = m_LatencySamples > 0 ? m_Accumulated.InputToPresent / m_LatencySamples : 0.0;
+	m_LastStats.MaxInputToPresent = m_Accumulated.MaxInputToPresent;
+	m_Accumulated = { 0.0, 0.0, 0.0, 0.0, 0 };
+	m_LatencySamples = 0;
+
+	static const char* modeNames[] = { "uncapped", "vsync", "target fps" };
+	std::cout << "[Pacing] " << modeNames[(int)m_Mode] << ", " << m_MaxFramesInFlight << " in flight: frame "
+		<< m_LastStats.FrameTime << " ms, CPU wait " << m_LastStats.CpuWait << " ms, input to present "
+		<< m_LastStats.InputToPresent << " ms (max " << m_LastStats.MaxInputToPresent << " ms)" << std::endl;
+}
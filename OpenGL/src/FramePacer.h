@@ -0,0 +1,79 @@
+#pragma once
+
+#include<deque>
+#include<vector>
+#include<chrono>
+
+struct GLFWwindow;
+
+enum class FramePacingMode
+{
+	UNCAPPED, VSYNC, TARGET_FPS
+};
+
+// Averages over the last report interval, in milliseconds
+struct FramePacerStats
+{
+	double FrameTime;
+	// Time BeginFrame spent blocked on the frames-in-flight limit or the frame rate cap
+	double CpuWait;
+	// From input sampling to the GPU finishing the frame, including the swap. Both ends are read on the GPU clock,
+	// so the result does not depend on when the CPU got around to checking the frame's fence.
+	double InputToPresent;
+	double MaxInputToPresent;
+	unsigned int Frames;
+};
+
+// Bounds how far the CPU runs ahead of the GPU with a fence per presented frame, and times each frame's
+// completion with a timestamp query issued after the swap
+class FramePacer
+{
+private:
+	typedef std::chrono::high_resolution_clock Clock;
+
+	struct FrameInFlight
+	{
+		// GLsync
+		void* Fence;
+		unsigned int CompletionQuery;
+		// GPU clock, nanoseconds
+		long long InputTime;
+	};
+
+	FramePacingMode m_Mode;
+	double m_TargetFps;
+	unsigned int m_MaxFramesInFlight;
+	unsigned int m_ReportInterval;
+	std::deque<FrameInFlight> m_Frames;
+	std::vector<unsigned int> m_FreeQueries;
+	Clock::time_point m_FrameStart;
+	long long m_InputTime;
+	Clock::time_point m_NextDeadline;
+	FramePacerStats m_Accumulated;
+	FramePacerStats m_LastStats;
+	unsigned int m_LatencySamples;
+
+public:
+	FramePacer(FramePacingMode mode = FramePacingMode::VSYNC, unsigned int maxFramesInFlight = 2);
+	~FramePacer();
+
+	// Needs the current context, target FPS only applies to TARGET_FPS
+	void SetMode(FramePacingMode mode, double targetFps = 60.0);
+	inline void SetMaxFramesInFlight(unsigned int frames) { m_MaxFramesInFlight = frames > 0 ? frames : 1; }
+	// Prints the averages every 'frames' frames, 0 disables reporting
+	inline void SetReportInterval(unsigned int frames) { m_ReportInterval = frames; }
+
+	// Top of the frame: waits for a free frame slot and the frame rate deadline, then sample input
+	void BeginFrame();
+	// Call right after polling input, latency is measured from the last call. Reads the GPU clock.
+	void MarkInput();
+	// Swaps and fences the frame
+	void Present(GLFWwindow* window);
+
+	inline FramePacingMode GetMode() const { return m_Mode; }
+	inline const FramePacerStats& GetLastStats() const { return m_LastStats; }
+
+private:
+	void RetireFrames(bool wait);
+	void Report();
+};
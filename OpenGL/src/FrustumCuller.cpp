@@ -0,0 +1,183 @@
+#include "FrustumCuller.h"
+#include "Simd.h"
+
+#include<chrono>
+
+#define CULL_CHUNK_SIZE 16384
+
+FrustumCuller::FrustumCuller()
+	:m_Count(0), m_LastStats({ 0, 0, 0.0 })
+{
+}
+
+void FrustumCuller::Clear()
+{
+	m_Count = 0;
+	m_CenterX.clear();
+	m_CenterY.clear();
+	m_CenterZ.clear();
+	m_Radius.clear();
+}
+
+unsigned int FrustumCuller::Add(const Sphere& sphere)
+{
+	// Arrays stay padded to a multiple of 8 so the SIMD loops never need a scalar tail,
+	// padding spheres have a huge negative radius and are never visible
+	if (m_Count % 8 == 0)
+	{
+		m_CenterX.resize(m_Count + 8, 0.0f);
+		m_CenterY.resize(m_Count + 8, 0.0f);
+		m_CenterZ.resize(m_Count + 8, 0.0f);
+		m_Radius.resize(m_Count + 8, -1e30f);
+	}
+	Set(m_Count, sphere);
+	return m_Count++;
+}
+
+void FrustumCuller::Set(unsigned int index, const Sphere& sphere)
+{
+	m_CenterX[index] = sphere.Center.x;
+	m_CenterY[index] = sphere.Center.y;
+	m_CenterZ[index] = sphere.Center.z;
+	m_Radius[index] = sphere.Radius;
+}
+
+void FrustumCuller::Cull(const Frustum& frustum, std::vector<unsigned int>& visible, ThreadPool* pool)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	visible.clear();
+
+	unsigned int chunkCount = (m_Count + CULL_CHUNK_SIZE - 1) / CULL_CHUNK_SIZE;
+	if (!pool || chunkCount <= 1)
+	{
+		CullRange(frustum, 0, m_Count, visible);
+	}
+	else
+	{
+		// Per-chunk lists keep the output ordered without any synchronisation
+		if (m_ChunkResults.size() < chunkCount)
+			m_ChunkResults.resize(chunkCount);
+		pool->ParallelFor(chunkCount, 1, [&](size_t begin, size_t end)
+		{
+			for (size_t chunk = begin; chunk < end; chunk++)
+			{
+				unsigned int first = (unsigned int)chunk * CULL_CHUNK_SIZE;
+				unsigned int last = first + CULL_CHUNK_SIZE < m_Count ? first + CULL_CHUNK_SIZE : m_Count;
+				m_ChunkResults[chunk].clear();
+				CullRange(frustum, first, last, m_ChunkResults[chunk]);
+			}
+		});
+		for (unsigned int chunk = 0; chunk < chunkCount; chunk++)
+			visible.insert(visible.end(), m_ChunkResults[chunk].begin(), m_ChunkResults[chunk].end());
+	}
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	m_LastStats = { m_Count, (unsigned int)visible.size(), elapsed.count() };
+}
+
+static void CullScalar(const Frustum& frustum, const float* x, const float* y, const float* z, const float* radius,
+	unsigned int begin, unsigned int end, std::vector<unsigned int>& visible)
+{
+	for (unsigned int i = begin; i < end; i++)
+	{
+		bool inside = true;
+		for (const Vec4& plane : frustum.Planes)
+			inside = inside && plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w >= -radius[i];
+		if (inside)
+			visible.push_back(i);
+	}
+}
+
+#ifdef SIMD_X86
+static void CullSSE(const Frustum& frustum, const float* x, const float* y, const float* z, const float* radius,
+	unsigned int begin, unsigned int end, std::vector<unsigned int>& visible)
+{
+	__m128 planes[6][4];
+	for (int p = 0; p < 6; p++)
+	{
+		planes[p][0] = _mm_set1_ps(frustum.Planes[p].x);
+		planes[p][1] = _mm_set1_ps(frustum.Planes[p].y);
+		planes[p][2] = _mm_set1_ps(frustum.Planes[p].z);
+		planes[p][3] = _mm_set1_ps(frustum.Planes[p].w);
+	}
+
+	for (unsigned int i = begin; i < end; i += 4)
+	{
+		__m128 cx = _mm_loadu_ps(x + i), cy = _mm_loadu_ps(y + i), cz = _mm_loadu_ps(z + i);
+		__m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; p++)
+		{
+			__m128 distance = _mm_add_ps(_mm_mul_ps(planes[p][0], cx), planes[p][3]);
+			distance = _mm_add_ps(distance, _mm_mul_ps(planes[p][1], cy));
+			distance = _mm_add_ps(distance, _mm_mul_ps(planes[p][2], cz));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		while (mask)
+		{
+			unsigned int bit = 0;
+			while (!(mask & (1 << bit)))
+				bit++;
+			if (i + bit < end)
+				visible.push_back(i + bit);
+			mask &= mask - 1;
+		}
+	}
+}
+
+SIMD_AVX2_FUNCTION static void CullAVX2(const Frustum& frustum, const float* x, const float* y, const float* z, const float* radius,
+	unsigned int begin, unsigned int end, std::vector<unsigned int>& visible)
+{
+	__m256 planes[6][4];
+	for (int p = 0; p < 6; p++)
+	{
+		planes[p][0] = _mm256_set1_ps(frustum.Planes[p].x);
+		planes[p][1] = _mm256_set1_ps(frustum.Planes[p].y);
+		planes[p][2] = _mm256_set1_ps(frustum.Planes[p].z);
+		planes[p][3] = _mm256_set1_ps(frustum.Planes[p].w);
+	}
+
+	unsigned int indices[8];
+	for (unsigned int i = begin; i < end; i += 8)
+	{
+		__m256 cx = _mm256_loadu_ps(x + i), cy = _mm256_loadu_ps(y + i), cz = _mm256_loadu_ps(z + i);
+		__m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radius + i));
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int p = 0; p < 6; p++)
+		{
+			__m256 distance = _mm256_fmadd_ps(planes[p][0], cx, planes[p][3]);
+			distance = _mm256_fmadd_ps(planes[p][1], cy, distance);
+			distance = _mm256_fmadd_ps(planes[p][2], cz, distance);
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+		}
+
+		// Mostly empty or full groups in practice, so skip or copy them wholesale
+		int mask = _mm256_movemask_ps(inside);
+		if (mask == 0)
+			continue;
+		unsigned int count = 0;
+		for (unsigned int bit = 0; bit < 8; bit++)
+		{
+			indices[count] = i + bit;
+			count += (mask >> bit) & 1;
+		}
+		while (count > 0 && indices[count - 1] >= end)
+			count--;
+		visible.insert(visible.end(), indices, indices + count);
+	}
+}
+#endif
+
+void FrustumCuller::CullRange(const Frustum& frustum, unsigned int begin, unsigned int end, std::vector<unsigned int>& visible) const
+{
+#ifdef SIMD_X86
+	// Chunks start on multiples of 8 and the arrays are padded, so whole groups can always be loaded
+	if (MathBatch::GetLevel() == SimdLevel::AVX2)
+		return CullAVX2(frustum, m_CenterX.data(), m_CenterY.data(), m_CenterZ.data(), m_Radius.data(), begin, end, visible);
+	if (MathBatch::GetLevel() == SimdLevel::SSE)
+		return CullSSE(frustum, m_CenterX.data(), m_CenterY.data(), m_CenterZ.data(), m_Radius.data(), begin, end, visible);
+#endif
+	CullScalar(frustum, m_CenterX.data(), m_CenterY.data(), m_CenterZ.data(), m_Radius.data(), begin, end, visible);
+}
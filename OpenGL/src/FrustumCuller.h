@@ -0,0 +1,45 @@
+#pragma once
+
+#include "VectorMath.h"
+#include "ThreadPool.h"
+
+#include<vector>
+
+struct FrustumCullStats
+{
+	unsigned int Tested;
+	unsigned int Visible;
+	double Milliseconds;
+
+	inline double GetCulledPerMillisecond() const { return Milliseconds > 0.0 ? (Tested - Visible) / Milliseconds : 0.0; }
+};
+
+// Bounding spheres in SoA arrays tested against the frustum 8 (AVX2) or 4 (SSE) at a time
+class FrustumCuller
+{
+private:
+	std::vector<float> m_CenterX;
+	std::vector<float> m_CenterY;
+	std::vector<float> m_CenterZ;
+	std::vector<float> m_Radius;
+	unsigned int m_Count;
+	std::vector<std::vector<unsigned int>> m_ChunkResults;
+	FrustumCullStats m_LastStats;
+
+public:
+	FrustumCuller();
+
+	void Clear();
+	// Returns the index reported back by Cull
+	unsigned int Add(const Sphere& sphere);
+	void Set(unsigned int index, const Sphere& sphere);
+	inline unsigned int GetCount() const { return m_Count; }
+
+	// Fills visible with the indices of intersecting spheres in ascending order,
+	// large sets are split over the pool when one is given
+	void Cull(const Frustum& frustum, std::vector<unsigned int>& visible, ThreadPool* pool = nullptr);
+	inline const FrustumCullStats& GetLastStats() const { return m_LastStats; }
+
+private:
+	void CullRange(const Frustum& frustum, unsigned int begin, unsigned int end, std::vector<unsigned int>& visible) const;
+};
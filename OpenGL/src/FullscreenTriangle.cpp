@@ -0,0 +1,10 @@
+#include "FullscreenTriangle.h"
+#include "Renderer.h"
+
+void FullscreenTriangle::Draw(const Shader& shader) const
+{
+	shader.Bind();
+	m_VertexArray.Bind();
+	GLCall(glDrawArrays(GL_TRIANGLES, 0, 3));
+	GLStats::RecordDraw(GL_TRIANGLES, 3);
+}
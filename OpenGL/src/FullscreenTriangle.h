@@ -0,0 +1,14 @@
+#pragma once
+
+#include "VertexArray.h"
+#include "Shader.h"
+
+// One triangle covering the viewport, its positions come from gl_VertexID (see Fullscreen.glsl)
+class FullscreenTriangle
+{
+private:
+	VertexArray m_VertexArray;
+
+public:
+	void Draw(const Shader& shader) const;
+};
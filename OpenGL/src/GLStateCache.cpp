@@ -0,0 +1,165 @@
+#include "GLStateCache.h"
+#include "Renderer.h"
+#include "GL\glew.h"
+
+// Start from the state of a new context
+unsigned int GLStateCache::s_Program = 0;
+BlendState GLStateCache::s_Blend[PIPELINE_BLEND_TARGETS] = { BlendState::Disabled(), BlendState::Disabled() };
+DepthState GLStateCache::s_Depth = DepthState::Disabled();
+bool GLStateCache::s_CullEnabled = false;
+unsigned int GLStateCache::s_CullFace = GL_BACK;
+bool GLStateCache::s_DepthClamp = false;
+bool GLStateCache::s_OffsetEnabled = false;
+float GLStateCache::s_OffsetSlope = 0.0f;
+float GLStateCache::s_OffsetConstant = 0.0f;
+unsigned long long GLStateCache::s_Issued = 0;
+unsigned long long GLStateCache::s_Skipped = 0;
+
+static void SetCapability(GLenum capability, bool enabled)
+{
+	if (enabled)
+	{
+		GLCall(glEnable(capability));
+	}
+	else
+	{
+		GLCall(glDisable(capability));
+	}
+}
+
+void GLStateCache::Bind(const PipelineState& pipeline)
+{
+	const PipelineStateDesc& desc = pipeline.GetDesc();
+	desc.Program->Bind();
+	for (unsigned int i = 0; i < PIPELINE_BLEND_TARGETS; i++)
+		SetBlendState(i, desc.Blend[i]);
+	SetDepthState(desc.Depth);
+	SetRasterState(desc.Raster);
+}
+
+void GLStateCache::UseProgram(unsigned int program)
+{
+	if (program == s_Program)
+	{
+		s_Skipped++;
+		return;
+	}
+	GLCall(glUseProgram(program));
+	s_Program = program;
+	s_Issued++;
+}
+
+void GLStateCache::SetBlendState(unsigned int target, const BlendState& state)
+{
+	BlendState& current = s_Blend[target];
+	if (state.Enabled != current.Enabled)
+	{
+		if (state.Enabled)
+		{
+			GLCall(glEnablei(GL_BLEND, target));
+		}
+		else
+		{
+			GLCall(glDisablei(GL_BLEND, target));
+		}
+		s_Issued++;
+	}
+	else
+	{
+		s_Skipped++;
+	}
+
+	// Factors of a disabled target are left as they are until it is enabled again
+	if (state.Enabled && (state.Source != current.Source || state.Destination != current.Destination))
+	{
+		GLCall(glBlendFunci(target, state.Source, state.Destination));
+		current.Source = state.Source;
+		current.Destination = state.Destination;
+		s_Issued++;
+	}
+	else
+	{
+		s_Skipped++;
+	}
+	current.Enabled = state.Enabled;
+}
+
+void GLStateCache::SetBlendState(const BlendState& state)
+{
+	for (unsigned int i = 0; i < PIPELINE_BLEND_TARGETS; i++)
+		SetBlendState(i, state);
+}
+
+void GLStateCache::SetDepthState(const DepthState& state)
+{
+	unsigned long long issued = s_Issued;
+	if (state.Test != s_Depth.Test)
+	{
+		SetCapability(GL_DEPTH_TEST, state.Test);
+		s_Issued++;
+	}
+	if (state.Write != s_Depth.Write)
+	{
+		GLCall(glDepthMask(state.Write ? GL_TRUE : GL_FALSE));
+		s_Issued++;
+	}
+	if (state.Function != s_Depth.Function)
+	{
+		GLCall(glDepthFunc(state.Function));
+		s_Issued++;
+	}
+	s_Skipped += 3 - (s_Issued - issued);
+	s_Depth = state;
+}
+
+void GLStateCache::SetRasterState(const RasterState& state)
+{
+	unsigned long long issued = s_Issued;
+	bool cull = state.CullFace != GL_NONE;
+	if (cull != s_CullEnabled)
+	{
+		SetCapability(GL_CULL_FACE, cull);
+		s_CullEnabled = cull;
+		s_Issued++;
+	}
+	if (cull && state.CullFace != s_CullFace)
+	{
+		GLCall(glCullFace(state.CullFace));
+		s_CullFace = state.CullFace;
+		s_Issued++;
+	}
+	if (state.DepthClamp != s_DepthClamp)
+	{
+		SetCapability(GL_DEPTH_CLAMP, state.DepthClamp);
+		s_DepthClamp = state.DepthClamp;
+		s_Issued++;
+	}
+	bool offset = state.DepthBiasSlope != 0.0f || state.DepthBiasConstant != 0.0f;
+	if (offset != s_OffsetEnabled)
+	{
+		SetCapability(GL_POLYGON_OFFSET_FILL, offset);
+		s_OffsetEnabled = offset;
+		s_Issued++;
+	}
+	if (offset && (state.DepthBiasSlope != s_OffsetSlope || state.DepthBiasConstant != s_OffsetConstant))
+	{
+		GLCall(glPolygonOffset(state.DepthBiasSlope, state.DepthBiasConstant));
+		s_OffsetSlope = state.DepthBiasSlope;
+		s_OffsetConstant = state.DepthBiasConstant;
+		s_Issued++;
+	}
+	s_Skipped += 5 - (s_Issued - issued);
+}
+
+void GLStateCache::Reset()
+{
+	SetBlendState(BlendState::Disabled());
+	SetDepthState(DepthState::Disabled());
+	SetRasterState(RasterState::Default());
+}
+
+void GLStateCache::ForgetProgram(unsigned int program)
+{
+	if (program == s_Program)
+		s_Program = 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "PipelineState.h"
+
+// Shadow copy of the GL state the pipelines cover. Every change goes through here and is compared
+// against the copy first, so binding a pipeline only issues the calls for what actually differs.
+// GL thread only, the state must not be changed behind its back.
+class GLStateCache
+{
+private:
+	static unsigned int s_Program;
+	static BlendState s_Blend[PIPELINE_BLEND_TARGETS];
+	static DepthState s_Depth;
+	// Raster state as GL holds it, the face and offset stay set while their capability is off
+	static bool s_CullEnabled;
+	static unsigned int s_CullFace;
+	static bool s_DepthClamp;
+	static bool s_OffsetEnabled;
+	static float s_OffsetSlope;
+	static float s_OffsetConstant;
+	static unsigned long long s_Issued;
+	static unsigned long long s_Skipped;
+
+public:
+	static void Bind(const PipelineState& pipeline);
+
+	static void UseProgram(unsigned int program);
+	static void SetBlendState(unsigned int target, const BlendState& state);
+	// Same state on every target
+	static void SetBlendState(const BlendState& state);
+	static void SetDepthState(const DepthState& state);
+	static void SetRasterState(const RasterState& state);
+	// Fixed-function state back to the GL defaults, the program stays bound
+	static void Reset();
+
+	// The program is being deleted, its name may be handed out again
+	static void ForgetProgram(unsigned int program);
+
+	// State changes sent to GL and the ones dropped because the state was already set
+	static inline unsigned long long GetIssuedCount() { return s_Issued; }
+	static inline unsigned long long GetSkippedCount() { return s_Skipped; }
+};
@@ -0,0 +1,158 @@
+#include "GLStats.h"
+
+#include <GL/glew.h>
+#include<iostream>
+#include <fstream>
+#include <sstream>
+#include <cctype>
+
+bool GLStats::s_Enabled = false;
+unsigned int GLStats::s_ReportInterval = 0;
+GLStatsFormat GLStats::s_Format = GLStatsFormat::TEXT;
+std::string GLStats::s_OutputPath;
+unsigned long long GLStats::s_FrameIndex = 0;
+GLFrameStats GLStats::s_Current = {};
+GLFrameStats GLStats::s_LastFrame = {};
+std::unordered_map<const char*, unsigned int> GLStats::s_CallSites;
+
+void GLStats::SetEnabled(bool enabled)
+{
+	s_Enabled = enabled;
+	s_Current = {};
+	s_CallSites.clear();
+}
+
+void GLStats::SetReportInterval(unsigned int frames, GLStatsFormat format, const std::string& outputPath)
+{
+	s_ReportInterval = frames;
+	s_Format = format;
+	s_OutputPath = outputPath;
+}
+
+void GLStats::RecordCall(const char* call)
+{
+	if (!s_Enabled)
+		return;
+
+	// Keyed by the literal produced by the macro, names are only resolved once per frame
+	s_CallSites[call]++;
+	s_Current.Calls++;
+}
+
+void GLStats::RecordDraw(unsigned int mode, unsigned int count, unsigned int instanceCount)
+{
+	if (!s_Enabled)
+		return;
+
+	unsigned int primitives = 0;
+	switch (mode)
+	{
+	case GL_POINTS: primitives = count; break;
+	case GL_LINES: primitives = count / 2; break;
+	case GL_LINE_LOOP: primitives = count; break;
+	case GL_LINE_STRIP: primitives = count > 0 ? count - 1 : 0; break;
+	case GL_TRIANGLES: primitives = count / 3; break;
+	case GL_TRIANGLE_STRIP:
+	case GL_TRIANGLE_FAN: primitives = count > 1 ? count - 2 : 0; break;
+	}
+	s_Current.DrawCalls++;
+	s_Current.Primitives += (unsigned long long)primitives * instanceCount;
+}
+
+void GLStats::RecordIndirectDraw()
+{
+	if (!s_Enabled)
+		return;
+
+	s_Current.DrawCalls++;
+	s_Current.IndirectDrawCalls++;
+}
+
+void GLStats::RecordUpload(unsigned long long bytes)
+{
+	if (!s_Enabled)
+		return;
+
+	s_Current.BytesUploaded += bytes;
+}
+
+void GLStats::EndFrame()
+{
+	if (!s_Enabled)
+		return;
+
+	for (const auto& site : s_CallSites)
+	{
+		std::string function = GetFunctionName(site.first);
+		if (function.compare(0, 6, "glBind") == 0 || function == "glUseProgram")
+			s_Current.Binds += site.second;
+		s_Current.CallsByFunction[function] += site.second;
+	}
+	s_CallSites.clear();
+
+	s_LastFrame = std::move(s_Current);
+	s_Current = {};
+	s_FrameIndex++;
+
+	if (s_ReportInterval != 0 && s_FrameIndex % s_ReportInterval == 0)
+		Report(s_LastFrame);
+}
+
+std::string GLStats::GetFunctionName(const char* call)
+{
+	// "int location = glGetUniformLocation(id, name)" -> "glGetUniformLocation"
+	std::string text(call);
+	size_t end = text.find('(');
+	if (end == std::string::npos)
+		return text;
+	size_t begin = end;
+	while (begin > 0 && (isalnum((unsigned char)text[begin - 1]) || text[begin - 1] == '_'))
+		begin--;
+	return text.substr(begin, end - begin);
+}
+
+void GLStats::Report(const GLFrameStats& stats)
+{
+	if (s_Format == GLStatsFormat::JSON)
+	{
+		if (s_OutputPath.empty())
+		{
+			std::cout << ToJson(stats) << std::endl;
+		}
+		else
+		{
+			std::ofstream stream(s_OutputPath, std::ios::app);
+			stream << ToJson(stats) << '\n';
+		}
+		return;
+	}
+
+	std::cout << "[GL stats] frame " << s_FrameIndex << ": " << stats.Calls << " calls, " << stats.Binds << " binds, "
+		<< stats.DrawCalls << " draws, " << stats.Primitives << " primitives";
+	if (stats.IndirectDrawCalls > 0)
+		std::cout << " (" << stats.IndirectDrawCalls << " indirect draws of unknown primitive count not included)";
+	std::cout << ", " << stats.BytesUploaded << " bytes uploaded" << std::endl;
+	for (const auto& function : stats.CallsByFunction)
+		std::cout << "\t" << function.first << ": " << function.second << std::endl;
+}
+
+std::string GLStats::ToJson(const GLFrameStats& stats)
+{
+	std::stringstream ss;
+	ss << "{\"frame\":" << s_FrameIndex
+		<< ",\"calls\":" << stats.Calls
+		<< ",\"binds\":" << stats.Binds
+		<< ",\"drawCalls\":" << stats.DrawCalls
+		<< ",\"indirectDrawCalls\":" << stats.IndirectDrawCalls
+		<< ",\"primitives\":" << stats.Primitives
+		<< ",\"bytesUploaded\":" << stats.BytesUploaded
+		<< ",\"functions\":{";
+	bool first = true;
+	for (const auto& function : stats.CallsByFunction)
+	{
+		ss << (first ? "" : ",") << "\"" << function.first << "\":" << function.second;
+		first = false;
+	}
+	ss << "}}";
+	return ss.str();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include<string>
+#include<unordered_map>
+
+// Counters collected for a single frame
+struct GLFrameStats
+{
+	unsigned int Calls;
+	unsigned int Binds;
+	unsigned int DrawCalls;
+	// Part of DrawCalls, their primitive counts stay on the GPU and are not in Primitives
+	unsigned int IndirectDrawCalls;
+	unsigned long long Primitives;
+	unsigned long long BytesUploaded;
+	std::unordered_map<std::string, unsigned int> CallsByFunction;
+};
+
+enum class GLStatsFormat
+{
+	TEXT, JSON
+};
+
+// Per-frame GL call statistics, fed by the GLCall macro and the draw/upload paths
+class GLStats
+{
+private:
+	static bool s_Enabled;
+	static unsigned int s_ReportInterval;
+	static GLStatsFormat s_Format;
+	static std::string s_OutputPath;
+	static unsigned long long s_FrameIndex;
+	static GLFrameStats s_Current;
+	static GLFrameStats s_LastFrame;
+	static std::unordered_map<const char*, unsigned int> s_CallSites;
+
+public:
+	static void SetEnabled(bool enabled);
+	static inline bool IsEnabled() { return s_Enabled; }
+
+	// Report every 'frames' frames (0 disables reporting), JSON goes to stdout when no path is given
+	static void SetReportInterval(unsigned int frames, GLStatsFormat format = GLStatsFormat::TEXT, const std::string& outputPath = "");
+
+	static void RecordCall(const char* call);
+	static void RecordDraw(unsigned int mode, unsigned int count, unsigned int instanceCount = 1);
+	// One glDraw*Indirect call, however many commands it reads
+	static void RecordIndirectDraw();
+	static void RecordUpload(unsigned long long bytes);
+
+	// Closes the current frame and reports it if the interval elapsed
+	static void EndFrame();
+	static inline const GLFrameStats& GetLastFrame() { return s_LastFrame; }
+
+private:
+	static std::string GetFunctionName(const char* call);
+	static void Report(const GLFrameStats& stats);
+	static std::string ToJson(const GLFrameStats& stats);
+};
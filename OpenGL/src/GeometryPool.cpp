@@ -0,0 +1,151 @@
+#include "GeometryPool.h"
+#include "Renderer.h"
+#include "DeletionQueue.h"
+#include "GL\glew.h"
+
+#include<algorithm>
+
+GeometryPool::GeometryPool(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity)
+	:m_Layout(layout), m_VertexAllocator(vertexCapacity), m_IndexAllocator(indexCapacity), m_Version(0)
+{
+	GLCall(glGenBuffers(1, &m_VertexBuffer));
+	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_VertexBuffer));
+	GLCall(glBufferData(GL_ARRAY_BUFFER, vertexCapacity * layout.GetStrinde(), nullptr, GL_STATIC_DRAW));
+	GLCall(glGenBuffers(1, &m_IndexBuffer));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_IndexBuffer));
+	GLCall(glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity * sizeof(unsigned int), nullptr, GL_STATIC_DRAW));
+	GLCall(glGenVertexArrays(1, &m_VertexArray));
+	SetupVertexArray();
+}
+
+GeometryPool::~GeometryPool()
+{
+	DeletionQueue::Enqueue(GLResourceType::VERTEX_ARRAY, m_VertexArray);
+	DeletionQueue::Enqueue(GLResourceType::BUFFER, m_VertexBuffer);
+	DeletionQueue::Enqueue(GLResourceType::BUFFER, m_IndexBuffer);
+}
+
+void GeometryPool::SetupVertexArray()
+{
+	// Attribute pointers capture the buffer bound when they are set, so this reruns after defragmentation
+	GLCall(glBindVertexArray(m_VertexArray));
+	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_VertexBuffer));
+	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBuffer));
+	std::vector<VertexBufferElement> elements = m_Layout.GetElements();
+	unsigned int offset = 0;
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		const VertexBufferElement element = elements[i];
+		GLCall(glEnableVertexAttribArray(i));
+		GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized,
+			m_Layout.GetStrinde(), (const void*)(size_t)offset));
+		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+	}
+	GLCall(glBindVertexArray(0));
+}
+
+GeometryHandle GeometryPool::Add(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+	BufferAllocation vertexRange = m_VertexAllocator.Allocate(vertexCount);
+	BufferAllocation indexRange = m_IndexAllocator.Allocate(indexCount);
+	if (!vertexRange.IsValid() || !indexRange.IsValid())
+	{
+		m_VertexAllocator.Free(vertexRange);
+		m_IndexAllocator.Free(indexRange);
+		return{ 0 };
+	}
+
+	unsigned int stride = m_Layout.GetStrinde();
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_VertexBuffer));
+	GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, vertexRange.Offset * stride, vertexCount * stride, vertices));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_IndexBuffer));
+	GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, indexRange.Offset * sizeof(unsigned int), indexCount * sizeof(unsigned int), indices));
+	GLStats::RecordUpload(vertexCount * stride + indexCount * sizeof(unsigned int));
+
+	return m_Ranges.Create(GeometryRange{ vertexRange, indexRange, vertexCount, indexCount });
+}
+
+void GeometryPool::Remove(GeometryHandle handle)
+{
+	const GeometryRange* range = m_Ranges.Get(handle);
+	if (!range)
+		return;
+	m_VertexAllocator.Free(range->Vertices);
+	m_IndexAllocator.Free(range->Indices);
+	m_Ranges.Destroy(handle);
+}
+
+void GeometryPool::Bind() const
+{
+	GLCall(glBindVertexArray(m_VertexArray));
+}
+
+void GeometryPool::UnBind() const
+{
+	GLCall(glBindVertexArray(0));
+}
+
+void GeometryPool::Draw(GeometryHandle handle) const
+{
+	const GeometryRange* range = m_Ranges.Get(handle);
+	if (!range)
+		return;
+	GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, range->IndexCount, GL_UNSIGNED_INT,
+		(void*)(size_t)(range->GetFirstIndex() * sizeof(unsigned int)), range->GetBaseVertex()));
+	GLStats::RecordDraw(GL_TRIANGLES, range->IndexCount);
+}
+
+void GeometryPool::Defragment()
+{
+	// Source and destination ranges may overlap, which glCopyBufferSubData forbids within one buffer,
+	// so everything is copied into new buffers in offset order
+	std::vector<GeometryRange*> ranges;
+	for (GeometryRange& range : m_Ranges)
+		ranges.push_back(&range);
+	std::sort(ranges.begin(), ranges.end(), [](const GeometryRange* a, const GeometryRange* b) { return a->Vertices.Offset < b->Vertices.Offset; });
+
+	unsigned int stride = m_Layout.GetStrinde();
+	unsigned int buffers[2];
+	GLCall(glGenBuffers(2, buffers));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[0]));
+	GLCall(glBufferData(GL_COPY_WRITE_BUFFER, m_VertexAllocator.GetCapacity() * stride, nullptr, GL_STATIC_DRAW));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[1]));
+	GLCall(glBufferData(GL_COPY_WRITE_BUFFER, m_IndexAllocator.GetCapacity() * sizeof(unsigned int), nullptr, GL_STATIC_DRAW));
+
+	// Allocating in order from empty allocators packs the ranges back to back
+	m_VertexAllocator.Reset();
+	m_IndexAllocator.Reset();
+	for (GeometryRange* range : ranges)
+	{
+		BufferAllocation vertices = m_VertexAllocator.Allocate(range->VertexCount);
+		BufferAllocation indices = m_IndexAllocator.Allocate(range->IndexCount);
+
+		GLCall(glBindBuffer(GL_COPY_READ_BUFFER, m_VertexBuffer));
+		GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[0]));
+		GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+			range->Vertices.Offset * stride, vertices.Offset * stride, range->VertexCount * stride));
+		GLCall(glBindBuffer(GL_COPY_READ_BUFFER, m_IndexBuffer));
+		GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[1]));
+		GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+			range->Indices.Offset * sizeof(unsigned int), indices.Offset * sizeof(unsigned int), range->IndexCount * sizeof(unsigned int)));
+
+		range->Vertices = vertices;
+		range->Indices = indices;
+	}
+
+	// Frames in flight may still read the old buffers
+	DeletionQueue::Enqueue(GLResourceType::BUFFER, m_VertexBuffer);
+	DeletionQueue::Enqueue(GLResourceType::BUFFER, m_IndexBuffer);
+	m_VertexBuffer = buffers[0];
+	m_IndexBuffer = buffers[1];
+	SetupVertexArray();
+	m_Version++;
+}
+
+float GeometryPool::GetFragmentation() const
+{
+	unsigned int freeSpace = m_VertexAllocator.GetFreeSpace();
+	if (freeSpace == 0)
+		return 0.0f;
+	return 1.0f - (float)m_VertexAllocator.GetLargestFreeBlock() / freeSpace;
+}
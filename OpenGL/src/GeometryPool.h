@@ -0,0 +1,65 @@
+#pragma once
+
+#include "BufferAllocator.h"
+#include "ResourcePool.h"
+#include "VertexBufferLayout.h"
+
+// Where a mesh lives inside the pool's shared buffers, in vertices and indices
+struct GeometryRange
+{
+	BufferAllocation Vertices;
+	BufferAllocation Indices;
+	unsigned int VertexCount;
+	unsigned int IndexCount;
+
+	inline unsigned int GetBaseVertex() const { return Vertices.Offset; }
+	inline unsigned int GetFirstIndex() const { return Indices.Offset; }
+};
+
+typedef ResourceHandle<GeometryRange> GeometryHandle;
+
+// Many small meshes packed into one large vertex buffer and one large index buffer behind a single
+// vertex array, so drawing them needs no rebinds. Indices stay relative to their mesh and are drawn
+// with a base vertex. Ranges come from TLSF allocators and defragmentation compacts both buffers.
+class GeometryPool
+{
+private:
+	VertexBufferLayout m_Layout;
+	unsigned int m_VertexArray;
+	unsigned int m_VertexBuffer;
+	unsigned int m_IndexBuffer;
+	BufferAllocator m_VertexAllocator;
+	BufferAllocator m_IndexAllocator;
+	ResourcePool<GeometryRange> m_Ranges;
+	unsigned int m_Version;
+
+public:
+	GeometryPool(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity);
+	~GeometryPool();
+	GeometryPool(const GeometryPool&) = delete;
+	GeometryPool& operator=(const GeometryPool&) = delete;
+
+	// Vertices follow the pool's layout, returns a null handle when either buffer has no room
+	GeometryHandle Add(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	void Remove(GeometryHandle handle);
+	inline const GeometryRange* Get(GeometryHandle handle) const { return m_Ranges.Get(handle); }
+
+	// Binds the shared vertex array, one bind covers every draw from the pool
+	void Bind() const;
+	void UnBind() const;
+	// Pool must be bound
+	void Draw(GeometryHandle handle) const;
+
+	// Moves every range to the front of fresh buffers with GPU copies, handles stay valid
+	void Defragment();
+	// Changes with every Defragment, ranges copied out of the pool before then are stale
+	inline unsigned int GetVersion() const { return m_Version; }
+
+	inline unsigned int GetVertexFreeSpace() const { return m_VertexAllocator.GetFreeSpace(); }
+	inline unsigned int GetIndexFreeSpace() const { return m_IndexAllocator.GetFreeSpace(); }
+	// Share of the free vertex space that is not in the largest block, 0 when fully compact
+	float GetFragmentation() const;
+
+private:
+	void SetupVertexArray();
+};
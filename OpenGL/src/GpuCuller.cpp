@@ -0,0 +1,119 @@
+#include "GpuCuller.h"
+#include "Renderer.h"
+#include "VectorMath.h"
+
+#include<cstring>
+
+#define CULL_GROUP_SIZE 256
+
+GpuCuller::GpuCuller(const GeometryPool& pool, const std::vector<GeometryHandle>& meshes, const std::vector<GpuCullInstance>& instances)
+	:m_Shader("res/shaders/FrustumCull.shader"),
+	m_Pool(pool), m_Meshes(meshes), m_PoolVersion(pool.GetVersion()),
+	m_Commands(meshes.size(), { 0, 0, 0, 0, 0 }),
+	m_InstanceMeshes(instances.size()),
+	m_InstancesPerMesh(meshes.size(), 0),
+	m_InstanceCount((unsigned int)instances.size()),
+	m_InstanceBuffer(instances.data(), m_InstanceCount * sizeof(GpuCullInstance)),
+	m_CommandBuffer(nullptr, (unsigned int)(meshes.size() * sizeof(DrawElementsIndirectCommand))),
+	m_VisibleBuffer(nullptr, m_InstanceCount * sizeof(unsigned int))
+{
+	ReadMeshRanges();
+	for (unsigned int i = 0; i < m_InstanceCount; i++)
+	{
+		ASSERT(instances[i].Mesh < meshes.size());
+		m_InstanceMeshes[i] = instances[i].Mesh;
+		m_InstancesPerMesh[instances[i].Mesh]++;
+	}
+	AssignVisibleRegions();
+}
+
+void GpuCuller::AssignVisibleRegions()
+{
+	unsigned int offset = 0;
+	for (unsigned int i = 0; i < m_Commands.size(); i++)
+	{
+		m_Commands[i].BaseInstance = offset;
+		offset += m_InstancesPerMesh[i];
+	}
+}
+
+void GpuCuller::ReadMeshRanges()
+{
+	for (unsigned int i = 0; i < m_Meshes.size(); i++)
+	{
+		const GeometryRange* range = m_Pool.Get(m_Meshes[i]);
+		ASSERT(range);
+		m_Commands[i].Count = range ? range->IndexCount : 0;
+		m_Commands[i].FirstIndex = range ? range->GetFirstIndex() : 0;
+		m_Commands[i].BaseVertex = range ? (int)range->GetBaseVertex() : 0;
+	}
+}
+
+void GpuCuller::UpdateInstances(unsigned int first, const GpuCullInstance* instances, unsigned int count)
+{
+	ASSERT(first + count <= m_InstanceCount);
+	if (first + count > m_InstanceCount)
+		return;
+
+	// A mesh gaining an instance needs a larger region, Cull uploads the moved BaseInstances with the commands
+	bool meshesChanged = false;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int& mesh = m_InstanceMeshes[first + i];
+		if (mesh == instances[i].Mesh)
+			continue;
+		ASSERT(instances[i].Mesh < m_Commands.size());
+		m_InstancesPerMesh[mesh]--;
+		m_InstancesPerMesh[instances[i].Mesh]++;
+		mesh = instances[i].Mesh;
+		meshesChanged = true;
+	}
+	if (meshesChanged)
+		AssignVisibleRegions();
+	m_InstanceBuffer.SetData(first * sizeof(GpuCullInstance), instances, count * sizeof(GpuCullInstance));
+}
+
+void GpuCuller::Cull(const float planes[6][4])
+{
+	// Defragmenting moved the ranges the commands point at
+	if (m_PoolVersion != m_Pool.GetVersion())
+	{
+		ReadMeshRanges();
+		m_PoolVersion = m_Pool.GetVersion();
+	}
+
+	// Reset the instance counts, the rest of the commands only changes in UpdateInstances and above
+	m_CommandBuffer.SetData(0, m_Commands.data(), (unsigned int)(m_Commands.size() * sizeof(DrawElementsIndirectCommand)));
+
+	m_InstanceBuffer.BindBase(GPU_CULL_INSTANCES_BINDING);
+	m_CommandBuffer.BindBase(GPU_CULL_COMMANDS_BINDING);
+	m_VisibleBuffer.BindBase(GPU_CULL_VISIBLE_BINDING);
+
+	m_Shader.Bind();
+	m_Shader.SetUniform4fv("u_Planes", &planes[0][0], 6);
+	m_Shader.SetUniform1ui("u_InstanceCount", m_InstanceCount);
+	m_Shader.Dispatch((m_InstanceCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE);
+
+	GLCall(glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT));
+}
+
+void GpuCuller::Draw(const Shader& shader) const
+{
+	shader.Bind();
+	m_Pool.Bind();
+	m_VisibleBuffer.BindBase(GPU_CULL_VISIBLE_BINDING);
+	m_CommandBuffer.BindIndirect();
+	GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)m_Commands.size(), 0));
+	GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+
+	// Instance counts stay on the GPU, only the call itself is known here
+	GLStats::RecordIndirectDraw();
+}
+
+void GpuCuller::ExtractPlanes(const float viewProjection[16], float planes[6][4])
+{
+	Mat4 matrix;
+	memcpy(matrix.m, viewProjection, sizeof(matrix.m));
+	Frustum frustum = Frustum::FromMatrix(matrix);
+	memcpy(planes, frustum.Planes, sizeof(frustum.Planes));
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Shader.h"
+#include "ShaderStorageBuffer.h"
+#include "GeometryPool.h"
+
+#include<vector>
+
+// std430 layout of an instance as read by FrustumCull.shader
+struct GpuCullInstance
+{
+	float Center[3];
+	float Radius;
+	unsigned int Mesh;
+	unsigned int Padding[3];
+};
+
+// Same layout as glDrawElementsIndirect expects
+struct DrawElementsIndirectCommand
+{
+	unsigned int Count;
+	unsigned int InstanceCount;
+	unsigned int FirstIndex;
+	int BaseVertex;
+	unsigned int BaseInstance;
+};
+
+#define GPU_CULL_INSTANCES_BINDING 0
+#define GPU_CULL_COMMANDS_BINDING 1
+#define GPU_CULL_VISIBLE_BINDING 2
+// Where GPU_INSTANCES shaders read per-instance transforms, see Instancing.glsl
+#define GPU_CULL_TRANSFORMS_BINDING 3
+
+// Frustum culls instances in a compute pass and writes one compacted indirect draw per mesh (GL 4.3+)
+class GpuCuller
+{
+private:
+	Shader m_Shader;
+	// Index ranges are read back from the pool whenever it was defragmented
+	const GeometryPool& m_Pool;
+	std::vector<GeometryHandle> m_Meshes;
+	unsigned int m_PoolVersion;
+	std::vector<DrawElementsIndirectCommand> m_Commands;
+	// Mesh of every instance and instances of every mesh, to move the visible list regions when meshes change
+	std::vector<unsigned int> m_InstanceMeshes;
+	std::vector<unsigned int> m_InstancesPerMesh;
+	unsigned int m_InstanceCount;
+	ShaderStorageBuffer m_InstanceBuffer;
+	ShaderStorageBuffer m_CommandBuffer;
+	ShaderStorageBuffer m_VisibleBuffer;
+
+public:
+	// Instance Mesh fields index meshes, the pool has to outlive the culler
+	GpuCuller(const GeometryPool& pool, const std::vector<GeometryHandle>& meshes, const std::vector<GpuCullInstance>& instances);
+	GpuCuller(const GpuCuller&) = delete;
+	GpuCuller& operator=(const GpuCuller&) = delete;
+
+	// Instances may switch meshes, the commands' regions of the visible list follow
+	void UpdateInstances(unsigned int first, const GpuCullInstance* instances, unsigned int count);
+
+	// Planes are (a, b, c, d) with the normal pointing inside, see ExtractPlanes
+	void Cull(const float planes[6][4]);
+	// Draws what the last Cull found from the pool. The shader reads u_Visible[gl_BaseInstanceARB + gl_InstanceID]
+	// to find its instance, see Instancing.glsl.
+	void Draw(const Shader& shader) const;
+
+	inline unsigned int GetInstanceCount() const { return m_InstanceCount; }
+	inline const ShaderStorageBuffer& GetVisibleBuffer() const { return m_VisibleBuffer; }
+
+	// Frustum::FromMatrix for callers holding raw column-major matrices
+	static void ExtractPlanes(const float viewProjection[16], float planes[6][4]);
+
+private:
+	// Every mesh reserves room in the visible list for all of its instances
+	void AssignVisibleRegions();
+	// Copies the current index ranges of the meshes into the commands, removed meshes draw nothing
+	void ReadMeshRanges();
+};
@@ -0,0 +1,50 @@
+#include "GpuTimer.h"
+#include "Renderer.h"
+#include "GL\glew.h"
+
+#include<utility>
+
+GpuTimer::GpuTimer(unsigned int latency)
+	:m_Queries(latency, 2), m_LastMilliseconds(0.0), m_TotalMilliseconds(0.0), m_Samples(0)
+{
+}
+
+GpuTimer::GpuTimer(GpuTimer&& other)
+	:m_Queries(std::move(other.m_Queries)), m_LastMilliseconds(other.m_LastMilliseconds),
+	m_TotalMilliseconds(other.m_TotalMilliseconds), m_Samples(other.m_Samples)
+{
+}
+
+GpuTimer& GpuTimer::operator=(GpuTimer&& other)
+{
+	std::swap(m_Queries, other.m_Queries);
+	std::swap(m_LastMilliseconds, other.m_LastMilliseconds);
+	std::swap(m_TotalMilliseconds, other.m_TotalMilliseconds);
+	std::swap(m_Samples, other.m_Samples);
+	return *this;
+}
+
+void GpuTimer::Begin()
+{
+	Poll();
+	GLCall(glQueryCounter(m_Queries.GetQuery(0), GL_TIMESTAMP));
+}
+
+void GpuTimer::End()
+{
+	GLCall(glQueryCounter(m_Queries.GetQuery(1), GL_TIMESTAMP));
+	m_Queries.Submit();
+}
+
+void GpuTimer::Poll()
+{
+	m_Queries.Poll([this](const unsigned int* queries)
+	{
+		GLuint64 start = 0, end = 0;
+		GLCall(glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &start));
+		GLCall(glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &end));
+		m_LastMilliseconds = (end - start) / 1000000.0;
+		m_TotalMilliseconds += m_LastMilliseconds;
+		m_Samples++;
+	});
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "QueryRing.h"
+
+// GPU time between Begin and End from timestamp queries. Results are read a few frames later without
+// stalling, so timers may nest and measurements arrive with a latency of up to 'latency' uses.
+class GpuTimer
+{
+private:
+	// Start and end timestamp per slot
+	QueryRing m_Queries;
+	double m_LastMilliseconds;
+	double m_TotalMilliseconds;
+	unsigned int m_Samples;
+
+public:
+	GpuTimer(unsigned int latency = 4);
+	GpuTimer(const GpuTimer&) = delete;
+	GpuTimer& operator=(const GpuTimer&) = delete;
+	GpuTimer(GpuTimer&& other);
+	GpuTimer& operator=(GpuTimer&& other);
+
+	void Begin();
+	void End();
+	// Collects finished measurements, Begin does this as well
+	void Poll();
+
+	inline double GetLastMilliseconds() const { return m_LastMilliseconds; }
+	// Sum and count of the measurements collected since ResetTotals
+	inline double GetTotalMilliseconds() const { return m_TotalMilliseconds; }
+	inline unsigned int GetSampleCount() const { return m_Samples; }
+	inline void ResetTotals() { m_TotalMilliseconds = 0.0; m_Samples = 0; }
+};
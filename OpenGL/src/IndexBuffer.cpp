@@ -1,19 +1,38 @@
 #include "IndexBuffer.h"
 #include "Renderer.h"
+#include "DeletionQueue.h"
 #include "GL\glew.h"
 
+#include<utility>
+
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
 	:m_Count(count)
 {
 	GLCall(glGenBuffers(1, &m_RendererID));
 	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
 	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+	GLStats::RecordUpload(m_Count * sizeof(unsigned int));
 
 }
 
 IndexBuffer::~IndexBuffer()
 {
-	GLCall(glDeleteBuffers(1, &m_RendererID));
+	DeletionQueue::Enqueue(GLResourceType::BUFFER, m_RendererID);
+}
+
+IndexBuffer::IndexBuffer(IndexBuffer&& other)
+	:m_RendererID(other.m_RendererID), m_Count(other.m_Count)
+{
+	other.m_RendererID = 0;
+	other.m_Count = 0;
+}
+
+// The previous buffer goes with other and is deleted when it is destroyed
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other)
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_Count, other.m_Count);
+	return *this;
 }
 
 void IndexBuffer::Bind() const
@@ -25,8 +44,3 @@ void IndexBuffer::UnBind() const
 {
 	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 }
-
-inline unsigned int IndexBuffer::GetCount() const
-{
-	return m_Count;
-}
@@ -8,7 +8,12 @@ private:
 public:
 	IndexBuffer(const unsigned int* data, unsigned int count);
 	~IndexBuffer();
+	// Owns the GL object: movable, never copied
+	IndexBuffer(const IndexBuffer&) = delete;
+	IndexBuffer& operator=(const IndexBuffer&) = delete;
+	IndexBuffer(IndexBuffer&& other);
+	IndexBuffer& operator=(IndexBuffer&& other);
 	void Bind() const;
 	void UnBind() const;
-	inline unsigned int GetCount() const;
+	inline unsigned int GetCount() const { return m_Count; }
 };
\ No newline at end of file
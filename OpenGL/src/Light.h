@@ -0,0 +1,15 @@
+#pragma once
+
+// Upper bound of the light buffers of both the deferred and the clustered paths
+#define MAX_POINT_LIGHTS 16384
+// "layout(std430, binding = 4) readonly buffer Lights" in the lighting shaders
+#define POINT_LIGHTS_BINDING 4
+
+// std430 layout of PointLight in Lighting.glsl
+struct PointLight
+{
+	float Position[3];
+	float Radius;
+	float Color[3];
+	float Intensity;
+};
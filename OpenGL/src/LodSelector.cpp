@@ -0,0 +1,42 @@
+#include "LodSelector.h"
+#include "Mesh.h"
+
+#include<cmath>
+#include<algorithm>
+
+LodSelector::LodSelector(float pixelThreshold, float hysteresis)
+	:m_PixelThreshold(pixelThreshold), m_Hysteresis(hysteresis), m_ProjectionScale(1.0f), m_Perspective(false)
+{
+}
+
+void LodSelector::SetPerspective(float fovY, float viewportHeight)
+{
+	m_ProjectionScale = viewportHeight / (2.0f * tanf(fovY * 0.5f));
+	m_Perspective = true;
+}
+
+void LodSelector::SetOrthographic(float viewHeight, float viewportHeight)
+{
+	m_ProjectionScale = viewportHeight / viewHeight;
+	m_Perspective = false;
+}
+
+float LodSelector::GetScreenError(float error, float distance) const
+{
+	if (!m_Perspective)
+		return error * m_ProjectionScale;
+	return error * m_ProjectionScale / std::max(distance, 1e-4f);
+}
+
+unsigned int LodSelector::Select(const Mesh& mesh, float scale, float distance, unsigned int currentLod) const
+{
+	unsigned int lod = std::min(currentLod, mesh.GetLodCount() - 1);
+
+	// Errors grow with the level, so walk from the current one: finer while it is clearly too coarse,
+	// coarser while the next level is clearly good enough
+	while (lod > 0 && GetScreenError(mesh.GetLodError(lod) * scale, distance) > m_PixelThreshold * (1.0f + m_Hysteresis))
+		lod--;
+	while (lod + 1 < mesh.GetLodCount() && GetScreenError(mesh.GetLodError(lod + 1) * scale, distance) < m_PixelThreshold * (1.0f - m_Hysteresis))
+		lod++;
+	return lod;
+}
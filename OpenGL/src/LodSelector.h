@@ -0,0 +1,27 @@
+#pragma once
+
+class Mesh;
+
+// Picks the coarsest mesh level whose error projects to no more than a pixel threshold.
+// The hysteresis band keeps objects near a switching distance from flickering between levels.
+class LodSelector
+{
+private:
+	float m_PixelThreshold;
+	float m_Hysteresis;
+	// Pixels per world unit at distance 1 for perspective, or everywhere for orthographic views
+	float m_ProjectionScale;
+	bool m_Perspective;
+
+public:
+	LodSelector(float pixelThreshold = 1.0f, float hysteresis = 0.25f);
+
+	void SetPerspective(float fovY, float viewportHeight);
+	void SetOrthographic(float viewHeight, float viewportHeight);
+	inline void SetPixelThreshold(float pixels) { m_PixelThreshold = pixels; }
+
+	// Screen size in pixels of a world space error at a view distance
+	float GetScreenError(float error, float distance) const;
+	// scale converts mesh units to world units, currentLod is the level chosen last frame
+	unsigned int Select(const Mesh& mesh, float scale, float distance, unsigned int currentLod) const;
+};
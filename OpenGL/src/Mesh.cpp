@@ -0,0 +1,35 @@
+#include "Mesh.h"
+#include "MeshSimplifier.h"
+#include "Renderer.h"
+
+Mesh::Mesh(RenderResources& resources, const float* vertices, unsigned int vertexCount, const VertexBufferLayout& layout,
+	const unsigned int* indices, unsigned int indexCount, unsigned int maxLods)
+{
+	ASSERT(!layout.GetElements().empty() && layout.GetElements()[0].type == GL_FLOAT && layout.GetElements()[0].count == 3);
+	m_VertexBuffer = resources.VertexBuffers.Create(vertices, vertexCount * layout.GetStrinde());
+	m_VertexArray = resources.VertexArrays.Create();
+	resources.VertexArrays.Get(m_VertexArray)->AddBuffer(*resources.VertexBuffers.Get(m_VertexBuffer), layout);
+	m_DepthVertexArray = resources.VertexArrays.Create();
+	resources.VertexArrays.Get(m_DepthVertexArray)->AddBuffer(*resources.VertexBuffers.Get(m_VertexBuffer), layout.GetPositionLayout());
+
+	std::vector<MeshLod> chain = MeshSimplifier::BuildLodChain(vertices, vertexCount, layout.GetStrinde() / sizeof(float),
+		indices, indexCount, maxLods);
+	for (const MeshLod& lod : chain)
+	{
+		m_Lods.push_back(resources.IndexBuffers.Create(lod.Indices.data(), (unsigned int)lod.Indices.size()));
+		m_LodErrors.push_back(lod.Error);
+		m_TriangleCounts.push_back((unsigned int)lod.Indices.size() / 3);
+	}
+}
+
+void Mesh::Destroy(RenderResources& resources)
+{
+	for (IndexBufferHandle lod : m_Lods)
+		resources.IndexBuffers.Destroy(lod);
+	resources.VertexArrays.Destroy(m_VertexArray);
+	resources.VertexArrays.Destroy(m_DepthVertexArray);
+	resources.VertexBuffers.Destroy(m_VertexBuffer);
+	m_Lods.clear();
+	m_LodErrors.clear();
+	m_TriangleCounts.clear();
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "RenderResources.h"
+#include "VertexBufferLayout.h"
+
+#include<vector>
+
+// Vertex data with a chain of index buffers, level 0 is full detail and every level shares the same vertices.
+// The GL objects live in the resource pools, the mesh only keeps their handles.
+class Mesh
+{
+private:
+	VertexArrayHandle m_VertexArray;
+	// Same buffer, position attribute only
+	VertexArrayHandle m_DepthVertexArray;
+	VertexBufferHandle m_VertexBuffer;
+	std::vector<IndexBufferHandle> m_Lods;
+	std::vector<float> m_LodErrors;
+	std::vector<unsigned int> m_TriangleCounts;
+
+public:
+	// The first attribute of the layout must be a float xyz position, the LOD chain is built here at load time
+	Mesh(RenderResources& resources, const float* vertices, unsigned int vertexCount, const VertexBufferLayout& layout,
+		const unsigned int* indices, unsigned int indexCount, unsigned int maxLods = 4);
+
+	// Returns the buffers to the pools, the handles are stale afterwards
+	void Destroy(RenderResources& resources);
+
+	inline VertexArrayHandle GetVertexArray() const { return m_VertexArray; }
+	// For depth-only passes
+	inline VertexArrayHandle GetDepthVertexArray() const { return m_DepthVertexArray; }
+	inline unsigned int GetLodCount() const { return (unsigned int)m_Lods.size(); }
+	inline IndexBufferHandle GetLod(unsigned int lod) const { return m_Lods[lod]; }
+	// Geometric error of a level in mesh units
+	inline float GetLodError(unsigned int lod) const { return m_LodErrors[lod]; }
+	inline unsigned int GetTriangleCount(unsigned int lod) const { return m_TriangleCounts[lod]; }
+};
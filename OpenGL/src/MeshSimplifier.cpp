@@ -0,0 +1,232 @@
+#include "MeshSimplifier.h"
+#include "VectorMath.h"
+
+#include<queue>
+#include<unordered_map>
+#include<algorithm>
+#include<cmath>
+
+// Symmetric 4x4 error quadric, sum of squared distances to a set of planes with their total weight
+struct Quadric
+{
+	double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+	double Weight;
+
+	static Quadric FromPlane(double a, double b, double c, double d, double weight)
+	{
+		return{ a * a * weight, a * b * weight, a * c * weight, a * d * weight, b * b * weight,
+			b * c * weight, b * d * weight, c * c * weight, c * d * weight, d * d * weight, weight };
+	}
+
+	inline Quadric operator+(const Quadric& q) const
+	{
+		return{ a2 + q.a2, ab + q.ab, ac + q.ac, ad + q.ad, b2 + q.b2, bc + q.bc, bd + q.bd, c2 + q.c2, cd + q.cd, d2 + q.d2, Weight + q.Weight };
+	}
+
+	inline double Evaluate(const Vec3& p) const
+	{
+		double x = p.x, y = p.y, z = p.z;
+		return a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x
+			+ b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y
+			+ c2 * z * z + 2.0 * cd * z + d2;
+	}
+};
+
+struct Collapse
+{
+	double Cost;
+	unsigned int From;
+	unsigned int To;
+	unsigned int FromVersion;
+	unsigned int ToVersion;
+
+	inline bool operator>(const Collapse& other) const { return Cost > other.Cost; }
+};
+
+// Boundary edges get a perpendicular plane so open borders and seams keep their shape
+#define BOUNDARY_WEIGHT 10.0
+
+std::vector<unsigned int> MeshSimplifier::Simplify(const float* vertices, unsigned int vertexCount, unsigned int stride,
+	const unsigned int* indices, unsigned int indexCount, unsigned int targetIndexCount, float* error)
+{
+	std::vector<Vec3> positions(vertexCount);
+	for (unsigned int v = 0; v < vertexCount; v++)
+		positions[v] = { vertices[v * stride], vertices[v * stride + 1], vertices[v * stride + 2] };
+
+	std::vector<unsigned int> triangles(indices, indices + indexCount);
+	unsigned int triangleCount = indexCount / 3;
+	std::vector<bool> deadTriangles(triangleCount, false);
+	std::vector<Quadric> quadrics(vertexCount, Quadric());
+	std::vector<std::vector<unsigned int>> vertexTriangles(vertexCount);
+	// Edge key -> (face count, last face)
+	std::unordered_map<unsigned long long, std::pair<unsigned int, unsigned int>> edges;
+
+	auto faceNormal = [&](unsigned int t) -> Vec3
+	{
+		const Vec3& p0 = positions[triangles[t * 3]];
+		return Cross(positions[triangles[t * 3 + 1]] - p0, positions[triangles[t * 3 + 2]] - p0);
+	};
+	auto edgeKey = [](unsigned int a, unsigned int b) -> unsigned long long
+	{
+		return a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a;
+	};
+
+	for (unsigned int t = 0; t < triangleCount; t++)
+	{
+		Vec3 normal = Normalize(faceNormal(t));
+		double d = -Dot(normal, positions[triangles[t * 3]]);
+		Quadric plane = Quadric::FromPlane(normal.x, normal.y, normal.z, d, 1.0);
+		for (int corner = 0; corner < 3; corner++)
+		{
+			unsigned int v = triangles[t * 3 + corner];
+			quadrics[v] = quadrics[v] + plane;
+			vertexTriangles[v].push_back(t);
+
+			std::pair<unsigned int, unsigned int>& edge = edges[edgeKey(v, triangles[t * 3 + (corner + 1) % 3])];
+			edge.first++;
+			edge.second = t;
+		}
+	}
+
+	for (const auto& edge : edges)
+	{
+		if (edge.second.first != 1)
+			continue;
+		unsigned int a = (unsigned int)(edge.first >> 32), b = (unsigned int)(edge.first & 0xffffffff);
+		Vec3 direction = positions[b] - positions[a];
+		Vec3 normal = Normalize(Cross(direction, Normalize(faceNormal(edge.second.second))));
+		double d = -Dot(normal, positions[a]);
+		Quadric plane = Quadric::FromPlane(normal.x, normal.y, normal.z, d, BOUNDARY_WEIGHT);
+		quadrics[a] = quadrics[a] + plane;
+		quadrics[b] = quadrics[b] + plane;
+	}
+
+	// Lazy priority queue, entries are stale once either vertex changed since they were pushed
+	std::vector<unsigned int> versions(vertexCount, 0);
+	std::vector<bool> removed(vertexCount, false);
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+	auto pushEdge = [&](unsigned int a, unsigned int b)
+	{
+		Quadric q = quadrics[a] + quadrics[b];
+		double costToB = q.Evaluate(positions[b]), costToA = q.Evaluate(positions[a]);
+		if (costToB <= costToA)
+			queue.push({ costToB, a, b, versions[a], versions[b] });
+		else
+			queue.push({ costToA, b, a, versions[b], versions[a] });
+	};
+	for (const auto& edge : edges)
+		pushEdge((unsigned int)(edge.first >> 32), (unsigned int)(edge.first & 0xffffffff));
+
+	unsigned int liveTriangles = triangleCount;
+	double maxError = 0.0;
+	std::vector<unsigned int> neighbours;
+	while (liveTriangles * 3 > targetIndexCount && !queue.empty())
+	{
+		Collapse collapse = queue.top();
+		queue.pop();
+		if (removed[collapse.From] || removed[collapse.To] || versions[collapse.From] != collapse.FromVersion || versions[collapse.To] != collapse.ToVersion)
+			continue;
+
+		// Reject collapses that would fold a surviving triangle over
+		bool flips = false;
+		for (unsigned int t : vertexTriangles[collapse.From])
+		{
+			unsigned int* tri = &triangles[t * 3];
+			if (deadTriangles[t] || tri[0] == collapse.To || tri[1] == collapse.To || tri[2] == collapse.To)
+				continue;
+			Vec3 before = faceNormal(t);
+			Vec3 p[3];
+			for (int corner = 0; corner < 3; corner++)
+				p[corner] = positions[tri[corner] == collapse.From ? collapse.To : tri[corner]];
+			if (Dot(before, Cross(p[1] - p[0], p[2] - p[0])) <= 0.0f)
+			{
+				flips = true;
+				break;
+			}
+		}
+		if (flips)
+			continue;
+
+		removed[collapse.From] = true;
+		quadrics[collapse.To] = quadrics[collapse.To] + quadrics[collapse.From];
+		versions[collapse.To]++;
+		// Reported error is the mean squared distance over the merged planes
+		if (quadrics[collapse.To].Weight > 0.0)
+			maxError = std::max(maxError, collapse.Cost / quadrics[collapse.To].Weight);
+		for (unsigned int t : vertexTriangles[collapse.From])
+		{
+			if (deadTriangles[t])
+				continue;
+			unsigned int* tri = &triangles[t * 3];
+			for (int corner = 0; corner < 3; corner++)
+			{
+				if (tri[corner] == collapse.From)
+					tri[corner] = collapse.To;
+			}
+			if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0])
+			{
+				deadTriangles[t] = true;
+				liveTriangles--;
+			}
+			else
+			{
+				vertexTriangles[collapse.To].push_back(t);
+			}
+		}
+		vertexTriangles[collapse.From].clear();
+
+		// Costs around the surviving vertex changed
+		neighbours.clear();
+		std::vector<unsigned int>& around = vertexTriangles[collapse.To];
+		around.erase(std::remove_if(around.begin(), around.end(), [&](unsigned int t) { return deadTriangles[t]; }), around.end());
+		std::sort(around.begin(), around.end());
+		around.erase(std::unique(around.begin(), around.end()), around.end());
+		for (unsigned int t : around)
+		{
+			for (int corner = 0; corner < 3; corner++)
+			{
+				if (triangles[t * 3 + corner] != collapse.To)
+					neighbours.push_back(triangles[t * 3 + corner]);
+			}
+		}
+		std::sort(neighbours.begin(), neighbours.end());
+		neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+		for (unsigned int neighbour : neighbours)
+			pushEdge(collapse.To, neighbour);
+	}
+
+	std::vector<unsigned int> result;
+	result.reserve(liveTriangles * 3);
+	for (unsigned int t = 0; t < triangleCount; t++)
+	{
+		if (!deadTriangles[t])
+			result.insert(result.end(), &triangles[t * 3], &triangles[t * 3] + 3);
+	}
+	if (error)
+		*error = (float)sqrt(maxError);
+	return result;
+}
+
+std::vector<MeshLod> MeshSimplifier::BuildLodChain(const float* vertices, unsigned int vertexCount, unsigned int stride,
+	const unsigned int* indices, unsigned int indexCount, unsigned int maxLevels, float ratio)
+{
+	std::vector<MeshLod> chain;
+	chain.push_back({ std::vector<unsigned int>(indices, indices + indexCount), 0.0f });
+
+	// Each level starts over from the source so errors stay relative to the original surface
+	while (chain.size() < maxLevels)
+	{
+		unsigned int previousCount = (unsigned int)chain.back().Indices.size();
+		unsigned int target = (unsigned int)(previousCount / 3 * ratio) * 3;
+		if (target < 3)
+			break;
+
+		MeshLod lod;
+		lod.Indices = Simplify(vertices, vertexCount, stride, indices, indexCount, target, &lod.Error);
+		if (lod.Indices.empty() || lod.Indices.size() > previousCount * 9 / 10)
+			break;
+		lod.Error = std::max(lod.Error, chain.back().Error);
+		chain.push_back(lod);
+	}
+	return chain;
+}
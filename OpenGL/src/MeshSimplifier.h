@@ -0,0 +1,26 @@
+#pragma once
+
+#include<vector>
+
+struct MeshLod
+{
+	std::vector<unsigned int> Indices;
+	// Geometric error in mesh units, 0 for the source level
+	float Error;
+};
+
+// Quadric error edge collapse. Vertices only ever collapse onto existing ones, so every level
+// is a new index list over the same vertex data.
+class MeshSimplifier
+{
+public:
+	// Vertices start with an xyz position, stride is in floats. Returns at most targetIndexCount indices
+	// unless no valid collapse is left, error receives the geometric error of the result.
+	static std::vector<unsigned int> Simplify(const float* vertices, unsigned int vertexCount, unsigned int stride,
+		const unsigned int* indices, unsigned int indexCount, unsigned int targetIndexCount, float* error = nullptr);
+
+	// Level 0 is the source, every further level aims for ratio of the previous triangle count.
+	// The chain ends early once a level stops shrinking.
+	static std::vector<MeshLod> BuildLodChain(const float* vertices, unsigned int vertexCount, unsigned int stride,
+		const unsigned int* indices, unsigned int indexCount, unsigned int maxLevels = 4, float ratio = 0.5f);
+};
@@ -0,0 +1,355 @@
+#include "OcclusionCuller.h"
+#include "Simd.h"
+
+#include<algorithm>
+#include<chrono>
+#include<cmath>
+
+// Vertices closer than this in clip w are treated as crossing the near plane
+#define OCCLUSION_NEAR_W 1e-4f
+
+OcclusionCuller::OcclusionCuller(unsigned int width, unsigned int height)
+	:m_ViewProjection(Mat4::Identity()), m_LastStats({ 0, 0, 0, 0.0, 0.0 })
+{
+	m_TilesX = (width + OCCLUSION_TILE_WIDTH - 1) / OCCLUSION_TILE_WIDTH;
+	m_TilesY = (height + OCCLUSION_TILE_HEIGHT - 1) / OCCLUSION_TILE_HEIGHT;
+	m_Width = m_TilesX * OCCLUSION_TILE_WIDTH;
+	m_Height = m_TilesY * OCCLUSION_TILE_HEIGHT;
+	m_TileBins.resize(m_TilesX * m_TilesY);
+
+	unsigned int levelWidth = m_Width, levelHeight = m_Height;
+	while (true)
+	{
+		m_Levels.push_back(std::vector<float>(levelWidth * levelHeight, 1.0f));
+		m_LevelWidths.push_back(levelWidth);
+		m_LevelHeights.push_back(levelHeight);
+		if (levelWidth == 1 && levelHeight == 1)
+			break;
+		levelWidth = (levelWidth + 1) / 2;
+		levelHeight = (levelHeight + 1) / 2;
+	}
+}
+
+void OcclusionCuller::BeginFrame(const Mat4& viewProjection)
+{
+	m_ViewProjection = viewProjection;
+	m_Triangles.clear();
+	for (std::vector<unsigned int>& bin : m_TileBins)
+		bin.clear();
+}
+
+void OcclusionCuller::AddOccluder(const Mat4& world, const float* positions, unsigned int stride, const unsigned int* indices, unsigned int indexCount)
+{
+	Mat4 mvp = m_ViewProjection * world;
+	for (unsigned int i = 0; i + 2 < indexCount; i += 3)
+	{
+		float x[3], y[3], z[3];
+		bool clipped = false;
+		for (int v = 0; v < 3; v++)
+		{
+			const float* p = positions + indices[i + v] * stride;
+			Vec4 clip = mvp * Vec4{ p[0], p[1], p[2], 1.0f };
+			// Occluders only ever hide things, so dropping triangles that cross the near plane is safe
+			if (clip.w < OCCLUSION_NEAR_W)
+			{
+				clipped = true;
+				break;
+			}
+			float inverseW = 1.0f / clip.w;
+			x[v] = (clip.x * inverseW * 0.5f + 0.5f) * m_Width;
+			y[v] = (clip.y * inverseW * 0.5f + 0.5f) * m_Height;
+			z[v] = clip.z * inverseW * 0.5f + 0.5f;
+		}
+		if (clipped)
+			continue;
+
+		// Both windings are rasterized, flip clockwise triangles so the edge functions are positive inside
+		float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if (area == 0.0f)
+			continue;
+		if (area < 0.0f)
+		{
+			std::swap(x[1], x[2]);
+			std::swap(y[1], y[2]);
+			std::swap(z[1], z[2]);
+			area = -area;
+		}
+
+		ScreenTriangle triangle;
+		triangle.MinX = std::max(0, (int)floorf(std::min(x[0], std::min(x[1], x[2]))));
+		triangle.MinY = std::max(0, (int)floorf(std::min(y[0], std::min(y[1], y[2]))));
+		triangle.MaxX = std::min((int)m_Width - 1, (int)ceilf(std::max(x[0], std::max(x[1], x[2]))));
+		triangle.MaxY = std::min((int)m_Height - 1, (int)ceilf(std::max(y[0], std::max(y[1], y[2]))));
+		if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+			continue;
+
+		for (int e = 0; e < 3; e++)
+		{
+			int a = e, b = (e + 1) % 3;
+			triangle.EdgeA[e] = y[a] - y[b];
+			triangle.EdgeB[e] = x[b] - x[a];
+			triangle.EdgeC[e] = x[a] * y[b] - y[a] * x[b];
+		}
+		triangle.DepthX = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+		triangle.DepthY = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+		triangle.Depth = z[0] - x[0] * triangle.DepthX - y[0] * triangle.DepthY;
+
+		unsigned int index = (unsigned int)m_Triangles.size();
+		m_Triangles.push_back(triangle);
+		for (int tileY = triangle.MinY / OCCLUSION_TILE_HEIGHT; tileY <= triangle.MaxY / OCCLUSION_TILE_HEIGHT; tileY++)
+		{
+			for (int tileX = triangle.MinX / OCCLUSION_TILE_WIDTH; tileX <= triangle.MaxX / OCCLUSION_TILE_WIDTH; tileX++)
+				m_TileBins[tileY * m_TilesX + tileX].push_back(index);
+		}
+	}
+}
+
+static void RasterizeRowScalar(float* row, int begin, int end, float py, const float* a, const float* b, const float* c,
+	float depth, float depthX, float depthY)
+{
+	for (int px = begin; px < end; px++)
+	{
+		float x = px + 0.5f;
+		if (a[0] * x + b[0] * py + c[0] >= 0.0f && a[1] * x + b[1] * py + c[1] >= 0.0f && a[2] * x + b[2] * py + c[2] >= 0.0f)
+			row[px] = std::min(row[px], depth + depthX * x + depthY * py);
+	}
+}
+
+#ifdef SIMD_X86
+static void RasterizeRowSSE(float* row, int begin, int end, float py, const float* a, const float* b, const float* c,
+	float depth, float depthX, float depthY)
+{
+	// Row constants of every edge and the depth plane, then 4 pixels per step along x
+	__m128 edgeRow[3], edgeStep[3];
+	for (int e = 0; e < 3; e++)
+	{
+		edgeRow[e] = _mm_set1_ps(b[e] * py + c[e]);
+		edgeStep[e] = _mm_set1_ps(a[e]);
+	}
+	__m128 depthRow = _mm_set1_ps(depth + depthY * py);
+	__m128 depthStep = _mm_set1_ps(depthX);
+	__m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	__m128 zero = _mm_setzero_ps();
+
+	for (int px = begin; px < end; px += 4)
+	{
+		__m128 x = _mm_add_ps(_mm_set1_ps((float)px), offsets);
+		__m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeStep[0], x), edgeRow[0]), zero);
+		inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeStep[1], x), edgeRow[1]), zero));
+		inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeStep[2], x), edgeRow[2]), zero));
+		if (_mm_movemask_ps(inside) == 0)
+			continue;
+
+		__m128 current = _mm_loadu_ps(row + px);
+		__m128 z = _mm_min_ps(current, _mm_add_ps(_mm_mul_ps(depthStep, x), depthRow));
+		_mm_storeu_ps(row + px, _mm_or_ps(_mm_and_ps(inside, z), _mm_andnot_ps(inside, current)));
+	}
+}
+
+SIMD_AVX2_FUNCTION static void RasterizeRowAVX2(float* row, int begin, int end, float py, const float* a, const float* b, const float* c,
+	float depth, float depthX, float depthY)
+{
+	__m256 edgeRow[3], edgeStep[3];
+	for (int e = 0; e < 3; e++)
+	{
+		edgeRow[e] = _mm256_set1_ps(b[e] * py + c[e]);
+		edgeStep[e] = _mm256_set1_ps(a[e]);
+	}
+	__m256 depthRow = _mm256_set1_ps(depth + depthY * py);
+	__m256 depthStep = _mm256_set1_ps(depthX);
+	__m256 offsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+	__m256 zero = _mm256_setzero_ps();
+
+	for (int px = begin; px < end; px += 8)
+	{
+		__m256 x = _mm256_add_ps(_mm256_set1_ps((float)px), offsets);
+		__m256 inside = _mm256_cmp_ps(_mm256_fmadd_ps(edgeStep[0], x, edgeRow[0]), zero, _CMP_GE_OQ);
+		inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_fmadd_ps(edgeStep[1], x, edgeRow[1]), zero, _CMP_GE_OQ));
+		inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_fmadd_ps(edgeStep[2], x, edgeRow[2]), zero, _CMP_GE_OQ));
+		if (_mm256_movemask_ps(inside) == 0)
+			continue;
+
+		__m256 current = _mm256_loadu_ps(row + px);
+		__m256 z = _mm256_min_ps(current, _mm256_fmadd_ps(depthStep, x, depthRow));
+		_mm256_storeu_ps(row + px, _mm256_blendv_ps(current, z, inside));
+	}
+}
+#endif
+
+void OcclusionCuller::RasterizeTile(unsigned int tile)
+{
+	int tileMinX = (tile % m_TilesX) * OCCLUSION_TILE_WIDTH;
+	int tileMinY = (tile / m_TilesX) * OCCLUSION_TILE_HEIGHT;
+	float* depth = m_Levels[0].data();
+	for (int y = tileMinY; y < tileMinY + OCCLUSION_TILE_HEIGHT; y++)
+		std::fill(depth + y * m_Width + tileMinX, depth + y * m_Width + tileMinX + OCCLUSION_TILE_WIDTH, 1.0f);
+
+	SimdLevel level = MathBatch::GetLevel();
+	for (unsigned int index : m_TileBins[tile])
+	{
+		const ScreenTriangle& t = m_Triangles[index];
+		int minY = std::max(t.MinY, tileMinY);
+		int maxY = std::min(t.MaxY, tileMinY + OCCLUSION_TILE_HEIGHT - 1);
+		// Spans start on a lane boundary and stay inside the tile, so whole groups are always in bounds
+		int begin = std::max(t.MinX, tileMinX) & ~7;
+		int end = std::min(t.MaxX + 1, tileMinX + OCCLUSION_TILE_WIDTH);
+		end = begin + ((end - begin + 7) & ~7);
+
+		for (int y = minY; y <= maxY; y++)
+		{
+			float* row = depth + y * m_Width;
+			float py = y + 0.5f;
+#ifdef SIMD_X86
+			if (level == SimdLevel::AVX2)
+			{
+				RasterizeRowAVX2(row, begin, end, py, t.EdgeA, t.EdgeB, t.EdgeC, t.Depth, t.DepthX, t.DepthY);
+				continue;
+			}
+			if (level == SimdLevel::SSE)
+			{
+				RasterizeRowSSE(row, begin, end, py, t.EdgeA, t.EdgeB, t.EdgeC, t.Depth, t.DepthX, t.DepthY);
+				continue;
+			}
+#endif
+			RasterizeRowScalar(row, begin, end, py, t.EdgeA, t.EdgeB, t.EdgeC, t.Depth, t.DepthX, t.DepthY);
+		}
+	}
+}
+
+void OcclusionCuller::BuildPyramid()
+{
+	for (size_t level = 1; level < m_Levels.size(); level++)
+	{
+		const std::vector<float>& source = m_Levels[level - 1];
+		std::vector<float>& target = m_Levels[level];
+		unsigned int sourceWidth = m_LevelWidths[level - 1], sourceHeight = m_LevelHeights[level - 1];
+		for (unsigned int y = 0; y < m_LevelHeights[level]; y++)
+		{
+			// Odd edges clamp onto the last row and column
+			unsigned int y0 = y * 2, y1 = std::min(y * 2 + 1, sourceHeight - 1);
+			for (unsigned int x = 0; x < m_LevelWidths[level]; x++)
+			{
+				unsigned int x0 = x * 2, x1 = std::min(x * 2 + 1, sourceWidth - 1);
+				target[y * m_LevelWidths[level] + x] = std::max(
+					std::max(source[y0 * sourceWidth + x0], source[y0 * sourceWidth + x1]),
+					std::max(source[y1 * sourceWidth + x0], source[y1 * sourceWidth + x1]));
+			}
+		}
+	}
+}
+
+void OcclusionCuller::Rasterize(ThreadPool* pool)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	unsigned int tileCount = m_TilesX * m_TilesY;
+	if (pool && !m_Triangles.empty())
+	{
+		// Tiles own disjoint pixels, so they need no synchronisation
+		pool->ParallelFor(tileCount, 4, [&](size_t begin, size_t end)
+		{
+			for (size_t tile = begin; tile < end; tile++)
+				RasterizeTile((unsigned int)tile);
+		});
+	}
+	else
+	{
+		for (unsigned int tile = 0; tile < tileCount; tile++)
+			RasterizeTile(tile);
+	}
+	BuildPyramid();
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	m_LastStats.Triangles = (unsigned int)m_Triangles.size();
+	m_LastStats.RasterMilliseconds = elapsed.count();
+}
+
+bool OcclusionCuller::IsVisible(const AABB& box) const
+{
+	// One full transform for the min corner, the others add the projected box edges
+	Vec3 size = box.Max - box.Min;
+	Vec4 origin = m_ViewProjection * Vec4{ box.Min.x, box.Min.y, box.Min.z, 1.0f };
+	Vec4 edgeX = m_ViewProjection.Column(0) * size.x;
+	Vec4 edgeY = m_ViewProjection.Column(1) * size.y;
+	Vec4 edgeZ = m_ViewProjection.Column(2) * size.z;
+
+	float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f, minDepth = 1.0f;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		Vec4 clip = origin;
+		if (corner & 1)
+			clip = clip + edgeX;
+		if (corner & 2)
+			clip = clip + edgeY;
+		if (corner & 4)
+			clip = clip + edgeZ;
+		// Boxes reaching the camera can't be proven hidden
+		if (clip.w < OCCLUSION_NEAR_W)
+			return true;
+		float inverseW = 1.0f / clip.w;
+		float x = (clip.x * inverseW * 0.5f + 0.5f) * m_Width;
+		float y = (clip.y * inverseW * 0.5f + 0.5f) * m_Height;
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		minDepth = std::min(minDepth, clip.z * inverseW * 0.5f + 0.5f);
+	}
+
+	// Off screen is the frustum culler's call
+	if (maxX < 0.0f || maxY < 0.0f || minX >= m_Width || minY >= m_Height)
+		return true;
+	int x0 = std::max(0, (int)minX), y0 = std::max(0, (int)minY);
+	int x1 = std::min((int)m_Width - 1, (int)maxX), y1 = std::min((int)m_Height - 1, (int)maxY);
+
+	// Coarsest level at which the rectangle covers no more than 2x2 texels
+	unsigned int level = 0;
+	while (level + 1 < m_Levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+		level++;
+
+	const std::vector<float>& depth = m_Levels[level];
+	unsigned int width = m_LevelWidths[level];
+	for (int y = y0 >> level; y <= y1 >> level; y++)
+	{
+		for (int x = x0 >> level; x <= x1 >> level; x++)
+		{
+			if (minDepth <= depth[y * width + x])
+				return true;
+		}
+	}
+	return false;
+}
+
+void OcclusionCuller::Cull(const AABB* bounds, std::vector<unsigned int>& visible, ThreadPool* pool)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	size_t count = visible.size();
+	m_Flags.resize(count);
+	if (pool && count > 1024)
+	{
+		pool->ParallelFor(count, 256, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+				m_Flags[i] = IsVisible(bounds[visible[i]]);
+		});
+	}
+	else
+	{
+		for (size_t i = 0; i < count; i++)
+			m_Flags[i] = IsVisible(bounds[visible[i]]);
+	}
+
+	size_t kept = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (m_Flags[i])
+			visible[kept++] = visible[i];
+	}
+	visible.resize(kept);
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	m_LastStats.Tested = (unsigned int)count;
+	m_LastStats.Occluded = (unsigned int)(count - kept);
+	m_LastStats.TestMilliseconds = elapsed.count();
+}
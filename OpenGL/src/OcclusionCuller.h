@@ -0,0 +1,76 @@
+#pragma once
+
+#include "VectorMath.h"
+#include "ThreadPool.h"
+
+#include<vector>
+
+// Screen tiles rasterized independently, widths stay a multiple of the AVX2 lane count
+#define OCCLUSION_TILE_WIDTH 32
+#define OCCLUSION_TILE_HEIGHT 16
+
+struct OcclusionCullStats
+{
+	unsigned int Triangles;
+	unsigned int Tested;
+	unsigned int Occluded;
+	double RasterMilliseconds;
+	double TestMilliseconds;
+};
+
+// Software occlusion culling: occluder triangles are rasterized into a small depth buffer on the CPU,
+// a max-depth pyramid over it lets object bounds be rejected with a handful of reads
+class OcclusionCuller
+{
+private:
+	// Edge functions and depth plane of a triangle after setup, in pixels
+	struct ScreenTriangle
+	{
+		float EdgeA[3];
+		float EdgeB[3];
+		float EdgeC[3];
+		float Depth;
+		float DepthX;
+		float DepthY;
+		int MinX, MinY, MaxX, MaxY;
+	};
+
+	unsigned int m_Width;
+	unsigned int m_Height;
+	unsigned int m_TilesX;
+	unsigned int m_TilesY;
+	Mat4 m_ViewProjection;
+	std::vector<ScreenTriangle> m_Triangles;
+	std::vector<std::vector<unsigned int>> m_TileBins;
+	// Level 0 is the depth buffer, each further level keeps the farthest depth of a 2x2 block
+	std::vector<std::vector<float>> m_Levels;
+	std::vector<unsigned int> m_LevelWidths;
+	std::vector<unsigned int> m_LevelHeights;
+	std::vector<unsigned char> m_Flags;
+	OcclusionCullStats m_LastStats;
+
+public:
+	// The resolution is rounded up to whole tiles
+	OcclusionCuller(unsigned int width = 256, unsigned int height = 128);
+
+	// Drops last frame's occluders, depth is [0, 1] with 1 the far plane
+	void BeginFrame(const Mat4& viewProjection);
+	// Indexed triangle list, positions are xyz with stride floats between vertices
+	void AddOccluder(const Mat4& world, const float* positions, unsigned int stride, const unsigned int* indices, unsigned int indexCount);
+	// Rasterizes the occluders tile by tile and builds the pyramid
+	void Rasterize(ThreadPool* pool = nullptr);
+
+	// Conservative, only returns false when the box is certainly hidden
+	bool IsVisible(const AABB& box) const;
+	// Removes occluded entries from visible, bounds is indexed by the entries
+	void Cull(const AABB* bounds, std::vector<unsigned int>& visible, ThreadPool* pool = nullptr);
+
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline const float* GetDepthBuffer() const { return m_Levels[0].data(); }
+	inline const OcclusionCullStats& GetLastStats() const { return m_LastStats; }
+
+private:
+	void RasterizeTile(unsigned int tile);
+	void BuildPyramid();
+};
@@ -0,0 +1,118 @@
+#include "PipelineState.h"
+#include "Debug.h"
+
+#include<cstring>
+#include<algorithm>
+
+static bool operator==(const BlendState& a, const BlendState& b)
+{
+	return a.Enabled == b.Enabled && a.Source == b.Source && a.Destination == b.Destination;
+}
+
+static bool SameLayout(const VertexBufferLayout& a, const VertexBufferLayout& b)
+{
+	std::vector<VertexBufferElement> elementsA = a.GetElements(), elementsB = b.GetElements();
+	if (a.GetStrinde() != b.GetStrinde() || elementsA.size() != elementsB.size())
+		return false;
+	for (size_t i = 0; i < elementsA.size(); i++)
+	{
+		if (elementsA[i].type != elementsB[i].type || elementsA[i].count != elementsB[i].count || elementsA[i].normalized != elementsB[i].normalized)
+			return false;
+	}
+	return true;
+}
+
+bool PipelineStateDesc::operator==(const PipelineStateDesc& other) const
+{
+	for (unsigned int i = 0; i < PIPELINE_BLEND_TARGETS; i++)
+	{
+		if (!(Blend[i] == other.Blend[i]))
+			return false;
+	}
+	return Program == other.Program && SameLayout(Layout, other.Layout)
+		&& Depth.Test == other.Depth.Test && Depth.Write == other.Depth.Write && Depth.Function == other.Depth.Function
+		&& Raster.CullFace == other.Raster.CullFace && Raster.DepthClamp == other.Raster.DepthClamp
+		&& Raster.DepthBiasSlope == other.Raster.DepthBiasSlope && Raster.DepthBiasConstant == other.Raster.DepthBiasConstant;
+}
+
+// FNV-1a over the values, fields are fed one by one so struct padding never enters the hash
+static void HashValue(size_t& hash, unsigned long long value)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		hash ^= (value >> (8 * i)) & 0xff;
+		hash *= (size_t)1099511628211ull;
+	}
+}
+
+static unsigned long long FloatBits(float value)
+{
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+size_t PipelineStateDesc::GetHash() const
+{
+	size_t hash = (size_t)14695981039346656037ull;
+	HashValue(hash, (unsigned long long)(size_t)Program);
+	HashValue(hash, Layout.GetStrinde());
+	for (const VertexBufferElement& element : Layout.GetElements())
+		HashValue(hash, ((unsigned long long)element.type << 32) | (element.count << 1) | element.normalized);
+	for (unsigned int i = 0; i < PIPELINE_BLEND_TARGETS; i++)
+		HashValue(hash, ((unsigned long long)Blend[i].Source << 33) | ((unsigned long long)Blend[i].Destination << 1) | Blend[i].Enabled);
+	HashValue(hash, ((unsigned long long)Depth.Function << 2) | (Depth.Test << 1) | Depth.Write);
+	HashValue(hash, ((unsigned long long)Raster.CullFace << 1) | Raster.DepthClamp);
+	HashValue(hash, (FloatBits(Raster.DepthBiasSlope) << 32) | FloatBits(Raster.DepthBiasConstant));
+	return hash;
+}
+
+PipelineState::PipelineState(const PipelineStateDesc& desc)
+	:m_Desc(desc), m_Hash(desc.GetHash())
+{
+}
+
+PipelineCache::PipelineCache()
+	:m_Count(0), m_Requests(0)
+{
+}
+
+const PipelineState& PipelineCache::Create(const PipelineStateDesc& desc)
+{
+	m_Requests++;
+	std::vector<Entry>& bucket = m_Pipelines[desc.GetHash()];
+	for (Entry& entry : bucket)
+	{
+		if (entry.Pipeline->GetDesc() == desc)
+		{
+			entry.References++;
+			return *entry.Pipeline;
+		}
+	}
+	bucket.push_back({ std::unique_ptr<PipelineState>(new PipelineState(desc)), 1 });
+	m_Count++;
+	return *bucket.back().Pipeline;
+}
+
+void PipelineCache::Release(const PipelineState& pipeline)
+{
+	auto bucket = m_Pipelines.find(pipeline.GetHash());
+	ASSERT(bucket != m_Pipelines.end());
+	if (bucket == m_Pipelines.end())
+		return;
+	std::vector<Entry>& entries = bucket->second;
+	auto entry = std::find_if(entries.begin(), entries.end(), [&](const Entry& e) { return e.Pipeline.get() == &pipeline; });
+	ASSERT(entry != entries.end());
+	if (entry == entries.end() || --entry->References > 0)
+		return;
+	entries.erase(entry);
+	m_Count--;
+	if (entries.empty())
+		m_Pipelines.erase(bucket);
+}
+
+PipelineCache& PipelineCache::Get()
+{
+	static PipelineCache cache;
+	return cache;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Shader.h"
+#include "VertexBufferLayout.h"
+#include "GL\glew.h"
+
+#include<vector>
+#include<unordered_map>
+#include<memory>
+
+// Color attachments with their own blend state, further attachments keep blending disabled
+#define PIPELINE_BLEND_TARGETS 2
+
+struct BlendState
+{
+	bool Enabled;
+	unsigned int Source;
+	unsigned int Destination;
+
+	static inline BlendState Disabled() { return{ false, GL_ONE, GL_ZERO }; }
+	static inline BlendState Additive() { return{ true, GL_ONE, GL_ONE }; }
+	static inline BlendState Premultiplied() { return{ true, GL_ONE, GL_ONE_MINUS_SRC_ALPHA }; }
+};
+
+// Depth test, depth writes and comparison function, set together so a pass never inherits another pass's depth setup
+struct DepthState
+{
+	bool Test;
+	bool Write;
+	unsigned int Function;
+
+	static inline DepthState Disabled() { return{ false, true, GL_LESS }; }
+};
+
+struct RasterState
+{
+	// GL_BACK, GL_FRONT or GL_NONE to draw both sides
+	unsigned int CullFace;
+	bool DepthClamp;
+	// glPolygonOffset, both 0 disables the offset
+	float DepthBiasSlope;
+	float DepthBiasConstant;
+
+	static inline RasterState Default() { return{ GL_NONE, false, 0.0f, 0.0f }; }
+};
+
+struct PipelineStateDesc
+{
+	// Must stay at this address until the pipeline is released, so pooled shaders are not allowed
+	Shader* Program;
+	// Vertex format the pipeline's vertex arrays are built with
+	VertexBufferLayout Layout;
+	BlendState Blend[PIPELINE_BLEND_TARGETS];
+	DepthState Depth;
+	RasterState Raster;
+
+	bool operator==(const PipelineStateDesc& other) const;
+	size_t GetHash() const;
+};
+
+// Shader, vertex format and fixed-function state bound as one. Created through PipelineCache, never modified.
+class PipelineState
+{
+private:
+	PipelineStateDesc m_Desc;
+	size_t m_Hash;
+
+public:
+	PipelineState(const PipelineStateDesc& desc);
+
+	inline const PipelineStateDesc& GetDesc() const { return m_Desc; }
+	inline size_t GetHash() const { return m_Hash; }
+	// Vertex arrays drawn with the pipeline must follow this layout
+	inline const VertexBufferLayout& GetLayout() const { return m_Desc.Layout; }
+};
+
+// Owns every pipeline, identical descriptions share one object so equal pipelines compare by address.
+// Pipelines are reference counted, each Create is paired with a Release by the owner of the shader.
+class PipelineCache
+{
+private:
+	struct Entry
+	{
+		std::unique_ptr<PipelineState> Pipeline;
+		unsigned int References;
+	};
+
+	std::unordered_map<size_t, std::vector<Entry>> m_Pipelines;
+	unsigned int m_Count;
+	unsigned int m_Requests;
+
+public:
+	PipelineCache();
+
+	// Create pipelines up front, lookups hash the whole description
+	const PipelineState& Create(const PipelineStateDesc& desc);
+	// Deletes the pipeline once every Create that returned it was released
+	void Release(const PipelineState& pipeline);
+
+	// Pipelines currently alive
+	inline unsigned int GetCount() const { return m_Count; }
+	// Create calls, including the ones answered by an existing pipeline
+	inline unsigned int GetRequestCount() const { return m_Requests; }
+
+	// Shared by the engine systems
+	static PipelineCache& Get();
+};
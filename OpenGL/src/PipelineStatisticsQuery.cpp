@@ -0,0 +1,59 @@
+#include "PipelineStatisticsQuery.h"
+#include "Renderer.h"
+#include "GL\glew.h"
+
+#include<utility>
+
+PipelineStatisticsQuery::PipelineStatisticsQuery(unsigned int target, unsigned int latency)
+	:m_Target(target), m_Queries(latency), m_LastValue(0), m_Total(0), m_Samples(0)
+{
+}
+
+PipelineStatisticsQuery::PipelineStatisticsQuery(PipelineStatisticsQuery&& other)
+	:m_Target(other.m_Target), m_Queries(std::move(other.m_Queries)), m_LastValue(other.m_LastValue), m_Total(other.m_Total),
+	m_Samples(other.m_Samples)
+{
+}
+
+PipelineStatisticsQuery& PipelineStatisticsQuery::operator=(PipelineStatisticsQuery&& other)
+{
+	std::swap(m_Target, other.m_Target);
+	std::swap(m_Queries, other.m_Queries);
+	std::swap(m_LastValue, other.m_LastValue);
+	std::swap(m_Total, other.m_Total);
+	std::swap(m_Samples, other.m_Samples);
+	return *this;
+}
+
+void PipelineStatisticsQuery::Begin()
+{
+	if (!IsSupported())
+		return;
+	Poll();
+	GLCall(glBeginQuery(m_Target, m_Queries.GetQuery()));
+}
+
+void PipelineStatisticsQuery::End()
+{
+	if (!IsSupported())
+		return;
+	GLCall(glEndQuery(m_Target));
+	m_Queries.Submit();
+}
+
+void PipelineStatisticsQuery::Poll()
+{
+	m_Queries.Poll([this](const unsigned int* queries)
+	{
+		GLuint64 value = 0;
+		GLCall(glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &value));
+		m_LastValue = value;
+		m_Total += value;
+		m_Samples++;
+	});
+}
+
+bool PipelineStatisticsQuery::IsSupported()
+{
+	return GLEW_ARB_pipeline_statistics_query != 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "QueryRing.h"
+
+// Counts one pipeline statistic (GL_ARB_pipeline_statistics_query) between Begin and End, such as
+// GL_FRAGMENT_SHADER_INVOCATIONS_ARB. Like GpuTimer, results are read a few frames later without stalling.
+// Queries of the same statistic may not nest.
+class PipelineStatisticsQuery
+{
+private:
+	unsigned int m_Target;
+	QueryRing m_Queries;
+	unsigned long long m_LastValue;
+	unsigned long long m_Total;
+	unsigned int m_Samples;
+
+public:
+	PipelineStatisticsQuery(unsigned int target, unsigned int latency = 4);
+	PipelineStatisticsQuery(const PipelineStatisticsQuery&) = delete;
+	PipelineStatisticsQuery& operator=(const PipelineStatisticsQuery&) = delete;
+	PipelineStatisticsQuery(PipelineStatisticsQuery&& other);
+	PipelineStatisticsQuery& operator=(PipelineStatisticsQuery&& other);
+
+	// Both do nothing without the extension
+	void Begin();
+	void End();
+	// Collects finished results, Begin does this as well
+	void Poll();
+
+	inline unsigned long long GetLastValue() const { return m_LastValue; }
+	// Sum and count of the results collected since ResetTotals
+	inline unsigned long long GetTotal() const { return m_Total; }
+	inline unsigned int GetSampleCount() const { return m_Samples; }
+	inline void ResetTotals() { m_Total = 0; m_Samples = 0; }
+
+	static bool IsSupported();
+};
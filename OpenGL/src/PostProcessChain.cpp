@@ -0,0 +1,162 @@
+#include "PostProcessChain.h"
+#include "Renderer.h"
+#include "GL\glew.h"
+
+#include<iostream>
+#include<iomanip>
+
+// Feature bits of Bloom.shader
+#define BLOOM_PREFILTER 1
+#define BLOOM_BLUR 2
+
+static const char* s_StageNames[POST_STAGE_COUNT] = { "bloom", "tone mapping", "fxaa" };
+
+PostProcessChain::PostProcessChain()
+	:m_BloomVariants("res/shaders/Bloom.shader", { "PREFILTER", "BLUR" }),
+	m_PrefilterShader(m_BloomVariants.Get(BLOOM_PREFILTER)), m_DownsampleShader(m_BloomVariants.Get(0)),
+	m_BlurShader(m_BloomVariants.Get(BLOOM_BLUR)),
+	m_TonemapShader("res/shaders/Tonemap.shader"),
+	m_FxaaShader("res/shaders/Fxaa.shader"),
+	m_Width(0), m_Height(0),
+	m_Settings({ true, 1.0f, 0.6f, true, 1.0f, true, 1.05f, 1.1f, { 1.0f, 0.98f, 0.95f }, true }),
+	m_ReportInterval(0), m_Frames(0)
+{
+}
+
+void PostProcessChain::AddPass(RenderGraph& graph, RenderGraphResource input, RenderGraphResource output)
+{
+	graph.AddPass("PostProcess", [&](RenderGraphBuilder& builder)
+	{
+		builder.Read(input);
+		builder.Write(output);
+	}, [this, input](RenderGraph& graph)
+	{
+		Execute(graph, graph.GetTexture(input));
+	});
+}
+
+void PostProcessChain::Resize(unsigned int width, unsigned int height)
+{
+	unsigned int halfWidth = width > 1 ? width / 2 : 1, halfHeight = height > 1 ? height / 2 : 1;
+	unsigned int quarterWidth = width > 3 ? width / 4 : 1, quarterHeight = height > 3 ? height / 4 : 1;
+	auto create = [](Target& target, unsigned int targetWidth, unsigned int targetHeight, unsigned int format)
+	{
+		target.Color.reset(new Texture(targetWidth, targetHeight, format));
+		target.Buffer.AttachColor(0, *target.Color);
+		target.Buffer.Validate();
+	};
+	create(m_BloomHalf, halfWidth, halfHeight, GL_RGBA16F);
+	create(m_BloomQuarter[0], quarterWidth, quarterHeight, GL_RGBA16F);
+	create(m_BloomQuarter[1], quarterWidth, quarterHeight, GL_RGBA16F);
+	create(m_Ldr, width, height, GL_RGBA8);
+	m_Width = width;
+	m_Height = height;
+}
+
+void PostProcessChain::Draw(Shader& shader, const Texture& source, const Target& destination)
+{
+	destination.Buffer.Bind();
+	source.Bind(0);
+	shader.Bind();
+	shader.SetUniform1i("u_Source", 0);
+	shader.SetUniform2f("u_SourceTexel", 1.0f / source.GetWidth(), 1.0f / source.GetHeight());
+	m_Fullscreen.Draw(shader);
+}
+
+void PostProcessChain::Execute(RenderGraph& graph, const Texture& input)
+{
+	if (input.GetWidth() != m_Width || input.GetHeight() != m_Height)
+		Resize(input.GetWidth(), input.GetHeight());
+
+	// Without bloom the scene stands in for the bloom texture and is weighted by 0
+	const Texture* bloom = &input;
+	if (m_Settings.Bloom)
+	{
+		GpuTimer& timer = m_Timers[(int)PostStage::BLOOM];
+		timer.Begin();
+		m_PrefilterShader.Bind();
+		m_PrefilterShader.SetUniform1f("u_Threshold", m_Settings.BloomThreshold);
+		Draw(m_PrefilterShader, input, m_BloomHalf);
+		Draw(m_DownsampleShader, *m_BloomHalf.Color, m_BloomQuarter[0]);
+		m_BloomHalf.Buffer.Invalidate();
+
+		const Texture& quarter = *m_BloomQuarter[0].Color;
+		m_BlurShader.Bind();
+		m_BlurShader.SetUniform2f("u_Direction", 1.0f / quarter.GetWidth(), 0.0f);
+		Draw(m_BlurShader, quarter, m_BloomQuarter[1]);
+		m_BloomQuarter[0].Buffer.Invalidate();
+		m_BlurShader.SetUniform2f("u_Direction", 0.0f, 1.0f / quarter.GetHeight());
+		Draw(m_BlurShader, *m_BloomQuarter[1].Color, m_BloomQuarter[0]);
+		m_BloomQuarter[1].Buffer.Invalidate();
+		timer.End();
+		bloom = &quarter;
+	}
+
+	{
+		GpuTimer& timer = m_Timers[(int)PostStage::TONE_MAPPING];
+		timer.Begin();
+		if (m_Settings.Fxaa)
+			m_Ldr.Buffer.Bind();
+		else
+			graph.BindPassTarget();
+		input.Bind(0);
+		bloom->Bind(1);
+		m_TonemapShader.Bind();
+		m_TonemapShader.SetUniform1i("u_Scene", 0);
+		m_TonemapShader.SetUniform1i("u_Bloom", 1);
+		m_TonemapShader.SetUniform1f("u_BloomIntensity", m_Settings.Bloom ? m_Settings.BloomIntensity : 0.0f);
+		m_TonemapShader.SetUniform1f("u_Exposure", m_Settings.Exposure);
+		m_TonemapShader.SetUniform1i("u_ToneMapping", m_Settings.ToneMapping);
+		m_TonemapShader.SetUniform1i("u_ColorGrading", m_Settings.ColorGrading);
+		m_TonemapShader.SetUniform1f("u_Contrast", m_Settings.Contrast);
+		m_TonemapShader.SetUniform1f("u_Saturation", m_Settings.Saturation);
+		m_TonemapShader.SetUniform3f("u_Tint", m_Settings.Tint[0], m_Settings.Tint[1], m_Settings.Tint[2]);
+		m_Fullscreen.Draw(m_TonemapShader);
+		timer.End();
+		if (m_Settings.Bloom)
+			m_BloomQuarter[0].Buffer.Invalidate();
+	}
+
+	if (m_Settings.Fxaa)
+	{
+		GpuTimer& timer = m_Timers[(int)PostStage::FXAA];
+		timer.Begin();
+		graph.BindPassTarget();
+		m_Ldr.Color->Bind(0);
+		m_FxaaShader.Bind();
+		m_FxaaShader.SetUniform1i("u_Source", 0);
+		m_FxaaShader.SetUniform2f("u_SourceTexel", 1.0f / m_Width, 1.0f / m_Height);
+		m_Fullscreen.Draw(m_FxaaShader);
+		timer.End();
+		m_Ldr.Buffer.Invalidate();
+	}
+
+	for (GpuTimer& timer : m_Timers)
+		timer.Poll();
+	if (m_ReportInterval > 0 && ++m_Frames >= m_ReportInterval)
+		Report();
+}
+
+void PostProcessChain::Report()
+{
+	std::cout << "[Post] " << std::fixed << std::setprecision(3);
+	double total = 0.0;
+	for (unsigned int i = 0; i < POST_STAGE_COUNT; i++)
+	{
+		GpuTimer& timer = m_Timers[i];
+		if (i > 0)
+			std::cout << " | ";
+		std::cout << s_StageNames[i] << ": ";
+		if (timer.GetSampleCount() == 0)
+		{
+			std::cout << "off";
+			continue;
+		}
+		double average = timer.GetTotalMilliseconds() / timer.GetSampleCount();
+		total += average;
+		std::cout << average << " ms";
+		timer.ResetTotals();
+	}
+	std::cout << " | total " << total << " ms" << std::defaultfloat << std::endl;
+	m_Frames = 0;
+}
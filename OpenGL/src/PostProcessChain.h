@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Shader.h"
+#include "ShaderVariantCache.h"
+#include "Texture.h"
+#include "FrameBuffer.h"
+#include "FullscreenTriangle.h"
+#include "GpuTimer.h"
+#include "RenderGraph.h"
+
+#include<memory>
+
+struct PostProcessSettings
+{
+	bool Bloom;
+	// Brightness where bloom starts, with a soft knee below it
+	float BloomThreshold;
+	float BloomIntensity;
+	// ACES when on, a plain clamp otherwise
+	bool ToneMapping;
+	float Exposure;
+	bool ColorGrading;
+	float Contrast;
+	float Saturation;
+	float Tint[3];
+	bool Fxaa;
+};
+
+enum class PostStage
+{
+	BLOOM = 0, TONE_MAPPING, FXAA
+};
+#define POST_STAGE_COUNT 3
+
+// HDR to display chain: bloom, tone mapping with color grading, FXAA. Bloom runs at half and quarter resolution
+// and ping-pongs between two quarter size targets, targets are invalidated as soon as their contents are consumed.
+// The last enabled stage renders straight into the graph's output.
+class PostProcessChain
+{
+private:
+	struct Target
+	{
+		std::unique_ptr<Texture> Color;
+		FrameBuffer Buffer;
+	};
+
+	// Bloom.shader variants: PREFILTER thresholds, BLUR runs one separable pass, neither only downsamples
+	ShaderVariantCache m_BloomVariants;
+	Shader& m_PrefilterShader;
+	Shader& m_DownsampleShader;
+	Shader& m_BlurShader;
+	Shader m_TonemapShader;
+	Shader m_FxaaShader;
+	FullscreenTriangle m_Fullscreen;
+	Target m_BloomHalf;
+	Target m_BloomQuarter[2];
+	Target m_Ldr;
+	unsigned int m_Width;
+	unsigned int m_Height;
+	PostProcessSettings m_Settings;
+	GpuTimer m_Timers[POST_STAGE_COUNT];
+	unsigned int m_ReportInterval;
+	unsigned int m_Frames;
+
+public:
+	PostProcessChain();
+
+	inline PostProcessSettings& GetSettings() { return m_Settings; }
+	inline const PostProcessSettings& GetSettings() const { return m_Settings; }
+	// Prints the average time of each stage every 'frames' frames, 0 disables reporting
+	inline void SetReportInterval(unsigned int frames) { m_ReportInterval = frames; }
+
+	// Adds a pass reading the HDR input and writing the output, which may be the backbuffer
+	void AddPass(RenderGraph& graph, RenderGraphResource input, RenderGraphResource output);
+
+	// Latest measurement of a stage, a few frames old
+	inline double GetMilliseconds(PostStage stage) const { return m_Timers[(int)stage].GetLastMilliseconds(); }
+
+private:
+	void Execute(RenderGraph& graph, const Texture& input);
+	void Resize(unsigned int width, unsigned int height);
+	void Draw(Shader& shader, const Texture& source, const Target& destination);
+	void Report();
+};
@@ -0,0 +1,59 @@
+#include "QueryRing.h"
+#include "Renderer.h"
+#include "DeletionQueue.h"
+#include "GL\glew.h"
+
+#include<utility>
+
+QueryRing::QueryRing(unsigned int slots, unsigned int queriesPerSlot)
+	:m_Queries((slots > 0 ? slots : 1) * queriesPerSlot), m_Pending(slots > 0 ? slots : 1, false),
+	m_QueriesPerSlot(queriesPerSlot), m_Slot(0)
+{
+	GLCall(glGenQueries((GLsizei)m_Queries.size(), m_Queries.data()));
+}
+
+QueryRing::~QueryRing()
+{
+	for (unsigned int query : m_Queries)
+		DeletionQueue::Enqueue(GLResourceType::QUERY, query);
+}
+
+QueryRing::QueryRing(QueryRing&& other)
+	:m_Queries(std::move(other.m_Queries)), m_Pending(std::move(other.m_Pending)), m_QueriesPerSlot(other.m_QueriesPerSlot),
+	m_Slot(other.m_Slot)
+{
+	other.m_Queries.clear();
+}
+
+QueryRing& QueryRing::operator=(QueryRing&& other)
+{
+	std::swap(m_Queries, other.m_Queries);
+	std::swap(m_Pending, other.m_Pending);
+	std::swap(m_QueriesPerSlot, other.m_QueriesPerSlot);
+	std::swap(m_Slot, other.m_Slot);
+	return *this;
+}
+
+void QueryRing::Submit()
+{
+	m_Pending[m_Slot] = true;
+	m_Slot = (m_Slot + 1) % m_Pending.size();
+}
+
+void QueryRing::Poll(const std::function<void(const unsigned int* queries)>& collect)
+{
+	// Oldest first, so the last result collected is also the most recent one
+	for (unsigned int i = 0; i < m_Pending.size(); i++)
+	{
+		unsigned int slot = (m_Slot + i) % m_Pending.size();
+		if (!m_Pending[slot])
+			continue;
+		const unsigned int* queries = &m_Queries[slot * m_QueriesPerSlot];
+		GLint available = 0;
+		GLCall(glGetQueryObjectiv(queries[m_QueriesPerSlot - 1], GL_QUERY_RESULT_AVAILABLE, &available));
+		if (!available)
+			continue;
+		m_Pending[slot] = false;
+		collect(queries);
+	}
+}
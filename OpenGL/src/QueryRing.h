@@ -0,0 +1,30 @@
+#pragma once
+
+#include<vector>
+#include<functional>
+
+// Ring of GL query objects read back a few frames late without stalling. Each slot holds 'queriesPerSlot'
+// queries issued together, a slot still waiting on the GPU when its turn comes again is reused and its result lost.
+class QueryRing
+{
+private:
+	std::vector<unsigned int> m_Queries;
+	std::vector<bool> m_Pending;
+	unsigned int m_QueriesPerSlot;
+	unsigned int m_Slot;
+
+public:
+	QueryRing(unsigned int slots, unsigned int queriesPerSlot = 1);
+	~QueryRing();
+	QueryRing(const QueryRing&) = delete;
+	QueryRing& operator=(const QueryRing&) = delete;
+	QueryRing(QueryRing&& other);
+	QueryRing& operator=(QueryRing&& other);
+
+	// Query 'index' of the slot being recorded
+	inline unsigned int GetQuery(unsigned int index = 0) const { return m_Queries[m_Slot * m_QueriesPerSlot + index]; }
+	// The current slot's queries were issued, the next slot is recorded from now on
+	void Submit();
+	// Hands the queries of every finished slot to 'collect', oldest first. A slot is finished once its last query is.
+	void Poll(const std::function<void(const unsigned int* queries)>& collect);
+};
@@ -0,0 +1,311 @@
+#include "RenderGraph.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "GL\glew.h"
+
+#include<iostream>
+#include<algorithm>
+
+RenderGraphBuilder::RenderGraphBuilder(RenderGraph& graph, unsigned int pass)
+	:m_Graph(graph), m_Pass(pass)
+{
+}
+
+RenderGraphResource RenderGraphBuilder::CreateTexture(const std::string& name, const RenderGraphTextureDesc& desc)
+{
+	RenderGraphResource resource = (RenderGraphResource)m_Graph.m_Resources.size();
+	m_Graph.m_Resources.push_back({ name, desc, false, RENDER_GRAPH_NONE, 0, 0, 0, RENDER_GRAPH_NONE });
+	return Write(resource);
+}
+
+RenderGraphResource RenderGraphBuilder::Read(RenderGraphResource resource)
+{
+	ASSERT(resource < m_Graph.m_Resources.size());
+	m_Graph.m_Passes[m_Pass].Reads.push_back(resource);
+	return resource;
+}
+
+RenderGraphResource RenderGraphBuilder::Write(RenderGraphResource resource)
+{
+	RenderGraph::ResourceNode& node = m_Graph.m_Resources[resource];
+	if (node.Imported)
+	{
+		m_Graph.m_Passes[m_Pass].SideEffect = true;
+	}
+	else
+	{
+		ASSERT(node.Producer == RENDER_GRAPH_NONE);
+		node.Producer = m_Pass;
+	}
+	m_Graph.m_Passes[m_Pass].Writes.push_back(resource);
+	return resource;
+}
+
+RenderGraphResource RenderGraphBuilder::ReadDepth(RenderGraphResource resource)
+{
+	ASSERT(!m_Graph.m_Resources[resource].Imported && Texture::IsDepthFormat(m_Graph.m_Resources[resource].Desc.Format));
+	m_Graph.m_Passes[m_Pass].DepthRead = resource;
+	return Read(resource);
+}
+
+void RenderGraphBuilder::SetSideEffect()
+{
+	m_Graph.m_Passes[m_Pass].SideEffect = true;
+}
+
+RenderGraph::RenderGraph()
+	:m_Compiled(false), m_Stats({ 0, 0, 0, 0, 0, 0 }), m_Backbuffer(RENDER_GRAPH_NONE), m_BackbufferWidth(0), m_BackbufferHeight(0),
+	m_CurrentPass(RENDER_GRAPH_NONE)
+{
+}
+
+void RenderGraph::Reset()
+{
+	m_Resources.clear();
+	m_Passes.clear();
+	m_Order.clear();
+	m_SlotDescs.clear();
+	m_Backbuffer = RENDER_GRAPH_NONE;
+	m_Compiled = false;
+}
+
+RenderGraphResource RenderGraph::ImportBackbuffer(unsigned int width, unsigned int height)
+{
+	m_Backbuffer = (RenderGraphResource)m_Resources.size();
+	m_BackbufferWidth = width;
+	m_BackbufferHeight = height;
+	m_Resources.push_back({ "Backbuffer", { width, height, GL_RGBA8 }, true, RENDER_GRAPH_NONE, 0, 0, 0, RENDER_GRAPH_NONE });
+	return m_Backbuffer;
+}
+
+void RenderGraph::AddPass(const std::string& name, const std::function<void(RenderGraphBuilder&)>& setup,
+	const std::function<void(RenderGraph&)>& execute)
+{
+	unsigned int pass = (unsigned int)m_Passes.size();
+	m_Passes.push_back({ name, {}, {}, RENDER_GRAPH_NONE, execute, 0, false, false });
+	RenderGraphBuilder builder(*this, pass);
+	setup(builder);
+}
+
+void RenderGraph::Compile()
+{
+	// Reference counts: passes count their outputs, resources count their readers. Both start over, so
+	// compiling the same recorded graph again gives the same result.
+	for (ResourceNode& resource : m_Resources)
+		resource.RefCount = 0;
+	for (PassNode& pass : m_Passes)
+	{
+		pass.RefCount = (unsigned int)pass.Writes.size() + (pass.SideEffect ? 1 : 0);
+		pass.Culled = false;
+		for (RenderGraphResource read : pass.Reads)
+			m_Resources[read].RefCount++;
+	}
+
+	// Unread resources release their producer, producers left without readers release their inputs
+	std::vector<RenderGraphResource> unused;
+	for (RenderGraphResource resource = 0; resource < m_Resources.size(); resource++)
+	{
+		if (m_Resources[resource].RefCount == 0 && !m_Resources[resource].Imported)
+			unused.push_back(resource);
+	}
+	while (!unused.empty())
+	{
+		const ResourceNode& resource = m_Resources[unused.back()];
+		unused.pop_back();
+		if (resource.Producer == RENDER_GRAPH_NONE)
+			continue;
+		PassNode& producer = m_Passes[resource.Producer];
+		if (--producer.RefCount > 0)
+			continue;
+		producer.Culled = true;
+		for (RenderGraphResource read : producer.Reads)
+		{
+			if (--m_Resources[read].RefCount == 0 && !m_Resources[read].Imported)
+				unused.push_back(read);
+		}
+	}
+
+	// Dependency order, ties keep the order passes were added in
+	std::vector<unsigned int> pending(m_Passes.size(), 0);
+	for (unsigned int p = 0; p < m_Passes.size(); p++)
+	{
+		if (m_Passes[p].Culled)
+			continue;
+		for (RenderGraphResource read : m_Passes[p].Reads)
+		{
+			if (m_Resources[read].Producer != RENDER_GRAPH_NONE)
+				pending[p]++;
+		}
+	}
+	m_Order.clear();
+	std::vector<bool> scheduled(m_Passes.size(), false);
+	while (true)
+	{
+		unsigned int next = RENDER_GRAPH_NONE;
+		for (unsigned int p = 0; p < m_Passes.size() && next == RENDER_GRAPH_NONE; p++)
+		{
+			if (!m_Passes[p].Culled && !scheduled[p] && pending[p] == 0)
+				next = p;
+		}
+		if (next == RENDER_GRAPH_NONE)
+			break;
+		scheduled[next] = true;
+		m_Order.push_back(next);
+		for (unsigned int p = 0; p < m_Passes.size(); p++)
+		{
+			if (m_Passes[p].Culled || scheduled[p])
+				continue;
+			for (RenderGraphResource read : m_Passes[p].Reads)
+			{
+				if (m_Resources[read].Producer == next)
+					pending[p]--;
+			}
+		}
+	}
+
+	// Lifetimes over the execution order
+	for (ResourceNode& resource : m_Resources)
+	{
+		resource.First = RENDER_GRAPH_NONE;
+		resource.Last = 0;
+		resource.Slot = RENDER_GRAPH_NONE;
+	}
+	for (unsigned int position = 0; position < m_Order.size(); position++)
+	{
+		const PassNode& pass = m_Passes[m_Order[position]];
+		for (RenderGraphResource resource : pass.Reads)
+			m_Resources[resource].Last = std::max(m_Resources[resource].Last, position);
+		for (RenderGraphResource resource : pass.Writes)
+		{
+			m_Resources[resource].First = std::min(m_Resources[resource].First, position);
+			m_Resources[resource].Last = std::max(m_Resources[resource].Last, position);
+		}
+	}
+
+	// Slots are handed out before a texture's first pass and returned after its last one,
+	// a freed slot serves any later texture with the same description
+	m_SlotDescs.clear();
+	std::vector<unsigned int> freeSlots;
+	m_Stats = { (unsigned int)m_Order.size(), (unsigned int)(m_Passes.size() - m_Order.size()), 0, 0, 0, 0 };
+	for (unsigned int position = 0; position < m_Order.size(); position++)
+	{
+		for (ResourceNode& resource : m_Resources)
+		{
+			if (resource.Imported || resource.First != position)
+				continue;
+			auto match = std::find_if(freeSlots.begin(), freeSlots.end(), [&](unsigned int slot) { return m_SlotDescs[slot] == resource.Desc; });
+			if (match != freeSlots.end())
+			{
+				resource.Slot = *match;
+				freeSlots.erase(match);
+			}
+			else
+			{
+				resource.Slot = (unsigned int)m_SlotDescs.size();
+				m_SlotDescs.push_back(resource.Desc);
+			}
+			m_Stats.Textures++;
+			m_Stats.UnaliasedMemory += Texture::GetByteSize(resource.Desc.Width, resource.Desc.Height, resource.Desc.Format);
+		}
+		for (const ResourceNode& resource : m_Resources)
+		{
+			if (!resource.Imported && resource.Slot != RENDER_GRAPH_NONE && resource.Last == position)
+				freeSlots.push_back(resource.Slot);
+		}
+	}
+	m_Stats.PhysicalTextures = (unsigned int)m_SlotDescs.size();
+	for (const RenderGraphTextureDesc& desc : m_SlotDescs)
+		m_Stats.Memory += Texture::GetByteSize(desc.Width, desc.Height, desc.Format);
+	m_Compiled = true;
+}
+
+void RenderGraph::Execute()
+{
+	if (!m_Compiled)
+		Compile();
+
+	if (m_Textures.size() < m_SlotDescs.size())
+		m_Textures.resize(m_SlotDescs.size());
+	for (unsigned int slot = 0; slot < m_SlotDescs.size(); slot++)
+	{
+		const RenderGraphTextureDesc& desc = m_SlotDescs[slot];
+		std::unique_ptr<Texture>& texture = m_Textures[slot];
+		if (texture && texture->GetWidth() == desc.Width && texture->GetHeight() == desc.Height && texture->GetFormat() == desc.Format)
+			continue;
+		// Framebuffers may reference the texture being replaced
+		texture.reset(new Texture(desc.Width, desc.Height, desc.Format));
+		m_FrameBuffers.clear();
+	}
+
+	for (unsigned int p : m_Order)
+	{
+		// Every pass starts from the default state and leaves whatever it set behind
+		m_CurrentPass = p;
+		GLStateCache::Reset();
+		BindPassTarget();
+		m_Passes[p].Execute(*this);
+	}
+	m_CurrentPass = RENDER_GRAPH_NONE;
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void RenderGraph::BindPassTarget()
+{
+	ASSERT(m_CurrentPass != RENDER_GRAPH_NONE);
+	const PassNode& pass = m_Passes[m_CurrentPass];
+	bool toBackbuffer = std::find(pass.Writes.begin(), pass.Writes.end(), m_Backbuffer) != pass.Writes.end();
+	if (toBackbuffer)
+	{
+		GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+		GLCall(glViewport(0, 0, m_BackbufferWidth, m_BackbufferHeight));
+	}
+	else if (!pass.Writes.empty())
+	{
+		GetFrameBuffer(pass).Bind();
+	}
+}
+
+FrameBuffer& RenderGraph::GetFrameBuffer(const PassNode& pass)
+{
+	// Keyed by the attached textures, so passes writing the same storage share one framebuffer
+	std::vector<unsigned int> key;
+	for (RenderGraphResource resource : pass.Writes)
+		key.push_back(m_Textures[m_Resources[resource].Slot]->GetRendererID());
+	if (pass.DepthRead != RENDER_GRAPH_NONE)
+		key.push_back(m_Textures[m_Resources[pass.DepthRead].Slot]->GetRendererID());
+
+	std::unique_ptr<FrameBuffer>& frameBuffer = m_FrameBuffers[key];
+	if (!frameBuffer)
+	{
+		frameBuffer.reset(new FrameBuffer());
+		unsigned int colorIndex = 0;
+		for (RenderGraphResource resource : pass.Writes)
+		{
+			const Texture& texture = *m_Textures[m_Resources[resource].Slot];
+			if (Texture::IsDepthFormat(texture.GetFormat()))
+				frameBuffer->AttachDepth(texture);
+			else
+				frameBuffer->AttachColor(colorIndex++, texture);
+		}
+		if (pass.DepthRead != RENDER_GRAPH_NONE)
+			frameBuffer->AttachDepth(*m_Textures[m_Resources[pass.DepthRead].Slot]);
+		frameBuffer->Validate();
+	}
+	return *frameBuffer;
+}
+
+const Texture& RenderGraph::GetTexture(RenderGraphResource resource) const
+{
+	ASSERT(!m_Resources[resource].Imported && m_Resources[resource].Slot != RENDER_GRAPH_NONE);
+	return *m_Textures[m_Resources[resource].Slot];
+}
+
+void RenderGraph::PrintSummary() const
+{
+	std::cout << "[RenderGraph] " << m_Stats.Passes << " passes (" << m_Stats.CulledPasses << " culled):";
+	for (unsigned int p : m_Order)
+		std::cout << " " << m_Passes[p].Name;
+	std::cout << std::endl;
+	std::cout << "[RenderGraph] " << m_Stats.Textures << " transient textures in " << m_Stats.PhysicalTextures
+		<< " allocations, " << m_Stats.Memory / 1024 << " KB aliased vs " << m_Stats.UnaliasedMemory / 1024 << " KB unaliased" << std::endl;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "Texture.h"
+#include "FrameBuffer.h"
+
+#include<string>
+#include<vector>
+#include<map>
+#include<memory>
+#include<functional>
+
+typedef unsigned int RenderGraphResource;
+#define RENDER_GRAPH_NONE 0xffffffff
+
+struct RenderGraphTextureDesc
+{
+	unsigned int Width;
+	unsigned int Height;
+	unsigned int Format;
+
+	inline bool operator==(const RenderGraphTextureDesc& other) const
+	{
+		return Width == other.Width && Height == other.Height && Format == other.Format;
+	}
+};
+
+struct RenderGraphStats
+{
+	unsigned int Passes;
+	unsigned int CulledPasses;
+	unsigned int Textures;
+	unsigned int PhysicalTextures;
+	// Render target memory with textures shared between non-overlapping lifetimes, and with one texture each
+	unsigned long long Memory;
+	unsigned long long UnaliasedMemory;
+};
+
+class RenderGraph;
+
+// Handed to a pass's setup function to declare what it reads and writes
+class RenderGraphBuilder
+{
+private:
+	RenderGraph& m_Graph;
+	unsigned int m_Pass;
+
+public:
+	RenderGraphBuilder(RenderGraph& graph, unsigned int pass);
+
+	// A transient texture written by this pass, its memory comes from the graph's pool
+	RenderGraphResource CreateTexture(const std::string& name, const RenderGraphTextureDesc& desc);
+	RenderGraphResource Read(RenderGraphResource resource);
+	// Only imported resources may be written by more than one pass
+	RenderGraphResource Write(RenderGraphResource resource);
+	// Reads a depth texture by attaching it to the pass's framebuffer, for depth testing without writes
+	RenderGraphResource ReadDepth(RenderGraphResource resource);
+	// Keeps the pass even when nothing reads its outputs
+	void SetSideEffect();
+};
+
+// Frame built from passes that declare their resources. Compile culls passes whose outputs are never used,
+// orders the rest by their dependencies and lets transient textures with disjoint lifetimes share storage.
+// Rebuild it every frame with Reset, the textures and framebuffers are kept between frames.
+class RenderGraph
+{
+private:
+	friend class RenderGraphBuilder;
+
+	struct ResourceNode
+	{
+		std::string Name;
+		RenderGraphTextureDesc Desc;
+		bool Imported;
+		unsigned int Producer;
+		unsigned int RefCount;
+		// Execution order positions of the first and last use
+		unsigned int First;
+		unsigned int Last;
+		unsigned int Slot;
+	};
+
+	struct PassNode
+	{
+		std::string Name;
+		std::vector<RenderGraphResource> Reads;
+		std::vector<RenderGraphResource> Writes;
+		RenderGraphResource DepthRead;
+		std::function<void(RenderGraph&)> Execute;
+		unsigned int RefCount;
+		bool SideEffect;
+		bool Culled;
+	};
+
+	std::vector<ResourceNode> m_Resources;
+	std::vector<PassNode> m_Passes;
+	std::vector<unsigned int> m_Order;
+	std::vector<RenderGraphTextureDesc> m_SlotDescs;
+	bool m_Compiled;
+	RenderGraphStats m_Stats;
+
+	// Physical storage of the slots, kept across frames and recreated when a slot's description changes
+	std::vector<std::unique_ptr<Texture>> m_Textures;
+	std::map<std::vector<unsigned int>, std::unique_ptr<FrameBuffer>> m_FrameBuffers;
+	RenderGraphResource m_Backbuffer;
+	unsigned int m_BackbufferWidth;
+	unsigned int m_BackbufferHeight;
+	unsigned int m_CurrentPass;
+
+public:
+	RenderGraph();
+
+	// Drops passes and resources, keeps the texture pool
+	void Reset();
+
+	// The default framebuffer, passes writing it are never culled
+	RenderGraphResource ImportBackbuffer(unsigned int width, unsigned int height);
+	void AddPass(const std::string& name, const std::function<void(RenderGraphBuilder&)>& setup,
+		const std::function<void(RenderGraph&)>& execute);
+
+	// Needs no GL context, so pipelines can be inspected offline
+	void Compile();
+	// Binds each pass's outputs as the draw framebuffer before calling it
+	void Execute();
+
+	inline const RenderGraphTextureDesc& GetDesc(RenderGraphResource resource) const { return m_Resources[resource].Desc; }
+	// Valid while executing
+	const Texture& GetTexture(RenderGraphResource resource) const;
+	// Binds the executing pass's outputs again, for passes that render through framebuffers of their own
+	void BindPassTarget();
+	inline const RenderGraphStats& GetStats() const { return m_Stats; }
+	void PrintSummary() const;
+
+private:
+	FrameBuffer& GetFrameBuffer(const PassNode& pass);
+};
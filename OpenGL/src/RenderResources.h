@@ -0,0 +1,22 @@
+#pragma once
+
+#include "ResourcePool.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+
+typedef ResourceHandle<VertexBuffer> VertexBufferHandle;
+typedef ResourceHandle<IndexBuffer> IndexBufferHandle;
+typedef ResourceHandle<VertexArray> VertexArrayHandle;
+typedef ResourceHandle<Shader> ShaderHandle;
+
+// GL objects owned by the renderer, draw data refers to them by handle.
+// Destroy before the GL context goes away.
+struct RenderResources
+{
+	ResourcePool<VertexBuffer> VertexBuffers;
+	ResourcePool<IndexBuffer> IndexBuffers;
+	ResourcePool<VertexArray> VertexArrays;
+	ResourcePool<Shader> Shaders;
+};
@@ -1,4 +1,5 @@
 #include "Renderer.h"
+#include "GLStateCache.h"
 
 #include <GL/glew.h>
 #include<iostream>
@@ -21,4 +22,28 @@ bool GLCallLog(const char* function, const char* file, int line)
 	{
 		return true;
 	}
+}
+
+void Renderer::Clear() const
+{
+	GLCall(glClear(GL_COLOR_BUFFER_BIT));
+}
+
+void Renderer::ClearDepth() const
+{
+	GLCall(glClear(GL_DEPTH_BUFFER_BIT));
+}
+
+void Renderer::SetDepthState(const DepthState& state) const
+{
+	GLStateCache::SetDepthState(state);
+}
+
+void Renderer::Draw(const VertexArray& vArray, const IndexBuffer& iBuffer, const Shader& shader) const
+{
+	shader.Bind();
+	vArray.Bind();
+	iBuffer.Bind();
+	GLCall(glDrawElements(GL_TRIANGLES, iBuffer.GetCount(), GL_UNSIGNED_INT, nullptr));
+	GLStats::RecordDraw(GL_TRIANGLES, iBuffer.GetCount());
 }
\ No newline at end of file
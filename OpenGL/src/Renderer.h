@@ -1,11 +1,27 @@
 #pragma once
 
-// Compiler dependent assertion macro
-#define ASSERT(x) if(!(x)) __debugbreak();
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "GLStats.h"
+#include "PipelineState.h"
+#include "Debug.h"
 
 #define GLCall(x)	GLClearError();\
 					x;\
+					GLStats::RecordCall(#x);\
 					ASSERT(GLCallLog(#x, __FILE__, __LINE__))
 
 void GLClearError();
-bool GLCallLog(const char* function, const char* file, int line);
\ No newline at end of file
+bool GLCallLog(const char* function, const char* file, int line);
+
+class Renderer
+{
+public:
+	void Clear() const;
+	// Clears to the far plane, needs depth writes enabled
+	void ClearDepth() const;
+	// Through GLStateCache, only what differs is changed
+	void SetDepthState(const DepthState& state) const;
+	void Draw(const VertexArray& vArray, const IndexBuffer& iBuffer, const Shader& shader) const;
+};
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Debug.h"
+
+#include<vector>
+#include<utility>
+
+// 32-bit handle: low 20 bits index a pool slot, high 12 bits hold the slot's generation.
+// Generations start at 1 so a zero handle is never valid.
+#define RESOURCE_INDEX_BITS 20
+#define RESOURCE_INDEX_MASK ((1u << RESOURCE_INDEX_BITS) - 1)
+#define RESOURCE_GENERATION_MASK ((1u << (32 - RESOURCE_INDEX_BITS)) - 1)
+
+template<typename T>
+struct ResourceHandle
+{
+	unsigned int Value;
+
+	inline unsigned int GetIndex() const { return Value & RESOURCE_INDEX_MASK; }
+	inline unsigned int GetGeneration() const { return Value >> RESOURCE_INDEX_BITS; }
+	inline bool IsNull() const { return Value == 0; }
+	inline bool operator==(const ResourceHandle& other) const { return Value == other.Value; }
+	inline bool operator!=(const ResourceHandle& other) const { return Value != other.Value; }
+};
+
+// Resources stored densely in one array, handles go through a slot table so destroying one
+// moves the last resource into the hole without invalidating any other handle.
+// Pointers returned by Get are invalidated by Create and Destroy.
+template<typename T>
+class ResourcePool
+{
+private:
+	struct Slot
+	{
+		// Dense index for live slots, next free slot otherwise
+		unsigned int Index;
+		unsigned int Generation;
+	};
+
+	std::vector<T> m_Resources;
+	std::vector<unsigned int> m_DenseToSlot;
+	std::vector<Slot> m_Slots;
+	unsigned int m_FreeList;
+
+public:
+	ResourcePool()
+		:m_FreeList(RESOURCE_INDEX_MASK)
+	{
+	}
+
+	ResourcePool(const ResourcePool&) = delete;
+	ResourcePool& operator=(const ResourcePool&) = delete;
+
+	// Constructs the resource in place, returns a null handle once every slot index is taken
+	template<typename... Args>
+	ResourceHandle<T> Create(Args&&... args)
+	{
+		unsigned int slot = m_FreeList;
+		if (slot == RESOURCE_INDEX_MASK)
+		{
+			// The largest index is the free list's end marker, so it is never handed out
+			slot = (unsigned int)m_Slots.size();
+			ASSERT(slot < RESOURCE_INDEX_MASK);
+			if (slot >= RESOURCE_INDEX_MASK)
+				return{ 0 };
+			m_Slots.push_back({ 0, 1 });
+		}
+		else
+		{
+			m_FreeList = m_Slots[slot].Index;
+		}
+
+		m_Slots[slot].Index = (unsigned int)m_Resources.size();
+		m_Resources.emplace_back(std::forward<Args>(args)...);
+		m_DenseToSlot.push_back(slot);
+		return{ (m_Slots[slot].Generation << RESOURCE_INDEX_BITS) | slot };
+	}
+
+	// Stale handles are ignored
+	void Destroy(ResourceHandle<T> handle)
+	{
+		if (!IsValid(handle))
+			return;
+
+		unsigned int slot = handle.GetIndex();
+		unsigned int dense = m_Slots[slot].Index;
+		unsigned int last = (unsigned int)m_Resources.size() - 1;
+		if (dense != last)
+		{
+			m_Resources[dense] = std::move(m_Resources[last]);
+			m_DenseToSlot[dense] = m_DenseToSlot[last];
+			m_Slots[m_DenseToSlot[dense]].Index = dense;
+		}
+		m_Resources.pop_back();
+		m_DenseToSlot.pop_back();
+
+		// Wraps past the largest generation back to 1
+		m_Slots[slot].Generation = (m_Slots[slot].Generation % RESOURCE_GENERATION_MASK) + 1;
+		m_Slots[slot].Index = m_FreeList;
+		m_FreeList = slot;
+	}
+
+	inline bool IsValid(ResourceHandle<T> handle) const
+	{
+		unsigned int slot = handle.GetIndex();
+		return !handle.IsNull() && slot < m_Slots.size() && m_Slots[slot].Generation == handle.GetGeneration();
+	}
+
+	// Null for stale handles
+	inline T* Get(ResourceHandle<T> handle) { return IsValid(handle) ? &m_Resources[m_Slots[handle.GetIndex()].Index] : nullptr; }
+	inline const T* Get(ResourceHandle<T> handle) const { return IsValid(handle) ? &m_Resources[m_Slots[handle.GetIndex()].Index] : nullptr; }
+
+	inline unsigned int GetCount() const { return (unsigned int)m_Resources.size(); }
+	inline typename std::vector<T>::iterator begin() { return m_Resources.begin(); }
+	inline typename std::vector<T>::iterator end() { return m_Resources.end(); }
+};
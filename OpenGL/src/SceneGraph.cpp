@@ -0,0 +1,249 @@
+#include "SceneGraph.h"
+#include "Debug.h"
+
+#define SLOT_NONE 0xFFFFFFFF
+#define PARALLEL_GRAIN 1024
+
+SceneGraph::SceneGraph()
+	:m_StructureChanged(false), m_LastUpdateCount(0)
+{
+}
+
+SceneNodeID SceneGraph::CreateNode(SceneNodeID parent, const Vec3& position, const Quat& rotation, const Vec3& scale)
+{
+	SceneNodeID node;
+	if (!m_FreeNodes.empty())
+	{
+		node = m_FreeNodes.back();
+		m_FreeNodes.pop_back();
+	}
+	else
+	{
+		node = (SceneNodeID)m_SlotOfNode.size();
+		m_SlotOfNode.push_back(SLOT_NONE);
+		m_ParentOfNode.push_back(SCENE_NODE_NONE);
+	}
+
+	// Appended out of order, the next Update sorts everything by depth again
+	unsigned int slot = (unsigned int)m_NodeOfSlot.size();
+	m_SlotOfNode[node] = slot;
+	m_ParentOfNode[node] = parent;
+	m_NodeOfSlot.push_back(node);
+	m_ParentSlot.push_back(SLOT_NONE);
+	m_FirstChild.push_back(0);
+	m_ChildCount.push_back(0);
+	m_Positions.push_back(position);
+	m_Rotations.push_back(rotation);
+	m_Scales.push_back(scale);
+	m_WorldMatrices.push_back(Mat4::Identity());
+	m_Queued.push_back(0);
+	m_Depth.push_back(0);
+	m_StructureChanged = true;
+	return node;
+}
+
+void SceneGraph::DestroyNode(SceneNodeID node)
+{
+	ASSERT(node < m_SlotOfNode.size() && m_SlotOfNode[node] != SLOT_NONE);
+	if (node >= m_SlotOfNode.size() || m_SlotOfNode[node] == SLOT_NONE)
+		return;
+
+	// The child ranges are only valid in sorted order, after that the subtree costs its own size
+	if (m_StructureChanged)
+		Rebuild();
+	std::vector<SceneNodeID> doomed(1, node);
+	for (size_t i = 0; i < doomed.size(); i++)
+	{
+		unsigned int slot = m_SlotOfNode[doomed[i]];
+		unsigned int end = m_FirstChild[slot] + m_ChildCount[slot];
+		for (unsigned int child = m_FirstChild[slot]; child < end; child++)
+			doomed.push_back(m_NodeOfSlot[child]);
+	}
+
+	// Swap-remove the slots, the order is restored by the rebuild
+	for (SceneNodeID dead : doomed)
+	{
+		unsigned int slot = m_SlotOfNode[dead];
+		unsigned int last = (unsigned int)m_NodeOfSlot.size() - 1;
+		SceneNodeID moved = m_NodeOfSlot[last];
+		m_NodeOfSlot[slot] = moved;
+		m_Positions[slot] = m_Positions[last];
+		m_Rotations[slot] = m_Rotations[last];
+		m_Scales[slot] = m_Scales[last];
+		m_SlotOfNode[moved] = slot;
+
+		m_NodeOfSlot.pop_back();
+		m_ParentSlot.pop_back();
+		m_FirstChild.pop_back();
+		m_ChildCount.pop_back();
+		m_Positions.pop_back();
+		m_Rotations.pop_back();
+		m_Scales.pop_back();
+		m_WorldMatrices.pop_back();
+		m_Queued.pop_back();
+		m_Depth.pop_back();
+
+		m_SlotOfNode[dead] = SLOT_NONE;
+		m_ParentOfNode[dead] = SCENE_NODE_NONE;
+		m_FreeNodes.push_back(dead);
+	}
+	m_StructureChanged = true;
+}
+
+void SceneGraph::SetLocalTransform(SceneNodeID node, const Vec3& position, const Quat& rotation, const Vec3& scale)
+{
+	unsigned int slot = m_SlotOfNode[node];
+	m_Positions[slot] = position;
+	m_Rotations[slot] = rotation;
+	m_Scales[slot] = scale;
+	MarkDirty(slot);
+}
+
+void SceneGraph::SetPosition(SceneNodeID node, const Vec3& position)
+{
+	unsigned int slot = m_SlotOfNode[node];
+	m_Positions[slot] = position;
+	MarkDirty(slot);
+}
+
+void SceneGraph::SetRotation(SceneNodeID node, const Quat& rotation)
+{
+	unsigned int slot = m_SlotOfNode[node];
+	m_Rotations[slot] = rotation;
+	MarkDirty(slot);
+}
+
+void SceneGraph::MarkDirty(unsigned int slot)
+{
+	// Everything is recomputed after a structural change anyway
+	if (m_StructureChanged || m_Queued[slot])
+		return;
+	m_Queued[slot] = 1;
+	m_DirtyByLevel[m_Depth[slot]].push_back(slot);
+}
+
+void SceneGraph::Update(ThreadPool* pool)
+{
+	if (m_StructureChanged)
+		Rebuild();
+
+	m_LastUpdateCount = 0;
+	for (unsigned int level = 0; level < m_DirtyByLevel.size(); level++)
+	{
+		std::vector<unsigned int>& dirty = m_DirtyByLevel[level];
+		if (dirty.empty())
+			continue;
+
+		// Nodes of one level only read their parents' matrices, which are final by now
+		auto updateRange = [this, &dirty](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				unsigned int slot = dirty[i];
+				Mat4 local = Mat4::FromTRS(m_Positions[slot], m_Rotations[slot], m_Scales[slot]);
+				unsigned int parent = m_ParentSlot[slot];
+				if (parent == SLOT_NONE)
+					m_WorldMatrices[slot] = local;
+				else
+					MathBatch::MultiplyMatrices(m_WorldMatrices[parent], &local, &m_WorldMatrices[slot], 1);
+			}
+		};
+		if (pool && dirty.size() > PARALLEL_GRAIN)
+			pool->ParallelFor(dirty.size(), PARALLEL_GRAIN, updateRange);
+		else
+			updateRange(0, dirty.size());
+
+		// Children of updated nodes are the next level's work
+		for (unsigned int slot : dirty)
+		{
+			m_Queued[slot] = 0;
+			unsigned int end = m_FirstChild[slot] + m_ChildCount[slot];
+			for (unsigned int child = m_FirstChild[slot]; child < end; child++)
+			{
+				if (!m_Queued[child])
+				{
+					m_Queued[child] = 1;
+					m_DirtyByLevel[level + 1].push_back(child);
+				}
+			}
+		}
+		m_LastUpdateCount += (unsigned int)dirty.size();
+		dirty.clear();
+	}
+}
+
+void SceneGraph::Rebuild()
+{
+	const unsigned int count = (unsigned int)m_NodeOfSlot.size();
+
+	// Children of every node, bucketed by parent id
+	std::vector<unsigned int> childStart(m_SlotOfNode.size() + 1, 0);
+	std::vector<SceneNodeID> roots;
+	for (SceneNodeID node : m_NodeOfSlot)
+	{
+		if (m_ParentOfNode[node] == SCENE_NODE_NONE)
+			roots.push_back(node);
+		else
+			childStart[m_ParentOfNode[node] + 1]++;
+	}
+	for (size_t i = 1; i < childStart.size(); i++)
+		childStart[i] += childStart[i - 1];
+	std::vector<SceneNodeID> children(count - roots.size());
+	std::vector<unsigned int> fill(childStart.begin(), childStart.end() - 1);
+	for (SceneNodeID node : m_NodeOfSlot)
+	{
+		if (m_ParentOfNode[node] != SCENE_NODE_NONE)
+			children[fill[m_ParentOfNode[node]]++] = node;
+	}
+
+	// Breadth-first order keeps each depth and each sibling group contiguous
+	std::vector<SceneNodeID> order(roots);
+	order.reserve(count);
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		SceneNodeID node = order[i];
+		order.insert(order.end(), children.begin() + childStart[node], children.begin() + childStart[node + 1]);
+	}
+
+	std::vector<Vec3> positions(count), scales(count);
+	std::vector<Quat> rotations(count);
+	std::vector<unsigned int> oldSlot(count);
+	for (unsigned int slot = 0; slot < count; slot++)
+	{
+		oldSlot[slot] = m_SlotOfNode[order[slot]];
+		positions[slot] = m_Positions[oldSlot[slot]];
+		rotations[slot] = m_Rotations[oldSlot[slot]];
+		scales[slot] = m_Scales[oldSlot[slot]];
+	}
+	m_Positions.swap(positions);
+	m_Rotations.swap(rotations);
+	m_Scales.swap(scales);
+	m_NodeOfSlot = order;
+	for (unsigned int slot = 0; slot < count; slot++)
+		m_SlotOfNode[order[slot]] = slot;
+
+	m_DirtyByLevel.clear();
+	m_DirtyByLevel.resize(1);
+	unsigned int nextChild = (unsigned int)roots.size();
+	for (unsigned int slot = 0; slot < count; slot++)
+	{
+		SceneNodeID node = order[slot];
+		SceneNodeID parent = m_ParentOfNode[node];
+		m_ParentSlot[slot] = parent == SCENE_NODE_NONE ? SLOT_NONE : m_SlotOfNode[parent];
+		m_Depth[slot] = parent == SCENE_NODE_NONE ? 0 : m_Depth[m_ParentSlot[slot]] + 1;
+		m_FirstChild[slot] = nextChild;
+		m_ChildCount[slot] = childStart[node + 1] - childStart[node];
+		nextChild += m_ChildCount[slot];
+		m_Queued[slot] = 0;
+		if (m_Depth[slot] + 1u >= m_DirtyByLevel.size())
+			m_DirtyByLevel.resize(m_Depth[slot] + 2);
+	}
+
+	// Roots seed a full update, which then reaches every node
+	for (unsigned int slot = 0; slot < roots.size(); slot++)
+	{
+		m_Queued[slot] = 1;
+		m_DirtyByLevel[0].push_back(slot);
+	}
+	m_StructureChanged = false;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "VectorMath.h"
+#include "ThreadPool.h"
+
+#include<vector>
+
+typedef unsigned int SceneNodeID;
+#define SCENE_NODE_NONE 0xFFFFFFFF
+
+// Transform hierarchy stored as SoA arrays sorted by depth. Siblings are contiguous and parents
+// always come before their children, so world matrices are updated level by level touching only
+// dirty nodes and their descendants, and every level can be split across threads.
+class SceneGraph
+{
+private:
+	// Stable node ids map to slots in the sorted arrays
+	std::vector<unsigned int> m_SlotOfNode;
+	std::vector<SceneNodeID> m_ParentOfNode;
+	std::vector<SceneNodeID> m_FreeNodes;
+	bool m_StructureChanged;
+
+	// Indexed by slot
+	std::vector<SceneNodeID> m_NodeOfSlot;
+	std::vector<unsigned int> m_ParentSlot;
+	std::vector<unsigned int> m_FirstChild;
+	std::vector<unsigned int> m_ChildCount;
+	std::vector<Vec3> m_Positions;
+	std::vector<Quat> m_Rotations;
+	std::vector<Vec3> m_Scales;
+	std::vector<Mat4> m_WorldMatrices;
+	std::vector<unsigned char> m_Queued;
+
+	// Slots waiting for a world matrix update, one list per depth
+	std::vector<std::vector<unsigned int>> m_DirtyByLevel;
+	std::vector<unsigned int> m_Depth;
+	unsigned int m_LastUpdateCount;
+
+public:
+	SceneGraph();
+
+	SceneNodeID CreateNode(SceneNodeID parent, const Vec3& position = { 0.0f, 0.0f, 0.0f },
+		const Quat& rotation = Quat::Identity(), const Vec3& scale = { 1.0f, 1.0f, 1.0f });
+	// Destroys the node together with its whole subtree. Re-sorts first if the structure changed since the last Update.
+	void DestroyNode(SceneNodeID node);
+
+	void SetLocalTransform(SceneNodeID node, const Vec3& position, const Quat& rotation, const Vec3& scale);
+	void SetPosition(SceneNodeID node, const Vec3& position);
+	void SetRotation(SceneNodeID node, const Quat& rotation);
+
+	inline const Mat4& GetWorldMatrix(SceneNodeID node) const { return m_WorldMatrices[m_SlotOfNode[node]]; }
+	inline SceneNodeID GetParent(SceneNodeID node) const { return m_ParentOfNode[node]; }
+	inline unsigned int GetNodeCount() const { return (unsigned int)m_NodeOfSlot.size(); }
+
+	// World matrices in slot order, GetNodeOfSlot maps them back to nodes
+	inline const std::vector<Mat4>& GetWorldMatrices() const { return m_WorldMatrices; }
+	inline SceneNodeID GetNodeOfSlot(unsigned int slot) const { return m_NodeOfSlot[slot]; }
+
+	// Recomputes world matrices of dirty subtrees, pool may be null to stay on this thread
+	void Update(ThreadPool* pool = nullptr);
+	// Nodes whose world matrix was recomputed by the last Update
+	inline unsigned int GetLastUpdateCount() const { return m_LastUpdateCount; }
+
+private:
+	void MarkDirty(unsigned int slot);
+	void Rebuild();
+};
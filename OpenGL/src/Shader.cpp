@@ -1,71 +1,303 @@
 #include "Shader.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "DeletionQueue.h"
+#include "FileWatcher.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderParser.h"
 
 #include<iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <mutex>
+#include <cstring>
 
 #include <GL/glew.h>
 
+// Stages are compiled straight from the file buffer unless they need preprocessing
 struct ShaderProgramSources
 {
-	std::string VertexSource;
-	std::string FragmentSource;
+	ShaderFile File;
+	bool Preprocessed[SHADER_STAGE_COUNT];
+	std::string Sources[SHADER_STAGE_COUNT];
 };
 
-static ShaderProgramSources ParseShader(const std::string& filePath)
+static ShaderProgramSources ParseShader(const std::string& filePath, const std::vector<std::string>& defines,
+	std::vector<std::string>* dependencies = nullptr)
 {
-	enum class ShaderType
+	ShaderProgramSources sources;
+	sources.File = ShaderParser::ParseFile(filePath);
+	for (const std::string& error : sources.File.Errors)
+		std::cout << "[Shader] " << error << std::endl;
+
+	std::string directory = ShaderPreprocessor::GetDirectory(filePath);
+	for (int i = 0; i < SHADER_STAGE_COUNT; i++)
+	{
+		const ShaderStageSource& stage = sources.File.Stages[i];
+		const char* data = sources.File.GetData((ShaderStage)i);
+		sources.Preprocessed[i] = stage.Present && ShaderPreprocessor::NeedsProcessing(data, stage.Size, defines);
+		if (sources.Preprocessed[i])
+			sources.Sources[i] = ShaderPreprocessor::Process(std::string(data, stage.Size), directory, defines, dependencies, stage.FirstLine);
+	}
+	return sources;
+}
+
+static void SetShaderSource(unsigned int shaderId, const ShaderProgramSources& sources, int stage)
+{
+	if (sources.Preprocessed[stage])
+	{
+		const char* data = sources.Sources[stage].c_str();
+		int length = (int)sources.Sources[stage].size();
+		GLCall(glShaderSource(shaderId, 1, &data, &length));
+		return;
+	}
+
+	// Split around the #version line to restore file line numbers without copying the stage
+	const ShaderStageSource& source = sources.File.Stages[stage];
+	const char* data = sources.File.GetData((ShaderStage)stage);
+	std::string lineDirective = "#line " + std::to_string(source.FirstLine) + "\n";
+	size_t split = 0;
+	const char* version = strstr(data, "#version");
+	if (version && (size_t)(version - data) < source.Size)
 	{
-		NONE = -1, VERTEX = 0, FRAGMENT = 1
+		const char* lineEnd = (const char*)memchr(version, '\n', source.Size - (version - data));
+		split = lineEnd ? (size_t)(lineEnd - data) + 1 : source.Size;
+		unsigned int versionLine = source.FirstLine;
+		for (const char* ptr = data; ptr < data + split - 1; ptr++)
+			versionLine += *ptr == '\n';
+		lineDirective = "#line " + std::to_string(versionLine + 1) + "\n";
+	}
+
+	const char* strings[] = { data, lineDirective.c_str(), data + split };
+	int lengths[] = { (int)split, (int)lineDirective.size(), (int)(source.Size - split) };
+	GLCall(glShaderSource(shaderId, 3, strings, lengths));
+}
+
+struct ShaderReloadState
+{
+	std::vector<int> WatchIDs;
+	std::mutex Mutex;
+	bool HasPendingSources = false;
+	ShaderProgramSources PendingSources;
+
+	// Program currently being compiled and linked, 0 when idle
+	unsigned int Program = 0;
+	std::vector<unsigned int> StageShaders;
+};
+
+static FileWatcher& GetShaderWatcher()
+{
+	static FileWatcher watcher;
+	return watcher;
+}
+
+Shader::Shader(const std::string& filePath)
+	:Shader(filePath, {})
+{
+}
+
+Shader::Shader(const std::string& filePath, const std::vector<std::string>& defines)
+	:m_FilePath(filePath), m_Defines(defines), m_RendererID(0)
+{
+	ShaderProgramSources src = ParseShader(filePath, m_Defines, &m_Dependencies);
+	m_RendererID = CreateShader(src);
+}
+
+Shader::~Shader()
+{
+	if (m_Reload)
+	{
+		for (int watchID : m_Reload->WatchIDs)
+			GetShaderWatcher().Unwatch(watchID);
+		if (m_Reload->Program != 0)
+		{
+			for (unsigned int stageShader : m_Reload->StageShaders)
+				DeletionQueue::Enqueue(GLResourceType::SHADER, stageShader);
+			DeletionQueue::Enqueue(GLResourceType::PROGRAM, m_Reload->Program);
+		}
+	}
+	DeletionQueue::Enqueue(GLResourceType::PROGRAM, m_RendererID);
+}
+
+// Reload state lives on the heap and the watcher callbacks only point at it, so it moves with the shader
+Shader::Shader(Shader&& other)
+	:m_FilePath(std::move(other.m_FilePath)), m_Defines(std::move(other.m_Defines)), m_Dependencies(std::move(other.m_Dependencies)),
+	m_RendererID(other.m_RendererID), m_UniformLocationCache(std::move(other.m_UniformLocationCache)), m_Reload(std::move(other.m_Reload))
+{
+	other.m_RendererID = 0;
+}
+
+// The previous program goes with other and is deleted when it is destroyed
+Shader& Shader::operator=(Shader&& other)
+{
+	std::swap(m_FilePath, other.m_FilePath);
+	std::swap(m_Defines, other.m_Defines);
+	std::swap(m_Dependencies, other.m_Dependencies);
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_UniformLocationCache, other.m_UniformLocationCache);
+	std::swap(m_Reload, other.m_Reload);
+	return *this;
+}
+
+void Shader::Bind() const
+{
+	GLStateCache::UseProgram(m_RendererID);
+}
+
+void Shader::UnBind() const
+{
+	GLStateCache::UseProgram(0);
+}
+
+void Shader::EnableHotReload()
+{
+	if (m_Reload)
+		return;
+
+	if (GLEW_KHR_parallel_shader_compile)
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+	else if (GLEW_ARB_parallel_shader_compile)
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+
+	m_Reload.reset(new ShaderReloadState());
+	ShaderReloadState* state = m_Reload.get();
+
+	// Runs on the watcher thread, the render thread only picks up the parsed sources.
+	// Included files are watched too, new includes are only picked up on restart.
+	std::string filePath = m_FilePath;
+	std::vector<std::string> defines = m_Defines;
+	auto reparse = [state, filePath, defines](const std::string&)
+	{
+		ShaderProgramSources sources = ParseShader(filePath, defines);
+		std::lock_guard<std::mutex> lock(state->Mutex);
+		state->PendingSources = std::move(sources);
+		state->HasPendingSources = true;
 	};
+	state->WatchIDs.push_back(GetShaderWatcher().Watch(m_FilePath, reparse));
+	for (const std::string& dependency : m_Dependencies)
+		state->WatchIDs.push_back(GetShaderWatcher().Watch(dependency, reparse));
+}
+
+bool Shader::PollHotReload()
+{
+	if (!m_Reload)
+		return false;
 
-	std::ifstream stream(filePath);
-	std::string line;
-	std::stringstream ss[2];
-	ShaderType type = ShaderType::NONE;
+	if (m_Reload->Program != 0)
+		return FinishReload();
 
-	while (getline(stream, line)) {
-		if (line.find("#shader") != std::string::npos)
+	ShaderProgramSources sources;
+	{
+		std::unique_lock<std::mutex> lock(m_Reload->Mutex, std::try_to_lock);
+		if (!lock.owns_lock() || !m_Reload->HasPendingSources)
+			return false;
+		sources = std::move(m_Reload->PendingSources);
+		m_Reload->HasPendingSources = false;
+	}
+
+	if (!sources.File.Errors.empty())
+	{
+		std::cout << "Failed to reload shader " << m_FilePath << ", keeping the previous program" << std::endl;
+		return false;
+	}
+
+	// Status is not queried here so drivers with parallel compilation never stall the frame
+	GLCall(m_Reload->Program = glCreateProgram());
+	for (int i = 0; i < SHADER_STAGE_COUNT; i++)
+	{
+		if (!sources.File.Stages[i].Present)
+			continue;
+		GLCall(unsigned int stageShader = glCreateShader(ShaderParser::GetGLType((ShaderStage)i)));
+		SetShaderSource(stageShader, sources, i);
+		GLCall(glCompileShader(stageShader));
+		GLCall(glAttachShader(m_Reload->Program, stageShader));
+		m_Reload->StageShaders.push_back(stageShader);
+	}
+	GLCall(glLinkProgram(m_Reload->Program));
+
+	return FinishReload();
+}
+
+bool Shader::FinishReload()
+{
+	unsigned int program = m_Reload->Program;
+	if (GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile)
+	{
+		int completed;
+		GLCall(glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &completed));
+		if (completed == GL_FALSE)
+			return false;
+	}
+
+	int linked;
+	GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+	if (linked == GL_FALSE)
+	{
+		// Keep the current program, only report what went wrong
+		std::cout << "Failed to reload shader " << m_FilePath << ", keeping the previous program" << std::endl;
+		for (unsigned int stage : m_Reload->StageShaders)
 		{
-			if (line.find("vertex") != std::string::npos)
-			{
-				type = ShaderType::VERTEX;
-			}
-			else if (line.find("fragment") != std::string::npos)
+			int compiled;
+			GLCall(glGetShaderiv(stage, GL_COMPILE_STATUS, &compiled));
+			if (compiled == GL_FALSE)
 			{
-				type = ShaderType::FRAGMENT;
+				char message[1024];
+				GLCall(glGetShaderInfoLog(stage, sizeof(message), nullptr, message));
+				std::cout << message << std::endl;
 			}
 		}
-		else
-		{
-			ss[(int)type] << line << '\n';
-		}
+		char message[1024];
+		GLCall(glGetProgramInfoLog(program, sizeof(message), nullptr, message));
+		std::cout << message << std::endl;
+		GLCall(glDeleteProgram(program));
 	}
-	return{ ss[0].str(), ss[1].str() };
+	else
+	{
+		DeletionQueue::Enqueue(GLResourceType::PROGRAM, m_RendererID);
+		m_RendererID = program;
+		m_UniformLocationCache.clear();
+		std::cout << "Reloaded shader " << m_FilePath << std::endl;
+	}
+
+	for (unsigned int stageShader : m_Reload->StageShaders)
+	{
+		GLCall(glDeleteShader(stageShader));
+	}
+	m_Reload->StageShaders.clear();
+	m_Reload->Program = 0;
+	return linked != GL_FALSE;
 }
 
-Shader::Shader(const std::string& filePath)
-	:m_FilePath(filePath), m_RendererID(0)
+void Shader::Dispatch(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) const
 {
-	ShaderProgramSources src = ParseShader(filePath);
-	m_RendererID = CreateShader(src.VertexSource, src.FragmentSource);
+	Bind();
+	GLCall(glDispatchCompute(groupsX, groupsY, groupsZ));
 }
 
-Shader::~Shader()
+void Shader::SetUniform1i(const std::string& name, const int value)
 {
-	GLCall(glDeleteProgram(m_RendererID));
+	GLCall(glUniform1i(GetUniformLocation(name), value));
 }
 
-void Shader::Bind()
+void Shader::SetUniform1ui(const std::string& name, const unsigned int value)
 {
-	GLCall(glUseProgram(m_RendererID));
+	GLCall(glUniform1ui(GetUniformLocation(name), value));
 }
 
-void Shader::UnBind()
+void Shader::SetUniform1f(const std::string& name, const float value)
 {
-	GLCall(glUseProgram(0));
+	GLCall(glUniform1f(GetUniformLocation(name), value));
+}
+
+void Shader::SetUniform2f(const std::string& name, const float v1, const float v2)
+{
+	GLCall(glUniform2f(GetUniformLocation(name), v1, v2));
+}
+
+void Shader::SetUniform3f(const std::string& name, const float v1, const float v2, const float v3)
+{
+	GLCall(glUniform3f(GetUniformLocation(name), v1, v2, v3));
 }
 
 void Shader::SetUniform4f(const std::string& name, const float v1, const float v2, const float v3, const float v4)
@@ -73,6 +305,21 @@ void Shader::SetUniform4f(const std::string& name, const float v1, const float v
 	GLCall(glUniform4f(GetUniformLocation(name), v1, v2, v3, v4));
 }
 
+void Shader::SetUniform4fv(const std::string& name, const float* values, unsigned int count)
+{
+	GLCall(glUniform4fv(GetUniformLocation(name), count, values));
+}
+
+void Shader::SetUniformMat4f(const std::string& name, const float* matrix)
+{
+	GLCall(glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, matrix));
+}
+
+void Shader::SetUniformMat4fv(const std::string& name, const float* matrices, unsigned int count)
+{
+	GLCall(glUniformMatrix4fv(GetUniformLocation(name), count, GL_FALSE, matrices));
+}
+
 int Shader::GetUniformLocation(const std::string& name)
 {
 	if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
@@ -85,11 +332,10 @@ int Shader::GetUniformLocation(const std::string& name)
 	return uniformLocation;
 }
 
-unsigned int Shader::CompileShader(unsigned int type, std::string &source)
+unsigned int Shader::CompileShader(unsigned int type, const ShaderProgramSources& sources, int stage)
 {
 	unsigned int shaderId = glCreateShader(type);
-	const char* src = source.c_str();
-	glShaderSource(shaderId, 1, &src, nullptr);
+	SetShaderSource(shaderId, sources, stage);
 	glCompileShader(shaderId);
 
 	// Error handling
@@ -101,7 +347,7 @@ unsigned int Shader::CompileShader(unsigned int type, std::string &source)
 		glGetShaderiv(shaderId, GL_INFO_LOG_LENGTH, &length);
 		char* message = (char*)alloca(length * sizeof(char));
 		glGetShaderInfoLog(shaderId, length, &length, message);
-		std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader!" << std::endl;
+		std::cout << "Failed to compile " << ShaderParser::GetStageName((ShaderStage)stage) << " shader!" << std::endl;
 		std::cout << message << std::endl;
 		glDeleteShader(shaderId);
 		return 0;
@@ -110,17 +356,38 @@ unsigned int Shader::CompileShader(unsigned int type, std::string &source)
 	return shaderId;
 }
 
-unsigned int Shader::CreateShader(std::string &vertexShader, std::string &fragmentShader)
+unsigned int Shader::CreateShader(const ShaderProgramSources& sources)
 {
 	unsigned int program = glCreateProgram();
-	unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
-
-	glAttachShader(program, vs);
-	glAttachShader(program, fs);
+	std::vector<unsigned int> stageShaders;
+	for (int i = 0; i < SHADER_STAGE_COUNT; i++)
+	{
+		if (!sources.File.Stages[i].Present)
+			continue;
+		unsigned int stageShader = CompileShader(ShaderParser::GetGLType((ShaderStage)i), sources, i);
+		glAttachShader(program, stageShader);
+		stageShaders.push_back(stageShader);
+	}
 
 	glLinkProgram(program);
 	glValidateProgram(program);
 
+	int result;
+	glGetProgramiv(program, GL_LINK_STATUS, &result);
+	if (result == GL_FALSE)
+	{
+		char message[1024];
+		glGetProgramInfoLog(program, sizeof(message), nullptr, message);
+		std::cout << "Failed to link " << m_FilePath << "!" << std::endl;
+		std::cout << message << std::endl;
+	}
+
+	// The linked program keeps the binaries, stage objects are no longer needed
+	for (unsigned int stageShader : stageShaders)
+	{
+		glDetachShader(program, stageShader);
+		glDeleteShader(stageShader);
+	}
+
 	return program;
 }
\ No newline at end of file
@@ -1,26 +1,58 @@
 #pragma once
 #include<iostream>
 #include<unordered_map>
+#include<vector>
+#include<memory>
+
+struct ShaderReloadState;
+struct ShaderProgramSources;
 
 class Shader
 {
 private:
 	std::string m_FilePath;
+	std::vector<std::string> m_Defines;
+	std::vector<std::string> m_Dependencies;
 	unsigned int m_RendererID;
 	std::unordered_map<std::string, int> m_UniformLocationCache;
+	std::unique_ptr<ShaderReloadState> m_Reload;
 
 public:
 	Shader(const std::string& filePath);
+	// Each define is "NAME" or "NAME VALUE" and is injected after the #version line of every stage
+	Shader(const std::string& filePath, const std::vector<std::string>& defines);
 	~Shader();
-	void Bind();
-	void UnBind();
+	// Owns the GL object: movable, never copied
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+	Shader(Shader&& other);
+	Shader& operator=(Shader&& other);
+	void Bind() const;
+	void UnBind() const;
+
+	// Hot reload: the file is reparsed in the background when it changes and the new
+	// program replaces the current one only once it links, uniforms must be set again after a swap
+	void EnableHotReload();
+	bool PollHotReload();
+
+	// Compute programs only, runs the bound program over the given work groups
+	void Dispatch(unsigned int groupsX, unsigned int groupsY = 1, unsigned int groupsZ = 1) const;
 
 	// Set uniforms
+	void SetUniform1i(const std::string& name, const int value);
+	void SetUniform1ui(const std::string& name, const unsigned int value);
+	void SetUniform1f(const std::string& name, const float value);
+	void SetUniform2f(const std::string& name, const float v1, const float v2);
+	void SetUniform3f(const std::string& name, const float v1, const float v2, const float v3);
 	void SetUniform4f(const std::string& name, const float v1, const float v2, const float v3, const float v4);
+	void SetUniform4fv(const std::string& name, const float* values, unsigned int count);
+	// Column-major 4x4 matrix
+	void SetUniformMat4f(const std::string& name, const float* matrix);
+	void SetUniformMat4fv(const std::string& name, const float* matrices, unsigned int count);
 
 private:
 	int GetUniformLocation(const std::string& name);
-	unsigned int CompileShader(unsigned int type, std::string &source);
-	unsigned int CreateShader(std::string &vertexShader, std::string &fragmentShader);
-};
-
+	unsigned int CompileShader(unsigned int type, const ShaderProgramSources& sources, int stage);
+	unsigned int CreateShader(const ShaderProgramSources& sources);
+	bool FinishReload();
+};
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "ShaderParser.h"
+
+#include <fstream>
+#include <cstring>
+
+#include <GL/glew.h>
+
+static const char* s_StageNames[SHADER_STAGE_COUNT] = {
+	"vertex", "fragment", "geometry", "tess_control", "tess_evaluation", "compute"
+};
+
+ShaderFile ShaderParser::ParseFile(const std::string& filePath)
+{
+	ShaderFile file;
+	std::ifstream stream(filePath, std::ios::binary | std::ios::ate);
+	if (!stream)
+	{
+		memset(file.Stages, 0, sizeof(file.Stages));
+		file.Errors.push_back(filePath + ": failed to open file");
+		return file;
+	}
+
+	std::streamoff size = stream.tellg();
+	stream.seekg(0, std::ios::beg);
+	file.Buffer.resize((size_t)size);
+	stream.read(&file.Buffer[0], size);
+
+	Parse(file, filePath);
+	return file;
+}
+
+void ShaderParser::Parse(ShaderFile& file, const std::string& fileName)
+{
+	memset(file.Stages, 0, sizeof(file.Stages));
+
+	const char* data = file.Buffer.data();
+	const size_t size = file.Buffer.size();
+	ShaderStageSource* current = nullptr;
+	bool skipping = false;
+	unsigned int lineNumber = 0;
+
+	for (size_t lineStart = 0; lineStart < size; )
+	{
+		lineNumber++;
+		const char* lineEnd = (const char*)memchr(data + lineStart, '\n', size - lineStart);
+		size_t next = lineEnd ? (size_t)(lineEnd - data) + 1 : size;
+		size_t end = lineEnd ? (size_t)(lineEnd - data) : size;
+
+		size_t first = lineStart;
+		while (first < end && (data[first] == ' ' || data[first] == '\t' || data[first] == '\r'))
+			first++;
+
+		if (end - first >= 7 && memcmp(data + first, "#shader", 7) == 0)
+		{
+			size_t nameStart = first + 7;
+			while (nameStart < end && (data[nameStart] == ' ' || data[nameStart] == '\t'))
+				nameStart++;
+			size_t nameEnd = nameStart;
+			while (nameEnd < end && data[nameEnd] != ' ' && data[nameEnd] != '\t' && data[nameEnd] != '\r')
+				nameEnd++;
+
+			if (current)
+				current->Size = lineStart - current->Offset;
+			current = nullptr;
+
+			ShaderStageSource* stageSource = nullptr;
+			for (int stage = 0; stage < SHADER_STAGE_COUNT; stage++)
+			{
+				if (strlen(s_StageNames[stage]) == nameEnd - nameStart && memcmp(data + nameStart, s_StageNames[stage], nameEnd - nameStart) == 0)
+					stageSource = &file.Stages[stage];
+			}
+
+			// The block of a bad marker is skipped rather than reported line by line
+			std::string name(data + nameStart, nameEnd - nameStart);
+			skipping = true;
+			if (!stageSource)
+			{
+				file.Errors.push_back(fileName + ":" + std::to_string(lineNumber) + ": unknown shader stage '" + name + "'");
+			}
+			else if (stageSource->Present)
+			{
+				file.Errors.push_back(fileName + ":" + std::to_string(lineNumber) + ": duplicate " + name + " stage");
+			}
+			else
+			{
+				*stageSource = { true, next, 0, lineNumber + 1 };
+				current = stageSource;
+				skipping = false;
+			}
+		}
+		else if (!current && !skipping && first < end && !(end - first >= 2 && data[first] == '/' && data[first + 1] == '/'))
+		{
+			file.Errors.push_back(fileName + ":" + std::to_string(lineNumber) + ": text outside of a #shader block");
+		}
+
+		lineStart = next;
+	}
+
+	if (current)
+		current->Size = size - current->Offset;
+}
+
+unsigned int ShaderParser::GetGLType(ShaderStage stage)
+{
+	switch (stage)
+	{
+	case ShaderStage::VERTEX: return GL_VERTEX_SHADER;
+	case ShaderStage::FRAGMENT: return GL_FRAGMENT_SHADER;
+	case ShaderStage::GEOMETRY: return GL_GEOMETRY_SHADER;
+	case ShaderStage::TESS_CONTROL: return GL_TESS_CONTROL_SHADER;
+	case ShaderStage::TESS_EVALUATION: return GL_TESS_EVALUATION_SHADER;
+	case ShaderStage::COMPUTE: return GL_COMPUTE_SHADER;
+	}
+	return 0;
+}
+
+const char* ShaderParser::GetStageName(ShaderStage stage)
+{
+	return s_StageNames[(int)stage];
+}
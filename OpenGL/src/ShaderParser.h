@@ -0,0 +1,42 @@
+#pragma once
+
+#include<string>
+#include<vector>
+
+enum class ShaderStage
+{
+	VERTEX = 0, FRAGMENT, GEOMETRY, TESS_CONTROL, TESS_EVALUATION, COMPUTE
+};
+
+#define SHADER_STAGE_COUNT 6
+
+// A stage is a range of the file buffer, FirstLine is the file line its source starts on
+struct ShaderStageSource
+{
+	bool Present;
+	size_t Offset;
+	size_t Size;
+	unsigned int FirstLine;
+};
+
+struct ShaderFile
+{
+	std::string Buffer;
+	ShaderStageSource Stages[SHADER_STAGE_COUNT];
+	std::vector<std::string> Errors;
+
+	inline const ShaderStageSource& GetStage(ShaderStage stage) const { return Stages[(int)stage]; }
+	inline const char* GetData(ShaderStage stage) const { return Buffer.data() + Stages[(int)stage].Offset; }
+};
+
+// Splits a .shader file into stages on "#shader <stage>" lines without copying the sources
+class ShaderParser
+{
+public:
+	// Reads the whole file with a single read before splitting it
+	static ShaderFile ParseFile(const std::string& filePath);
+	static void Parse(ShaderFile& file, const std::string& fileName);
+
+	static unsigned int GetGLType(ShaderStage stage);
+	static const char* GetStageName(ShaderStage stage);
+};
@@ -0,0 +1,121 @@
+#include "ShaderPreprocessor.h"
+
+#include<iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+
+#define MAX_INCLUDE_DEPTH 16
+
+std::string ShaderPreprocessor::Process(const std::string& source, const std::string& directory,
+	const std::vector<std::string>& defines, std::vector<std::string>* dependencies, unsigned int firstLine)
+{
+	std::unordered_set<std::string> included;
+	return InjectDefines(ResolveIncludes(source, directory, included, dependencies, 0, firstLine), defines, firstLine);
+}
+
+bool ShaderPreprocessor::NeedsProcessing(const char* source, size_t size, const std::vector<std::string>& defines)
+{
+	if (!defines.empty())
+		return true;
+	for (const char* ptr = source; ptr + 8 <= source + size; ptr++)
+	{
+		if (*ptr == '#' && memcmp(ptr, "#include", 8) == 0)
+			return true;
+	}
+	return false;
+}
+
+std::string ShaderPreprocessor::GetDirectory(const std::string& filePath)
+{
+	size_t slash = filePath.find_last_of("/\\");
+	return slash == std::string::npos ? "." : filePath.substr(0, slash);
+}
+
+std::string ShaderPreprocessor::ResolveIncludes(const std::string& source, const std::string& directory,
+	std::unordered_set<std::string>& included, std::vector<std::string>* dependencies, int depth, unsigned int firstLine)
+{
+	std::stringstream output;
+	std::istringstream stream(source);
+	std::string line;
+	unsigned int lineNumber = firstLine - 1;
+
+	while (getline(stream, line))
+	{
+		lineNumber++;
+		size_t directive = line.find_first_not_of(" \t");
+		if (directive == std::string::npos || line.compare(directive, 8, "#include") != 0)
+		{
+			output << line << '\n';
+			continue;
+		}
+
+		size_t open = line.find_first_of("\"<", directive + 8);
+		size_t close = open == std::string::npos ? open : line.find_first_of("\">", open + 1);
+		if (close == std::string::npos)
+		{
+			std::cout << "[Shader] Malformed #include at line " << lineNumber << ": " << line << std::endl;
+			output << '\n';
+			continue;
+		}
+
+		std::string includePath = directory + "/" + line.substr(open + 1, close - open - 1);
+
+		// Every file is included once per stage, which also breaks include cycles.
+		// Skipped directives leave an empty line so line numbers stay intact.
+		if (!included.insert(includePath).second)
+		{
+			output << '\n';
+			continue;
+		}
+		if (depth >= MAX_INCLUDE_DEPTH)
+		{
+			std::cout << "[Shader] Include depth exceeded at " << includePath << std::endl;
+			output << '\n';
+			continue;
+		}
+
+		std::ifstream file(includePath);
+		if (!file)
+		{
+			std::cout << "[Shader] Failed to open include " << includePath << " (line " << lineNumber << ")" << std::endl;
+			output << '\n';
+			continue;
+		}
+		// Both stages may include the same file, it is watched once
+		if (dependencies && std::find(dependencies->begin(), dependencies->end(), includePath) == dependencies->end())
+			dependencies->push_back(includePath);
+
+		std::stringstream contents;
+		contents << file.rdbuf();
+		output << "#line 1\n"
+			<< ResolveIncludes(contents.str(), GetDirectory(includePath), included, dependencies, depth + 1, 1)
+			<< "#line " << lineNumber + 1 << '\n';
+	}
+	return output.str();
+}
+
+std::string ShaderPreprocessor::InjectDefines(const std::string& source, const std::vector<std::string>& defines, unsigned int firstLine)
+{
+	if (defines.empty() && firstLine == 1)
+		return source;
+
+	std::string block;
+	for (const std::string& define : defines)
+		block += "#define " + define + '\n';
+
+	// #version has to stay the first directive of the stage
+	size_t version = source.find("#version");
+	if (version == std::string::npos)
+		return block + "#line " + std::to_string(firstLine) + '\n' + source;
+
+	size_t lineEnd = source.find('\n', version);
+	if (lineEnd == std::string::npos)
+		return source + '\n' + block;
+
+	unsigned int versionLine = firstLine;
+	for (size_t i = 0; i < lineEnd; i++)
+		versionLine += source[i] == '\n';
+	return source.substr(0, lineEnd + 1) + block + "#line " + std::to_string(versionLine + 1) + '\n' + source.substr(lineEnd + 1);
+}
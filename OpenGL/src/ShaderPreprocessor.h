@@ -0,0 +1,26 @@
+#pragma once
+
+#include<string>
+#include<vector>
+#include<unordered_set>
+
+// Resolves #include directives and injects #define lines into GLSL stage sources
+class ShaderPreprocessor
+{
+public:
+	// Defines are "NAME" or "NAME VALUE", they are inserted right after the #version line.
+	// Every file pulled in through #include is appended to dependencies when given.
+	// firstLine is the line of the source within its file, it is kept through #line directives.
+	static std::string Process(const std::string& source, const std::string& directory,
+		const std::vector<std::string>& defines, std::vector<std::string>* dependencies = nullptr, unsigned int firstLine = 1);
+
+	// Whether there are includes or defines to process, line numbers are left to the caller
+	static bool NeedsProcessing(const char* source, size_t size, const std::vector<std::string>& defines);
+
+	static std::string GetDirectory(const std::string& filePath);
+
+private:
+	static std::string ResolveIncludes(const std::string& source, const std::string& directory,
+		std::unordered_set<std::string>& included, std::vector<std::string>* dependencies, int depth, unsigned int firstLine);
+	static std::string InjectDefines(const std::string& source, const std::vector<std::string>& defines, unsigned int firstLine);
+};
@@ -0,0 +1,54 @@
+#include "ShaderStorageBuffer.h"
+#include "Renderer.h"
+#include "DeletionQueue.h"
+#include "GL\glew.h"
+
+ShaderStorageBuffer::ShaderStorageBuffer(const void* data, unsigned int size)
+	:m_Size(size)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID));
+	GLCall(glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, GL_DYNAMIC_DRAW));
+	if (data)
+		GLStats::RecordUpload(size);
+}
+
+void ShaderStorageBuffer::GetData(unsigned int offset, void* data, unsigned int size) const
+{
+	ASSERT(offset + size <= m_Size);
+	Bind();
+	GLCall(glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data));
+}
+
+ShaderStorageBuffer::~ShaderStorageBuffer()
+{
+	DeletionQueue::Enqueue(GLResourceType::BUFFER, m_RendererID);
+}
+
+void ShaderStorageBuffer::Bind() const
+{
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID));
+}
+
+void ShaderStorageBuffer::UnBind() const
+{
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+}
+
+void ShaderStorageBuffer::BindBase(unsigned int index) const
+{
+	GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, m_RendererID));
+}
+
+void ShaderStorageBuffer::BindIndirect() const
+{
+	GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID));
+}
+
+void ShaderStorageBuffer::SetData(unsigned int offset, const void* data, unsigned int size) const
+{
+	ASSERT(offset + size <= m_Size);
+	Bind();
+	GLCall(glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data));
+	GLStats::RecordUpload(size);
+}
\ No newline at end of file
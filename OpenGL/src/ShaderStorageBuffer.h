@@ -0,0 +1,23 @@
+#pragma once
+
+class ShaderStorageBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Size;
+public:
+	// Data may be null to only allocate the storage
+	ShaderStorageBuffer(const void* data, unsigned int size);
+	~ShaderStorageBuffer();
+	void Bind() const;
+	void UnBind() const;
+
+	// Binds to an indexed binding point, "layout(std430, binding = index)" in GLSL
+	void BindBase(unsigned int index) const;
+	// Binds as the source of glDraw*Indirect parameters
+	void BindIndirect() const;
+	void SetData(unsigned int offset, const void* data, unsigned int size) const;
+	// Waits for the GPU to finish writing the buffer, keep it out of the per-frame path
+	void GetData(unsigned int offset, void* data, unsigned int size) const;
+	inline unsigned int GetSize() const { return m_Size; }
+};
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "ShaderVariantCache.h"
+#include "Renderer.h"
+
+ShaderVariantCache::ShaderVariantCache(const std::string& filePath, const std::vector<std::string>& features,
+	const std::vector<std::string>& baseDefines)
+	:m_FilePath(filePath), m_Features(features), m_BaseDefines(baseDefines), m_HotReload(false)
+{
+	ASSERT(m_Features.size() <= 32);
+}
+
+Shader& ShaderVariantCache::Get(unsigned int featureMask)
+{
+	auto variant = m_Variants.find(featureMask);
+	if (variant != m_Variants.end())
+		return *variant->second;
+
+	std::vector<std::string> defines = m_BaseDefines;
+	for (unsigned int i = 0; i < m_Features.size(); i++)
+	{
+		if (featureMask & (1u << i))
+			defines.push_back(m_Features[i]);
+	}
+
+	std::unique_ptr<Shader> shader(new Shader(m_FilePath, defines));
+	if (m_HotReload)
+		shader->EnableHotReload();
+	Shader& result = *shader;
+	m_Variants[featureMask] = std::move(shader);
+	return result;
+}
+
+void ShaderVariantCache::EnableHotReload()
+{
+	m_HotReload = true;
+	for (auto& variant : m_Variants)
+		variant.second->EnableHotReload();
+}
+
+void ShaderVariantCache::PollHotReload()
+{
+	for (auto& variant : m_Variants)
+		variant.second->PollHotReload();
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Shader.h"
+
+#include<string>
+#include<vector>
+#include<unordered_map>
+#include<memory>
+
+// Lazily compiled permutations of one uber-shader file, bit i of a feature mask defines features[i].
+// Variants never move once compiled, so pipelines can refer to them.
+class ShaderVariantCache
+{
+private:
+	std::string m_FilePath;
+	std::vector<std::string> m_Features;
+	std::vector<std::string> m_BaseDefines;
+	std::unordered_map<unsigned int, std::unique_ptr<Shader>> m_Variants;
+	bool m_HotReload;
+
+public:
+	// Base defines, such as sizes, are set in every variant
+	ShaderVariantCache(const std::string& filePath, const std::vector<std::string>& features,
+		const std::vector<std::string>& baseDefines = {});
+	ShaderVariantCache(const ShaderVariantCache&) = delete;
+	ShaderVariantCache& operator=(const ShaderVariantCache&) = delete;
+
+	// Compiles the variant on first use
+	Shader& Get(unsigned int featureMask);
+	inline unsigned int GetVariantCount() const { return (unsigned int)m_Variants.size(); }
+
+	void EnableHotReload();
+	void PollHotReload();
+};
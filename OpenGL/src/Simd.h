@@ -0,0 +1,14 @@
+#pragma once
+
+// Instruction set helpers shared by the SIMD kernels, AVX2 paths are only called after MathBatch checked the CPU
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+// MSVC emits AVX2 intrinsics without /arch:AVX2
+#define SIMD_AVX2_FUNCTION
+#else
+#define SIMD_AVX2_FUNCTION __attribute__((target("avx2,fma")))
+#endif
+#endif
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "Texture.h"
+#include "Renderer.h"
+#include "DeletionQueue.h"
+#include "GL\glew.h"
+
+#include<utility>
+
+Texture::Texture(unsigned int width, unsigned int height, unsigned int format, unsigned int levels)
+	:m_Width(width), m_Height(height), m_Format(format), m_Levels(levels)
+{
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLCall(glTexStorage2D(GL_TEXTURE_2D, levels, format, width, height));
+
+	// Depth is read texel for texel, color targets get filtered by the passes sampling them
+	GLenum filter = IsDepthFormat(format) ? GL_NEAREST : GL_LINEAR;
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : filter));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+Texture::~Texture()
+{
+	DeletionQueue::Enqueue(GLResourceType::TEXTURE, m_RendererID);
+}
+
+Texture::Texture(Texture&& other)
+	:m_RendererID(other.m_RendererID), m_Width(other.m_Width), m_Height(other.m_Height), m_Format(other.m_Format), m_Levels(other.m_Levels)
+{
+	other.m_RendererID = 0;
+}
+
+Texture& Texture::operator=(Texture&& other)
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_Width, other.m_Width);
+	std::swap(m_Height, other.m_Height);
+	std::swap(m_Format, other.m_Format);
+	std::swap(m_Levels, other.m_Levels);
+	return *this;
+}
+
+void Texture::Bind(unsigned int slot) const
+{
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+}
+
+void Texture::UnBind(unsigned int slot) const
+{
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+unsigned long long Texture::GetByteSize() const
+{
+	return GetByteSize(m_Width, m_Height, m_Format, m_Levels);
+}
+
+unsigned int Texture::GetBytesPerPixel(unsigned int format)
+{
+	switch (format)
+	{
+	case GL_R8: return 1;
+	case GL_RG8: case GL_R16F: return 2;
+	case GL_RGBA8: case GL_SRGB8_ALPHA8: case GL_RGB10_A2: case GL_R11F_G11F_B10F: case GL_RG16F: case GL_R32F: return 4;
+	case GL_RGBA16F: case GL_RG32F: return 8;
+	case GL_RGBA32F: return 16;
+	case GL_DEPTH_COMPONENT16: return 2;
+	// 24 bit depth is padded to 32 bits by every driver
+	case GL_DEPTH_COMPONENT24: case GL_DEPTH_COMPONENT32F: case GL_DEPTH24_STENCIL8: return 4;
+	case GL_DEPTH32F_STENCIL8: return 8;
+	}
+	ASSERT(false);
+	return 4;
+}
+
+bool Texture::IsDepthFormat(unsigned int format)
+{
+	return format == GL_DEPTH_COMPONENT16 || format == GL_DEPTH_COMPONENT24 || format == GL_DEPTH_COMPONENT32F
+		|| format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+}
+
+unsigned long long Texture::GetByteSize(unsigned int width, unsigned int height, unsigned int format, unsigned int levels)
+{
+	unsigned long long size = 0;
+	for (unsigned int level = 0; level < levels; level++)
+	{
+		unsigned int levelWidth = width >> level, levelHeight = height >> level;
+		size += (unsigned long long)(levelWidth > 0 ? levelWidth : 1) * (levelHeight > 0 ? levelHeight : 1) * GetBytesPerPixel(format);
+	}
+	return size;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+// Immutable 2D texture storage, used as a render target and sampled by later passes
+class Texture
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Width;
+	unsigned int m_Height;
+	unsigned int m_Format;
+	unsigned int m_Levels;
+
+public:
+	// Format is a sized internal format such as GL_RGBA8, GL_RGBA16F or GL_DEPTH_COMPONENT24
+	Texture(unsigned int width, unsigned int height, unsigned int format, unsigned int levels = 1);
+	~Texture();
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+	Texture(Texture&& other);
+	Texture& operator=(Texture&& other);
+
+	void Bind(unsigned int slot = 0) const;
+	void UnBind(unsigned int slot = 0) const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline unsigned int GetFormat() const { return m_Format; }
+	inline unsigned int GetLevels() const { return m_Levels; }
+	// GPU memory of all levels, estimated from the format
+	unsigned long long GetByteSize() const;
+
+	static unsigned int GetBytesPerPixel(unsigned int format);
+	static bool IsDepthFormat(unsigned int format);
+	static unsigned long long GetByteSize(unsigned int width, unsigned int height, unsigned int format, unsigned int levels = 1);
+};
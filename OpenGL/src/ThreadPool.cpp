@@ -0,0 +1,95 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int workerCount)
+	:m_Stopping(false), m_Job(nullptr), m_Count(0), m_Grain(1), m_Next(0), m_Busy(0), m_Generation(0)
+{
+	if (workerCount == 0)
+	{
+		unsigned int hardware = std::thread::hardware_concurrency();
+		workerCount = hardware > 1 ? hardware - 1 : 0;
+	}
+	for (unsigned int i = 0; i < workerCount; i++)
+		m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_WorkReady.notify_all();
+	for (std::thread& worker : m_Workers)
+		worker.join();
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& job)
+{
+	if (count == 0)
+		return;
+	if (grain == 0)
+		grain = 1;
+
+	// Not worth waking anyone for a single chunk
+	if (m_Workers.empty() || count <= grain)
+	{
+		job(0, count);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Job = &job;
+		m_Count = count;
+		m_Grain = grain;
+		m_Next = 0;
+		m_Busy = (unsigned int)m_Workers.size();
+		m_Generation++;
+	}
+	m_WorkReady.notify_all();
+
+	RunChunks();
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_WorkDone.wait(lock, [this] { return m_Busy == 0; });
+	m_Job = nullptr;
+}
+
+ThreadPool& ThreadPool::Get()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::WorkerLoop()
+{
+	unsigned long long seenGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WorkReady.wait(lock, [&] { return m_Stopping || m_Generation != seenGeneration; });
+			if (m_Stopping)
+				return;
+			seenGeneration = m_Generation;
+		}
+
+		RunChunks();
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (--m_Busy == 0)
+			m_WorkDone.notify_one();
+	}
+}
+
+void ThreadPool::RunChunks()
+{
+	while (true)
+	{
+		size_t begin = m_Next.fetch_add(m_Grain);
+		if (begin >= m_Count)
+			return;
+		size_t end = begin + m_Grain < m_Count ? begin + m_Grain : m_Count;
+		(*m_Job)(begin, end);
+	}
+}
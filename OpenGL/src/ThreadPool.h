@@ -0,0 +1,45 @@
+#pragma once
+
+#include<vector>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+#include<functional>
+#include<atomic>
+
+// Fixed set of worker threads for data-parallel loops, the calling thread takes part in every loop
+class ThreadPool
+{
+private:
+	std::vector<std::thread> m_Workers;
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkReady;
+	std::condition_variable m_WorkDone;
+	bool m_Stopping;
+
+	// Current loop, shared by all workers
+	const std::function<void(size_t, size_t)>* m_Job;
+	size_t m_Count;
+	size_t m_Grain;
+	std::atomic<size_t> m_Next;
+	unsigned int m_Busy;
+	unsigned long long m_Generation;
+
+public:
+	// 0 picks one worker per hardware thread besides the caller
+	ThreadPool(unsigned int workerCount = 0);
+	~ThreadPool();
+
+	inline unsigned int GetThreadCount() const { return (unsigned int)m_Workers.size() + 1; }
+
+	// Calls job(begin, end) over [0, count) in chunks of at most grain items, returns when all are done.
+	// Not reentrant, jobs must not start another ParallelFor on the same pool.
+	void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& job);
+
+	// Shared pool used by the engine systems
+	static ThreadPool& Get();
+
+private:
+	void WorkerLoop();
+	void RunChunks();
+};
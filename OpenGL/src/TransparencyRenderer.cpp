@@ -0,0 +1,204 @@
+#include "TransparencyRenderer.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "GL\glew.h"
+
+#include<algorithm>
+#include<chrono>
+#include<iostream>
+#include<iomanip>
+
+// Feature bits of Transparent.shader
+#define TRANSPARENT_WEIGHTED_BLENDED 1
+
+TransparencyRenderer::TransparencyRenderer()
+	:m_QuadVariants("res/shaders/Transparent.shader", { "WEIGHTED_BLENDED" }),
+	m_AccumulateShader(m_QuadVariants.Get(TRANSPARENT_WEIGHTED_BLENDED)), m_SortedShader(m_QuadVariants.Get(0)),
+	m_CompositeShader("res/shaders/TransparentComposite.shader"),
+	m_QuadBuffer(nullptr, MAX_TRANSPARENT_QUADS * sizeof(TransparentQuad)),
+	m_AccumulateTarget(), m_SortedTarget(),
+	m_Accumulation(RENDER_GRAPH_NONE), m_Revealage(RENDER_GRAPH_NONE), m_Output(RENDER_GRAPH_NONE),
+	m_Mode(TransparencyMode::WEIGHTED_BLENDED), m_CpuMilliseconds(0.0), m_ReportInterval(0), m_Frames(0)
+{
+	// Tested against the opaque depth but never written, the quads must not hide each other.
+	// Without a depth attachment the test always passes.
+	VertexBufferLayout noAttributes;
+	DepthState depth = { true, false, GL_LESS };
+	// Order independent: weighted colors add up, revealage multiplies by (1 - alpha)
+	m_AccumulatePipeline = &PipelineCache::Get().Create({ &m_AccumulateShader, noAttributes,
+		{ BlendState::Additive(), { true, GL_ZERO, GL_ONE_MINUS_SRC_COLOR } }, depth, RasterState::Default() });
+	m_SortedPipeline = &PipelineCache::Get().Create({ &m_SortedShader, noAttributes,
+		{ BlendState::Premultiplied(), BlendState::Premultiplied() }, depth, RasterState::Default() });
+}
+
+TransparencyRenderer::~TransparencyRenderer()
+{
+	PipelineCache::Get().Release(*m_AccumulatePipeline);
+	PipelineCache::Get().Release(*m_SortedPipeline);
+}
+
+void TransparencyRenderer::SetQuads(const TransparentQuad* quads, unsigned int count)
+{
+	if (count > MAX_TRANSPARENT_QUADS)
+		count = MAX_TRANSPARENT_QUADS;
+	m_Quads.assign(quads, quads + count);
+	// Sorted mode uploads its own order every frame
+	if (m_Mode == TransparencyMode::WEIGHTED_BLENDED && count > 0)
+		m_QuadBuffer.SetData(0, m_Quads.data(), count * sizeof(TransparentQuad));
+}
+
+void TransparencyRenderer::SetMode(TransparencyMode mode)
+{
+	if (mode == m_Mode)
+		return;
+	m_Mode = mode;
+	if (m_Mode == TransparencyMode::WEIGHTED_BLENDED && !m_Quads.empty())
+		m_QuadBuffer.SetData(0, m_Quads.data(), (unsigned int)(m_Quads.size() * sizeof(TransparentQuad)));
+	ResetTimings();
+}
+
+double TransparencyRenderer::GetCpuMilliseconds() const
+{
+	return m_Frames > 0 ? m_CpuMilliseconds / m_Frames : 0.0;
+}
+
+double TransparencyRenderer::GetGpuMilliseconds() const
+{
+	return m_Timer.GetSampleCount() > 0 ? m_Timer.GetTotalMilliseconds() / m_Timer.GetSampleCount() : 0.0;
+}
+
+void TransparencyRenderer::ResetTimings()
+{
+	m_Timer.ResetTotals();
+	m_CpuMilliseconds = 0.0;
+	m_Frames = 0;
+}
+
+void TransparencyRenderer::BindTarget(Target& target, const Texture& color0, const Texture* color1, const Texture* depth)
+{
+	unsigned int textures[3] = { color0.GetRendererID(), color1 ? color1->GetRendererID() : 0, depth ? depth->GetRendererID() : 0 };
+	if (!std::equal(textures, textures + 3, target.Textures))
+	{
+		target.Buffer = FrameBuffer();
+		target.Buffer.AttachColor(0, color0);
+		if (color1)
+			target.Buffer.AttachColor(1, *color1);
+		if (depth)
+			target.Buffer.AttachDepth(*depth);
+		target.Buffer.Validate();
+		std::copy(textures, textures + 3, target.Textures);
+	}
+	target.Buffer.Bind();
+}
+
+void TransparencyRenderer::DrawQuads(const PipelineState& pipeline, const Mat4& viewProjection)
+{
+	GLStateCache::Bind(pipeline);
+	Shader& shader = *pipeline.GetDesc().Program;
+	shader.SetUniformMat4f("u_ViewProjection", viewProjection.m);
+	m_QuadBuffer.BindBase(TRANSPARENT_QUADS_BINDING);
+	m_QuadArray.Bind();
+	GLCall(glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)m_Quads.size()));
+	GLStats::RecordDraw(GL_TRIANGLES, 6, (unsigned int)m_Quads.size());
+}
+
+RenderGraphResource TransparencyRenderer::AddPass(RenderGraph& graph, RenderGraphResource sceneColor, RenderGraphResource sceneDepth,
+	const Mat4& view, const Mat4& viewProjection)
+{
+	const RenderGraphTextureDesc& size = graph.GetDesc(sceneColor);
+	if (m_Mode == TransparencyMode::SORTED)
+	{
+		graph.AddPass("SortedTransparency", [&](RenderGraphBuilder& builder)
+		{
+			builder.Read(sceneColor);
+			if (sceneDepth != RENDER_GRAPH_NONE)
+				builder.Read(sceneDepth);
+			m_Output = builder.CreateTexture("SceneWithTransparency", { size.Width, size.Height, GL_RGBA16F });
+		}, [this, sceneColor, sceneDepth, view, viewProjection](RenderGraph& graph)
+		{
+			// Back to front is ascending view space z, the camera looks down -z
+			auto start = std::chrono::high_resolution_clock::now();
+			m_SortKeys.resize(m_Quads.size());
+			for (unsigned int i = 0; i < m_Quads.size(); i++)
+			{
+				const float* center = m_Quads[i].Center;
+				m_SortKeys[i] = { view.TransformPoint({ center[0], center[1], center[2] }).z, i };
+			}
+			std::sort(m_SortKeys.begin(), m_SortKeys.end());
+			m_SortedQuads.resize(m_Quads.size());
+			for (unsigned int i = 0; i < m_SortKeys.size(); i++)
+				m_SortedQuads[i] = m_Quads[m_SortKeys[i].second];
+			if (!m_SortedQuads.empty())
+				m_QuadBuffer.SetData(0, m_SortedQuads.data(), (unsigned int)(m_SortedQuads.size() * sizeof(TransparentQuad)));
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+			m_CpuMilliseconds += elapsed.count();
+
+			m_Timer.Begin();
+			const Texture& scene = graph.GetTexture(sceneColor);
+			const Texture& target = graph.GetTexture(m_Output);
+			const Texture* depth = sceneDepth != RENDER_GRAPH_NONE ? &graph.GetTexture(sceneDepth) : nullptr;
+			GLCall(glCopyImageSubData(scene.GetRendererID(), GL_TEXTURE_2D, 0, 0, 0, 0,
+				target.GetRendererID(), GL_TEXTURE_2D, 0, 0, 0, 0, scene.GetWidth(), scene.GetHeight(), 1));
+			BindTarget(m_SortedTarget, target, nullptr, depth);
+			DrawQuads(*m_SortedPipeline, viewProjection);
+			m_Timer.End();
+			EndFrame();
+		});
+		return m_Output;
+	}
+
+	graph.AddPass("TransparentAccumulation", [&](RenderGraphBuilder& builder)
+	{
+		if (sceneDepth != RENDER_GRAPH_NONE)
+			builder.Read(sceneDepth);
+		m_Accumulation = builder.CreateTexture("TransparentAccumulation", { size.Width, size.Height, GL_RGBA16F });
+		m_Revealage = builder.CreateTexture("TransparentRevealage", { size.Width, size.Height, GL_R8 });
+	}, [this, sceneDepth, viewProjection](RenderGraph& graph)
+	{
+		m_Timer.Begin();
+		const Texture* depth = sceneDepth != RENDER_GRAPH_NONE ? &graph.GetTexture(sceneDepth) : nullptr;
+		BindTarget(m_AccumulateTarget, graph.GetTexture(m_Accumulation), &graph.GetTexture(m_Revealage), depth);
+		const float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		const float one[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		GLCall(glClearBufferfv(GL_COLOR, 0, zero));
+		GLCall(glClearBufferfv(GL_COLOR, 1, one));
+		DrawQuads(*m_AccumulatePipeline, viewProjection);
+	});
+
+	graph.AddPass("TransparentComposite", [&](RenderGraphBuilder& builder)
+	{
+		builder.Read(sceneColor);
+		builder.Read(m_Accumulation);
+		builder.Read(m_Revealage);
+		m_Output = builder.CreateTexture("SceneWithTransparency", { size.Width, size.Height, GL_RGBA16F });
+	}, [this, sceneColor](RenderGraph& graph)
+	{
+		graph.GetTexture(sceneColor).Bind(0);
+		graph.GetTexture(m_Accumulation).Bind(1);
+		graph.GetTexture(m_Revealage).Bind(2);
+		m_CompositeShader.Bind();
+		m_CompositeShader.SetUniform1i("u_Scene", 0);
+		m_CompositeShader.SetUniform1i("u_Accumulation", 1);
+		m_CompositeShader.SetUniform1i("u_Revealage", 2);
+		m_Fullscreen.Draw(m_CompositeShader);
+		m_Timer.End();
+		EndFrame();
+	});
+	return m_Output;
+}
+
+void TransparencyRenderer::EndFrame()
+{
+	m_Timer.Poll();
+	m_Frames++;
+	if (m_ReportInterval > 0 && m_Frames >= m_ReportInterval)
+		Report();
+}
+
+void TransparencyRenderer::Report()
+{
+	std::cout << "[Transparency] " << (m_Mode == TransparencyMode::SORTED ? "sorted" : "weighted blended") << ", "
+		<< m_Quads.size() << " quads: " << std::fixed << std::setprecision(3) << GetCpuMilliseconds() << " ms CPU, "
+		<< GetGpuMilliseconds() << " ms GPU" << std::defaultfloat << std::endl;
+	ResetTimings();
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Shader.h"
+#include "ShaderVariantCache.h"
+#include "ShaderStorageBuffer.h"
+#include "VertexArray.h"
+#include "FrameBuffer.h"
+#include "FullscreenTriangle.h"
+#include "GpuTimer.h"
+#include "RenderGraph.h"
+#include "PipelineState.h"
+#include "VectorMath.h"
+
+#include<vector>
+#include<utility>
+
+#define MAX_TRANSPARENT_QUADS 131072
+// "layout(std430, binding = 8) readonly buffer TransparentQuads" in Transparent.shader
+#define TRANSPARENT_QUADS_BINDING 8
+
+// std430 layout of TransparentQuad in Transparent.shader, an XY plane square of half size Size
+struct TransparentQuad
+{
+	float Center[3];
+	float Size;
+	// Straight alpha
+	float Color[4];
+};
+
+enum class TransparencyMode
+{
+	// Submitted unsorted in one draw, blended into accumulation and revealage targets and composited
+	WEIGHTED_BLENDED,
+	// Sorted back to front on the CPU every frame, then over-blended onto the scene in one draw
+	SORTED
+};
+
+// Transparent quads drawn over the lit scene. Both modes are kept so their cost can be compared.
+class TransparencyRenderer
+{
+private:
+	// Framebuffer over graph textures, rebuilt when the graph hands out different ones
+	struct Target
+	{
+		FrameBuffer Buffer;
+		unsigned int Textures[3];
+	};
+
+	// Transparent.shader with WEIGHTED_BLENDED writes accumulation and revealage, without it blends in order
+	ShaderVariantCache m_QuadVariants;
+	Shader& m_AccumulateShader;
+	Shader& m_SortedShader;
+	Shader m_CompositeShader;
+	const PipelineState* m_AccumulatePipeline;
+	const PipelineState* m_SortedPipeline;
+	VertexArray m_QuadArray;
+	FullscreenTriangle m_Fullscreen;
+	ShaderStorageBuffer m_QuadBuffer;
+	std::vector<TransparentQuad> m_Quads;
+	std::vector<TransparentQuad> m_SortedQuads;
+	std::vector<std::pair<float, unsigned int>> m_SortKeys;
+	Target m_AccumulateTarget;
+	Target m_SortedTarget;
+	// Graph resources of the passes recorded this frame, setup creates them after the execute callbacks were bound
+	RenderGraphResource m_Accumulation;
+	RenderGraphResource m_Revealage;
+	RenderGraphResource m_Output;
+	TransparencyMode m_Mode;
+	GpuTimer m_Timer;
+	double m_CpuMilliseconds;
+	unsigned int m_ReportInterval;
+	unsigned int m_Frames;
+
+public:
+	TransparencyRenderer();
+	~TransparencyRenderer();
+	TransparencyRenderer(const TransparencyRenderer&) = delete;
+	TransparencyRenderer& operator=(const TransparencyRenderer&) = delete;
+
+	// Clamped to MAX_TRANSPARENT_QUADS
+	void SetQuads(const TransparentQuad* quads, unsigned int count);
+	void SetMode(TransparencyMode mode);
+	inline TransparencyMode GetMode() const { return m_Mode; }
+	// Prints the average CPU and GPU time every 'frames' frames, 0 disables reporting
+	inline void SetReportInterval(unsigned int frames) { m_ReportInterval = frames; }
+	// Per frame averages since the mode changed, the last report or ResetTimings. The CPU time is the sorting,
+	// weighted blending has none.
+	double GetCpuMilliseconds() const;
+	double GetGpuMilliseconds() const;
+	void ResetTimings();
+
+	// Returns the scene with the quads on top. The quads are depth tested against sceneDepth unless it is RENDER_GRAPH_NONE.
+	RenderGraphResource AddPass(RenderGraph& graph, RenderGraphResource sceneColor, RenderGraphResource sceneDepth,
+		const Mat4& view, const Mat4& viewProjection);
+
+	inline unsigned int GetQuadCount() const { return (unsigned int)m_Quads.size(); }
+
+private:
+	void BindTarget(Target& target, const Texture& color0, const Texture* color1, const Texture* depth);
+	void DrawQuads(const PipelineState& pipeline, const Mat4& viewProjection);
+	void EndFrame();
+	void Report();
+};
@@ -0,0 +1,451 @@
+#include "VectorMath.h"
+
+#include "Simd.h"
+
+#include<cstring>
+
+Mat4 Mat4::operator*(const Mat4& other) const
+{
+	Mat4 result;
+	for (int column = 0; column < 4; column++)
+	{
+		for (int row = 0; row < 4; row++)
+		{
+			result.m[column * 4 + row] = m[row] * other.m[column * 4]
+				+ m[4 + row] * other.m[column * 4 + 1]
+				+ m[8 + row] * other.m[column * 4 + 2]
+				+ m[12 + row] * other.m[column * 4 + 3];
+		}
+	}
+	return result;
+}
+
+Vec4 Mat4::operator*(const Vec4& v) const
+{
+	return{ m[0] * v.x + m[4] * v.y + m[8] * v.z + m[12] * v.w,
+		m[1] * v.x + m[5] * v.y + m[9] * v.z + m[13] * v.w,
+		m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14] * v.w,
+		m[3] * v.x + m[7] * v.y + m[11] * v.z + m[15] * v.w };
+}
+
+Mat4 Mat4::Identity()
+{
+	Mat4 result = {};
+	result.m[0] = result.m[5] = result.m[10] = result.m[15] = 1.0f;
+	return result;
+}
+
+Mat4 Mat4::Translation(const Vec3& t)
+{
+	Mat4 result = Identity();
+	result.m[12] = t.x;
+	result.m[13] = t.y;
+	result.m[14] = t.z;
+	return result;
+}
+
+Mat4 Mat4::Scale(const Vec3& s)
+{
+	Mat4 result = Identity();
+	result.m[0] = s.x;
+	result.m[5] = s.y;
+	result.m[10] = s.z;
+	return result;
+}
+
+Mat4 Mat4::Rotation(const Quat& q)
+{
+	return FromTRS({ 0.0f, 0.0f, 0.0f }, q, { 1.0f, 1.0f, 1.0f });
+}
+
+Mat4 Mat4::FromTRS(const Vec3& t, const Quat& r, const Vec3& s)
+{
+	float xx = r.x * r.x, yy = r.y * r.y, zz = r.z * r.z;
+	float xy = r.x * r.y, xz = r.x * r.z, yz = r.y * r.z;
+	float wx = r.w * r.x, wy = r.w * r.y, wz = r.w * r.z;
+
+	Mat4 result;
+	result.m[0] = (1.0f - 2.0f * (yy + zz)) * s.x;
+	result.m[1] = 2.0f * (xy + wz) * s.x;
+	result.m[2] = 2.0f * (xz - wy) * s.x;
+	result.m[3] = 0.0f;
+	result.m[4] = 2.0f * (xy - wz) * s.y;
+	result.m[5] = (1.0f - 2.0f * (xx + zz)) * s.y;
+	result.m[6] = 2.0f * (yz + wx) * s.y;
+	result.m[7] = 0.0f;
+	result.m[8] = 2.0f * (xz + wy) * s.z;
+	result.m[9] = 2.0f * (yz - wx) * s.z;
+	result.m[10] = (1.0f - 2.0f * (xx + yy)) * s.z;
+	result.m[11] = 0.0f;
+	result.m[12] = t.x;
+	result.m[13] = t.y;
+	result.m[14] = t.z;
+	result.m[15] = 1.0f;
+	return result;
+}
+
+Mat4 Mat4::Perspective(float fovY, float aspect, float zNear, float zFar)
+{
+	float f = 1.0f / tanf(fovY * 0.5f);
+	Mat4 result = {};
+	result.m[0] = f / aspect;
+	result.m[5] = f;
+	result.m[10] = (zFar + zNear) / (zNear - zFar);
+	result.m[11] = -1.0f;
+	result.m[14] = 2.0f * zFar * zNear / (zNear - zFar);
+	return result;
+}
+
+Mat4 Mat4::Orthographic(float left, float right, float bottom, float top, float zNear, float zFar)
+{
+	Mat4 result = Identity();
+	result.m[0] = 2.0f / (right - left);
+	result.m[5] = 2.0f / (top - bottom);
+	result.m[10] = -2.0f / (zFar - zNear);
+	result.m[12] = -(right + left) / (right - left);
+	result.m[13] = -(top + bottom) / (top - bottom);
+	result.m[14] = -(zFar + zNear) / (zFar - zNear);
+	return result;
+}
+
+Mat4 Mat4::LookAt(const Vec3& eye, const Vec3& target, const Vec3& up)
+{
+	Vec3 f = Normalize(target - eye);
+	Vec3 s = Normalize(Cross(f, up));
+	Vec3 u = Cross(s, f);
+
+	Mat4 result = Identity();
+	result.m[0] = s.x; result.m[4] = s.y; result.m[8] = s.z;
+	result.m[1] = u.x; result.m[5] = u.y; result.m[9] = u.z;
+	result.m[2] = -f.x; result.m[6] = -f.y; result.m[10] = -f.z;
+	result.m[12] = -Dot(s, eye);
+	result.m[13] = -Dot(u, eye);
+	result.m[14] = Dot(f, eye);
+	return result;
+}
+
+Mat4 Transpose(const Mat4& matrix)
+{
+	Mat4 result;
+	for (int row = 0; row < 4; row++)
+		for (int column = 0; column < 4; column++)
+			result.m[row * 4 + column] = matrix.m[column * 4 + row];
+	return result;
+}
+
+Mat4 Inverse(const Mat4& matrix)
+{
+	const float* m = matrix.m;
+	Mat4 inv;
+	inv.m[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+	inv.m[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+	inv.m[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+	inv.m[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+	inv.m[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+	inv.m[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+	inv.m[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+	inv.m[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+	inv.m[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+	inv.m[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+	inv.m[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+	inv.m[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+	inv.m[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+	inv.m[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+	inv.m[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+	inv.m[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+	float det = m[0] * inv.m[0] + m[1] * inv.m[4] + m[2] * inv.m[8] + m[3] * inv.m[12];
+	if (det == 0.0f)
+		return Mat4::Identity();
+
+	float invDet = 1.0f / det;
+	for (int i = 0; i < 16; i++)
+		inv.m[i] *= invDet;
+	return inv;
+}
+
+Frustum Frustum::FromMatrix(const Mat4& viewProjection)
+{
+	// Gribb/Hartmann: row 3 +/- row i
+	const float* m = viewProjection.m;
+	Frustum frustum;
+	for (int i = 0; i < 3; i++)
+	{
+		frustum.Planes[i * 2 + 0] = { m[3] + m[i], m[7] + m[4 + i], m[11] + m[8 + i], m[15] + m[12 + i] };
+		frustum.Planes[i * 2 + 1] = { m[3] - m[i], m[7] - m[4 + i], m[11] - m[8 + i], m[15] - m[12 + i] };
+	}
+	for (Vec4& plane : frustum.Planes)
+		plane = plane * (1.0f / Length(plane.XYZ()));
+	return frustum;
+}
+
+bool Frustum::Intersects(const Sphere& sphere) const
+{
+	for (const Vec4& plane : Planes)
+	{
+		if (Dot(plane.XYZ(), sphere.Center) + plane.w < -sphere.Radius)
+			return false;
+	}
+	return true;
+}
+
+bool Frustum::Intersects(const AABB& box) const
+{
+	// Test the box corner furthest along each plane normal
+	for (const Vec4& plane : Planes)
+	{
+		Vec3 corner = { plane.x >= 0.0f ? box.Max.x : box.Min.x, plane.y >= 0.0f ? box.Max.y : box.Min.y, plane.z >= 0.0f ? box.Max.z : box.Min.z };
+		if (Dot(plane.XYZ(), corner) + plane.w < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+/* Instruction set selection */
+
+static bool CpuSupportsAVX2()
+{
+#if defined(SIMD_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool fma = (info[2] & (1 << 12)) != 0;
+	if (!osxsave || !fma || (_xgetbv(0) & 6) != 6)
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#elif defined(SIMD_X86)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+	return false;
+#endif
+}
+
+SimdLevel MathBatch::s_Level = MathBatch::GetSupportedLevel();
+
+SimdLevel MathBatch::GetSupportedLevel()
+{
+#ifdef SIMD_X86
+	static const SimdLevel supported = CpuSupportsAVX2() ? SimdLevel::AVX2 : SimdLevel::SSE;
+	return supported;
+#else
+	return SimdLevel::SCALAR;
+#endif
+}
+
+void MathBatch::SetLevel(SimdLevel level)
+{
+	s_Level = (int)level > (int)GetSupportedLevel() ? GetSupportedLevel() : level;
+}
+
+const char* MathBatch::GetLevelName(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::SCALAR: return "scalar";
+	case SimdLevel::SSE: return "SSE";
+	case SimdLevel::AVX2: return "AVX2";
+	}
+	return "unknown";
+}
+
+/* Matrix batches */
+
+static void MultiplyMatricesScalar(const Mat4& left, const Mat4* right, Mat4* out, size_t count)
+{
+	Mat4 l = left;
+	for (size_t i = 0; i < count; i++)
+		out[i] = l * right[i];
+}
+
+#ifdef SIMD_X86
+static void MultiplyMatricesSSE(const Mat4& left, const Mat4* right, Mat4* out, size_t count)
+{
+	__m128 c0 = _mm_loadu_ps(left.m);
+	__m128 c1 = _mm_loadu_ps(left.m + 4);
+	__m128 c2 = _mm_loadu_ps(left.m + 8);
+	__m128 c3 = _mm_loadu_ps(left.m + 12);
+	for (size_t i = 0; i < count; i++)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			__m128 r = _mm_loadu_ps(right[i].m + column * 4);
+			__m128 result = _mm_mul_ps(c0, _mm_shuffle_ps(r, r, 0x00));
+			result = _mm_add_ps(result, _mm_mul_ps(c1, _mm_shuffle_ps(r, r, 0x55)));
+			result = _mm_add_ps(result, _mm_mul_ps(c2, _mm_shuffle_ps(r, r, 0xAA)));
+			result = _mm_add_ps(result, _mm_mul_ps(c3, _mm_shuffle_ps(r, r, 0xFF)));
+			_mm_storeu_ps(out[i].m + column * 4, result);
+		}
+	}
+}
+
+SIMD_AVX2_FUNCTION static void MultiplyMatricesAVX2(const Mat4& left, const Mat4* right, Mat4* out, size_t count)
+{
+	// Both 128-bit lanes hold the left matrix, two result columns are produced per iteration
+	__m256 c0 = _mm256_broadcast_ps((const __m128*)left.m);
+	__m256 c1 = _mm256_broadcast_ps((const __m128*)(left.m + 4));
+	__m256 c2 = _mm256_broadcast_ps((const __m128*)(left.m + 8));
+	__m256 c3 = _mm256_broadcast_ps((const __m128*)(left.m + 12));
+	for (size_t i = 0; i < count; i++)
+	{
+		for (int column = 0; column < 4; column += 2)
+		{
+			__m256 r = _mm256_loadu_ps(right[i].m + column * 4);
+			__m256 result = _mm256_mul_ps(c0, _mm256_shuffle_ps(r, r, 0x00));
+			result = _mm256_fmadd_ps(c1, _mm256_shuffle_ps(r, r, 0x55), result);
+			result = _mm256_fmadd_ps(c2, _mm256_shuffle_ps(r, r, 0xAA), result);
+			result = _mm256_fmadd_ps(c3, _mm256_shuffle_ps(r, r, 0xFF), result);
+			_mm256_storeu_ps(out[i].m + column * 4, result);
+		}
+	}
+}
+#endif
+
+void MathBatch::MultiplyMatrices(const Mat4& left, const Mat4* right, Mat4* out, size_t count)
+{
+#ifdef SIMD_X86
+	if (s_Level == SimdLevel::AVX2)
+		return MultiplyMatricesAVX2(left, right, out, count);
+	if (s_Level == SimdLevel::SSE)
+		return MultiplyMatricesSSE(left, right, out, count);
+#endif
+	MultiplyMatricesScalar(left, right, out, count);
+}
+
+/* Point batches */
+
+static void TransformPointsScalar(const Mat4& matrix, const float* x, const float* y, const float* z,
+	float* outX, float* outY, float* outZ, float* outW, size_t first, size_t count)
+{
+	const float* m = matrix.m;
+	for (size_t i = first; i < count; i++)
+	{
+		float px = x[i], py = y[i], pz = z[i];
+		outX[i] = m[0] * px + m[4] * py + m[8] * pz + m[12];
+		outY[i] = m[1] * px + m[5] * py + m[9] * pz + m[13];
+		outZ[i] = m[2] * px + m[6] * py + m[10] * pz + m[14];
+		outW[i] = m[3] * px + m[7] * py + m[11] * pz + m[15];
+	}
+}
+
+#ifdef SIMD_X86
+static void TransformPointsSSE(const Mat4& matrix, const float* x, const float* y, const float* z,
+	float* outX, float* outY, float* outZ, float* outW, size_t count)
+{
+	__m128 m[16];
+	for (int i = 0; i < 16; i++)
+		m[i] = _mm_set1_ps(matrix.m[i]);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i), pz = _mm_loadu_ps(z + i);
+		float* outputs[] = { outX, outY, outZ, outW };
+		for (int row = 0; row < 4; row++)
+		{
+			__m128 result = _mm_add_ps(_mm_mul_ps(m[row], px), m[12 + row]);
+			result = _mm_add_ps(result, _mm_mul_ps(m[4 + row], py));
+			result = _mm_add_ps(result, _mm_mul_ps(m[8 + row], pz));
+			_mm_storeu_ps(outputs[row] + i, result);
+		}
+	}
+	TransformPointsScalar(matrix, x, y, z, outX, outY, outZ, outW, i, count);
+}
+
+SIMD_AVX2_FUNCTION static void TransformPointsAVX2(const Mat4& matrix, const float* x, const float* y, const float* z,
+	float* outX, float* outY, float* outZ, float* outW, size_t count)
+{
+	__m256 m[16];
+	for (int i = 0; i < 16; i++)
+		m[i] = _mm256_set1_ps(matrix.m[i]);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i), pz = _mm256_loadu_ps(z + i);
+		float* outputs[] = { outX, outY, outZ, outW };
+		for (int row = 0; row < 4; row++)
+		{
+			__m256 result = _mm256_fmadd_ps(m[row], px, m[12 + row]);
+			result = _mm256_fmadd_ps(m[4 + row], py, result);
+			result = _mm256_fmadd_ps(m[8 + row], pz, result);
+			_mm256_storeu_ps(outputs[row] + i, result);
+		}
+	}
+	TransformPointsScalar(matrix, x, y, z, outX, outY, outZ, outW, i, count);
+}
+#endif
+
+void MathBatch::TransformPoints(const Mat4& matrix, const float* x, const float* y, const float* z,
+	float* outX, float* outY, float* outZ, float* outW, size_t count)
+{
+#ifdef SIMD_X86
+	if (s_Level == SimdLevel::AVX2)
+		return TransformPointsAVX2(matrix, x, y, z, outX, outY, outZ, outW, count);
+	if (s_Level == SimdLevel::SSE)
+		return TransformPointsSSE(matrix, x, y, z, outX, outY, outZ, outW, count);
+#endif
+	TransformPointsScalar(matrix, x, y, z, outX, outY, outZ, outW, 0, count);
+}
+
+/* Bounding box batches */
+
+static void TransformAABBsScalar(const Mat4* matrices, const AABB* local, AABB* world, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* m = matrices[i].m;
+		Vec3 c = local[i].Center(), e = local[i].Extent();
+		Vec3 center = matrices[i].TransformPoint(c);
+		Vec3 extent = {
+			fabsf(m[0]) * e.x + fabsf(m[4]) * e.y + fabsf(m[8]) * e.z,
+			fabsf(m[1]) * e.x + fabsf(m[5]) * e.y + fabsf(m[9]) * e.z,
+			fabsf(m[2]) * e.x + fabsf(m[6]) * e.y + fabsf(m[10]) * e.z };
+		world[i] = { center - extent, center + extent };
+	}
+}
+
+#ifdef SIMD_X86
+static void TransformAABBsSSE(const Mat4* matrices, const AABB* local, AABB* world, size_t count)
+{
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	const __m128 half = _mm_set1_ps(0.5f);
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* m = matrices[i].m;
+		__m128 c0 = _mm_loadu_ps(m), c1 = _mm_loadu_ps(m + 4), c2 = _mm_loadu_ps(m + 8), c3 = _mm_loadu_ps(m + 12);
+
+		const AABB& box = local[i];
+		__m128 boxMin = _mm_setr_ps(box.Min.x, box.Min.y, box.Min.z, 0.0f);
+		__m128 boxMax = _mm_setr_ps(box.Max.x, box.Max.y, box.Max.z, 0.0f);
+		__m128 c = _mm_mul_ps(_mm_add_ps(boxMin, boxMax), half);
+		__m128 e = _mm_mul_ps(_mm_sub_ps(boxMax, boxMin), half);
+
+		__m128 center = _mm_add_ps(c3, _mm_mul_ps(c0, _mm_shuffle_ps(c, c, 0x00)));
+		center = _mm_add_ps(center, _mm_mul_ps(c1, _mm_shuffle_ps(c, c, 0x55)));
+		center = _mm_add_ps(center, _mm_mul_ps(c2, _mm_shuffle_ps(c, c, 0xAA)));
+		__m128 extent = _mm_mul_ps(_mm_and_ps(c0, absMask), _mm_shuffle_ps(e, e, 0x00));
+		extent = _mm_add_ps(extent, _mm_mul_ps(_mm_and_ps(c1, absMask), _mm_shuffle_ps(e, e, 0x55)));
+		extent = _mm_add_ps(extent, _mm_mul_ps(_mm_and_ps(c2, absMask), _mm_shuffle_ps(e, e, 0xAA)));
+
+		float result[8];
+		_mm_storeu_ps(result, _mm_sub_ps(center, extent));
+		_mm_storeu_ps(result + 4, _mm_add_ps(center, extent));
+		world[i] = { { result[0], result[1], result[2] }, { result[4], result[5], result[6] } };
+	}
+}
+#endif
+
+void MathBatch::TransformAABBs(const Mat4* matrices, const AABB* local, AABB* world, size_t count)
+{
+	// One box fills a single 128-bit register, AVX2 has nothing to add over SSE here
+#ifdef SIMD_X86
+	if (s_Level != SimdLevel::SCALAR)
+		return TransformAABBsSSE(matrices, local, world, count);
+#endif
+	TransformAABBsScalar(matrices, local, world, count);
+}
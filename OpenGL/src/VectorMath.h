@@ -0,0 +1,159 @@
+#pragma once
+
+#include<cmath>
+#include<cstddef>
+
+struct Vec3
+{
+	float x, y, z;
+
+	inline Vec3 operator+(const Vec3& other) const { return{ x + other.x, y + other.y, z + other.z }; }
+	inline Vec3 operator-(const Vec3& other) const { return{ x - other.x, y - other.y, z - other.z }; }
+	inline Vec3 operator*(const Vec3& other) const { return{ x * other.x, y * other.y, z * other.z }; }
+	inline Vec3 operator*(float scalar) const { return{ x * scalar, y * scalar, z * scalar }; }
+	inline Vec3 operator-() const { return{ -x, -y, -z }; }
+};
+
+struct Vec4
+{
+	float x, y, z, w;
+
+	inline Vec4 operator+(const Vec4& other) const { return{ x + other.x, y + other.y, z + other.z, w + other.w }; }
+	inline Vec4 operator*(float scalar) const { return{ x * scalar, y * scalar, z * scalar, w * scalar }; }
+	inline Vec3 XYZ() const { return{ x, y, z }; }
+};
+
+inline float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float Dot(const Vec4& a, const Vec4& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+inline Vec3 Cross(const Vec3& a, const Vec3& b) { return{ a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+inline float Length(const Vec3& v) { return sqrtf(Dot(v, v)); }
+inline Vec3 Normalize(const Vec3& v) { float length = Length(v); return length > 0.0f ? v * (1.0f / length) : v; }
+inline Vec3 Min(const Vec3& a, const Vec3& b) { return{ fminf(a.x, b.x), fminf(a.y, b.y), fminf(a.z, b.z) }; }
+inline Vec3 Max(const Vec3& a, const Vec3& b) { return{ fmaxf(a.x, b.x), fmaxf(a.y, b.y), fmaxf(a.z, b.z) }; }
+
+struct Quat
+{
+	float x, y, z, w;
+
+	static inline Quat Identity() { return{ 0.0f, 0.0f, 0.0f, 1.0f }; }
+	static inline Quat FromAxisAngle(const Vec3& axis, float radians)
+	{
+		Vec3 n = Normalize(axis);
+		float s = sinf(radians * 0.5f);
+		return{ n.x * s, n.y * s, n.z * s, cosf(radians * 0.5f) };
+	}
+
+	inline Quat operator*(const Quat& q) const
+	{
+		return{ w * q.x + x * q.w + y * q.z - z * q.y,
+			w * q.y - x * q.z + y * q.w + z * q.x,
+			w * q.z + x * q.y - y * q.x + z * q.w,
+			w * q.w - x * q.x - y * q.y - z * q.z };
+	}
+
+	inline Vec3 Rotate(const Vec3& v) const
+	{
+		Vec3 u = { x, y, z };
+		Vec3 t = Cross(u, v) * 2.0f;
+		return v + t * w + Cross(u, t);
+	}
+};
+
+inline Quat Normalize(const Quat& q)
+{
+	float length = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+	return{ q.x / length, q.y / length, q.z / length, q.w / length };
+}
+
+// Column-major like OpenGL, element (row, column) is m[column * 4 + row]
+struct Mat4
+{
+	float m[16];
+
+	inline float& operator()(int row, int column) { return m[column * 4 + row]; }
+	inline float operator()(int row, int column) const { return m[column * 4 + row]; }
+	inline Vec4 Column(int column) const { return{ m[column * 4], m[column * 4 + 1], m[column * 4 + 2], m[column * 4 + 3] }; }
+
+	Mat4 operator*(const Mat4& other) const;
+	Vec4 operator*(const Vec4& v) const;
+	inline Vec3 TransformPoint(const Vec3& p) const
+	{
+		return{ m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12],
+			m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+			m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14] };
+	}
+	inline Vec3 TransformVector(const Vec3& v) const
+	{
+		return{ m[0] * v.x + m[4] * v.y + m[8] * v.z,
+			m[1] * v.x + m[5] * v.y + m[9] * v.z,
+			m[2] * v.x + m[6] * v.y + m[10] * v.z };
+	}
+
+	static Mat4 Identity();
+	static Mat4 Translation(const Vec3& t);
+	static Mat4 Scale(const Vec3& s);
+	static Mat4 Rotation(const Quat& q);
+	// Translation * Rotation * Scale
+	static Mat4 FromTRS(const Vec3& t, const Quat& r, const Vec3& s);
+	static Mat4 Perspective(float fovY, float aspect, float zNear, float zFar);
+	static Mat4 Orthographic(float left, float right, float bottom, float top, float zNear, float zFar);
+	static Mat4 LookAt(const Vec3& eye, const Vec3& target, const Vec3& up);
+};
+
+Mat4 Transpose(const Mat4& matrix);
+Mat4 Inverse(const Mat4& matrix);
+
+struct AABB
+{
+	Vec3 Min;
+	Vec3 Max;
+
+	inline Vec3 Center() const { return (Min + Max) * 0.5f; }
+	inline Vec3 Extent() const { return (Max - Min) * 0.5f; }
+};
+
+struct Sphere
+{
+	Vec3 Center;
+	float Radius;
+};
+
+// Planes are (normal, d) with normals pointing inside: left, right, bottom, top, near, far
+struct Frustum
+{
+	Vec4 Planes[6];
+
+	static Frustum FromMatrix(const Mat4& viewProjection);
+	bool Intersects(const Sphere& sphere) const;
+	bool Intersects(const AABB& box) const;
+};
+
+enum class SimdLevel
+{
+	SCALAR = 0, SSE = 1, AVX2 = 2
+};
+
+// Batched kernels over arrays of transforms, dispatched to the best instruction set at runtime
+class MathBatch
+{
+private:
+	static SimdLevel s_Level;
+
+public:
+	// Highest level both compiled in and supported by the CPU
+	static SimdLevel GetSupportedLevel();
+	static inline SimdLevel GetLevel() { return s_Level; }
+	// Allows forcing a lower level to compare paths, clamped to the supported one
+	static void SetLevel(SimdLevel level);
+	static const char* GetLevelName(SimdLevel level);
+
+	// out[i] = left * right[i], e.g. view-projection times every model matrix
+	static void MultiplyMatrices(const Mat4& left, const Mat4* right, Mat4* out, size_t count);
+
+	// Structure-of-arrays points, out = matrix * (x, y, z, 1)
+	static void TransformPoints(const Mat4& matrix, const float* x, const float* y, const float* z,
+		float* outX, float* outY, float* outZ, float* outW, size_t count);
+
+	// World space bounds of transformed local boxes (Arvo's method)
+	static void TransformAABBs(const Mat4* matrices, const AABB* local, AABB* world, size_t count);
+};
@@ -1,5 +1,8 @@
 #include "VertexArray.h"
 #include "Renderer.h"
+#include "DeletionQueue.h"
+
+#include<utility>
 
 VertexArray::VertexArray()
 {
@@ -8,7 +11,20 @@ VertexArray::VertexArray()
 
 VertexArray::~VertexArray()
 {
-	GLCall(glDeleteVertexArrays(1, &m_RendererID));
+	DeletionQueue::Enqueue(GLResourceType::VERTEX_ARRAY, m_RendererID);
+}
+
+VertexArray::VertexArray(VertexArray&& other)
+	:m_RendererID(other.m_RendererID)
+{
+	other.m_RendererID = 0;
+}
+
+// The previous vertex array goes with other and is deleted when it is destroyed
+VertexArray& VertexArray::operator=(VertexArray&& other)
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	return *this;
 }
 
 void VertexArray::Bind() const
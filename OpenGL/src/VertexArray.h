@@ -11,6 +11,11 @@ private:
 public:
 	VertexArray();
 	~VertexArray();
+	// Owns the GL object: movable, never copied
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
+	VertexArray(VertexArray&& other);
+	VertexArray& operator=(VertexArray&& other);
 	void Bind() const;
 	void UnBind() const;
 	void AddBuffer(const VertexBuffer& vBuffer, const VertexBufferLayout& layout) const;
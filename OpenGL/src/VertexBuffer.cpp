@@ -1,18 +1,36 @@
 #include "VertexBuffer.h"
 #include "Renderer.h"
+#include "DeletionQueue.h"
 #include "GL\glew.h"
 
+#include<utility>
+
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
 {
 	GLCall(glGenBuffers(1, &m_RendererID));
 	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
 	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+	GLStats::RecordUpload(size);
 
 }
 
+// May run on any thread, the object is deleted on the GL thread once the GPU is done with it
 VertexBuffer::~VertexBuffer()
 {
-	GLCall(glDeleteBuffers(1, &m_RendererID));
+	DeletionQueue::Enqueue(GLResourceType::BUFFER, m_RendererID);
+}
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other)
+	:m_RendererID(other.m_RendererID)
+{
+	other.m_RendererID = 0;
+}
+
+// The previous buffer goes with other and is deleted when it is destroyed
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other)
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	return *this;
 }
 
 void VertexBuffer::Bind() const
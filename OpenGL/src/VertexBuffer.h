@@ -7,6 +7,11 @@ private:
 public:
 	VertexBuffer(const void* data, unsigned int size);
 	~VertexBuffer();
+	// Owns the GL object: movable, never copied
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
+	VertexBuffer(VertexBuffer&& other);
+	VertexBuffer& operator=(VertexBuffer&& other);
 	void Bind() const;
 	void UnBind() const;
 };
\ No newline at end of file
@@ -22,6 +22,15 @@ VertexBufferLayout::~VertexBufferLayout()
 {
 }
 
+VertexBufferLayout VertexBufferLayout::GetPositionLayout() const
+{
+	VertexBufferLayout layout;
+	if (!m_Elements.empty())
+		layout.m_Elements.push_back(m_Elements[0]);
+	layout.m_Stride = m_Stride;
+	return layout;
+}
+
 
 template<>
 void VertexBufferLayout::Push<float>(unsigned int count)
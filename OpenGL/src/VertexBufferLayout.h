@@ -35,4 +35,7 @@ public:
 
 	template<typename T>
 	void Push(unsigned int count);
+
+	// The first attribute with the full stride, lets depth-only passes fetch positions alone from an interleaved buffer
+	VertexBufferLayout GetPositionLayout() const;
 };
\ No newline at end of file